@@ -0,0 +1,359 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <Arduino.h>
+#include <ESP8266WebServer.h>
+#include "main.h"
+#include "sim.h"
+
+// Microbenchmarks for the paths the firmware runs all the time. Built
+// into the native program and run with
+//   program --bench report.json [--baseline bench/baseline.json]
+// Each benchmark records host time, simulated bus/network time, heap
+// allocations and stack depth per call. With a baseline the run fails
+// if any of them regress past its tolerance. It also fails if loop()
+// touches the heap in a steady state (with ALLOC_HOOK)
+
+void setup();
+void loop();
+
+// Host time is noisy and machine specific so gets a loose tolerance,
+// the rest are deterministic
+#define HOST_TIME_TOLERANCE 0.5
+#define SIM_TIME_TOLERANCE 0.05
+#define HEAP_TOLERANCE 0.10
+#define STACK_TOLERANCE 0.25
+#define HOST_TIME_REPEATS 5
+#define STACK_PAINT_BYTES 32768
+#define STACK_PAINT 0xA5
+#define LOOP_PASS_MICROS 1000
+#define WARM_UP_SECONDS 30
+// Long enough for every period the firmware has short of an hour: the
+// flush, heartbeats and 15 minute history points
+#define STEADY_STATE_SECONDS (16 * 60)
+
+struct BenchResult
+{
+    std::string name;
+    int iterations;
+    double hostNs;
+    double simUs;
+    double allocs;
+    double heapBytes;
+    int64_t peakHeapBytes;
+    int64_t stackBytes;
+};
+
+static std::vector<BenchResult> results;
+
+// Stack depth is found by painting the stack below the caller, making
+// the call and then seeing how much of the paint was overwritten. Both
+// helpers have the same frame so their arrays overlay each other
+static __attribute__((noinline)) void paintStack()
+{
+    volatile uint8_t area[STACK_PAINT_BYTES] __attribute__((unused));
+    for (int i = 0; i < STACK_PAINT_BYTES; i++)
+        area[i] = STACK_PAINT;
+}
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+static __attribute__((noinline)) int64_t usedStack()
+{
+    volatile uint8_t area[STACK_PAINT_BYTES];
+    int untouched = 0;
+    while (untouched < STACK_PAINT_BYTES && area[untouched] == STACK_PAINT)
+        untouched++;
+    return STACK_PAINT_BYTES - untouched;
+}
+#pragma GCC diagnostic pop
+
+template <typename F>
+static void measure(const char *name, int iterations, uint32_t passMicros, F fn)
+{
+    BenchResult r;
+    {
+        SimHeapPause pause;
+        r.name = name;
+    }
+    r.iterations = iterations;
+
+    paintStack();
+    fn();
+    r.stackBytes = usedStack();
+
+    // Heap and simulated time
+    Sim::ResetHeapPeak();
+    SimHeapStats before = Sim::HeapStats();
+    uint64_t simMicros = 0;
+    for (int i = 0; i < iterations; i++)
+    {
+        uint64_t start = Sim::Micros();
+        fn();
+        simMicros += Sim::Micros() - start;
+        Sim::AdvanceMicros(passMicros);
+    }
+    SimHeapStats after = Sim::HeapStats();
+    r.simUs = (double)simMicros / iterations;
+    r.allocs = (double)(after.allocations - before.allocations) / iterations;
+    r.heapBytes = (double)(after.bytesAllocated - before.bytesAllocated) / iterations;
+    r.peakHeapBytes = after.peakInUse - before.inUse;
+
+    // Host time, best of several passes
+    r.hostNs = 0;
+    for (int repeat = 0; repeat < HOST_TIME_REPEATS; repeat++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++)
+        {
+            fn();
+            Sim::AdvanceMicros(passMicros);
+        }
+        auto end = std::chrono::steady_clock::now();
+        double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / iterations;
+        if (repeat == 0 || ns < r.hostNs)
+            r.hostNs = ns;
+    }
+
+    SimHeapPause pause;
+    results.push_back(r);
+}
+
+// Device name from the driver's status rows, values may be in a
+// buffer that doesn't outlive the callback
+static char deviceName[16];
+static void findDevice(const __FlashStringHelper *name, const char *value)
+{
+    if (strcmp_P("Device", (PGM_P)name) == 0)
+        strncpy(deviceName, value, sizeof(deviceName) - 1);
+}
+
+static void runBenchmarks()
+{
+    static char buf[MAX_PACKET_SIZE + 1];
+    char name[64];
+
+    for (int i = 0; i < drivers_count; i++)
+    {
+        SensorDriver *driver = drivers[i];
+        deviceName[0] = '\0';
+        driver->GetValues(findDevice);
+        snprintf(name, sizeof(name), "GetPacketData/%i:%s", i, deviceName);
+        measure(name, 2000, 0, [driver]() { driver->GetPacketData(buf); });
+    }
+
+    // Values within their deadband are skipped, so also time a sample
+    // where every heartbeat is due
+    measure("Telemetry::Sample", 2000, 0, []() { telemetry.Sample(drivers, drivers_count); });
+    measure("Telemetry::Sample/heartbeat", 2000, MEASUREMENT_HEARTBEAT_S * 1000000UL,
+            []() { telemetry.Sample(drivers, drivers_count); });
+    measure("Telemetry::BuildPacket", 2000, 0, []() {
+        telemetry.Sample(drivers, drivers_count);
+        while (!telemetry.IsEmpty())
+            telemetry.BuildPacket(buf, MAX_PACKET_SIZE);
+    });
+    // A driver's sample into a compressed block, started again when full
+    static SeriesBlock block;
+    static uint8_t blockData[TELEMETRY_BLOCK_SIZE];
+    measure("SeriesBlock::Append", 2000, 0, []() {
+        const Measurement *schema;
+        const int32_t *values;
+        drivers[0]->GetReadings(&schema, &values);
+        if (!block.Append(millis(), values))
+        {
+            block.Begin(blockData, sizeof(blockData), drivers[0], 0);
+            block.Append(millis(), values);
+        }
+    });
+    // A median and rate chain, as the DS18B20's, fed a steady reading
+    static const FilterStage stages[] = {{FILTER_MEDIAN, 3, 20000}, {FILTER_RATE, 3, 2500}};
+    static FilterState state[2];
+    static FilterChain chain;
+    static const Measurement *schema;
+    static const int32_t *values;
+    drivers[0]->GetReadings(&schema, &values);
+    chain.Begin(&schema[0], stages, state);
+    measure("FilterChain::Add", 2000, 0, []() {
+        int32_t value;
+        chain.Add(values[0], &value);
+    });
+    measure("History::Sample", 2000, 0, []() { history.Sample(); });
+    measure("StatusPage", 200, 0, []() { Sim::HttpRequest(HTTP_GET, "/status"); });
+    measure("StatusShell", 200, 0, []() { Sim::HttpRequest(HTTP_GET, "/"); });
+    static std::string etag;
+    {
+        SimHeapPause pause;
+        etag = Sim::HttpRequest(HTTP_GET, "/").headers["ETag"];
+    }
+    measure("StatusShell/304", 200, 0, []() { Sim::HttpRequest(HTTP_GET, "/", {}, {{"If-None-Match", etag}}); });
+    // A listener connecting, being sent every reading and going away
+    measure("EventStream/connect", 200, 0, []() {
+        SimHttpResponse events = Sim::HttpRequest(HTTP_GET, "/events");
+        eventStream.Handle(drivers, drivers_count);
+        events.connection->open = false;
+        eventStream.Handle(drivers, drivers_count);
+    });
+    measure("Api/readings", 200, 0, []() { Sim::HttpRequest(HTTP_GET, "/api/readings"); });
+    measure("Api/readings?fields", 200, 0, []() { Sim::HttpRequest(HTTP_GET, "/api/readings", {{"fields", "temperature"}}); });
+    measure("Api/history", 200, 0, []() { Sim::HttpRequest(HTTP_GET, "/api/history"); });
+    measure("Api/history?format=csv", 200, 0, []() { Sim::HttpRequest(HTTP_GET, "/api/history", {{"format", "csv"}}); });
+    measure("Metrics", 200, 0, []() { Sim::HttpRequest(HTTP_GET, "/metrics"); });
+    measure("EventLog::Add", 200, 0, []() { eventLog.Add(EVENT_WIFI_DISCONNECTED); });
+    measure("Api/events", 200, 0, []() { Sim::HttpRequest(HTTP_GET, "/api/events"); });
+    // loop() sleeps until the next deadline, so time the work it does
+    measure("Scheduler::Run", 5000, LOOP_PASS_MICROS, []() { scheduler.Run(); });
+}
+
+// Runs loop() with WiFi up and nobody making requests, which shouldn't
+// touch the heap at all (ALLOC_HOOK). Returns false if it did
+static bool checkSteadyState()
+{
+#if ALLOC_HOOK
+    uint32_t passes = allocTracker.GetPasses();
+    uint32_t heapPasses = allocTracker.GetHeapPasses();
+    uint64_t end = Sim::Micros() + (uint64_t)STEADY_STATE_SECONDS * 1000000;
+    while (Sim::Micros() < end)
+    {
+        loop();
+        Sim::AdvanceMicros(LOOP_PASS_MICROS);
+    }
+    passes = allocTracker.GetPasses() - passes;
+    heapPasses = allocTracker.GetHeapPasses() - heapPasses;
+    printf("Steady state: %u of %u loop passes used the heap", heapPasses, passes);
+    if (heapPasses == 0)
+    {
+        printf("\n");
+        return true;
+    }
+    printf(", the last at %lu ms (up to %u allocs a pass)\n", allocTracker.GetLastHeapMillis(), allocTracker.GetMaxPassAllocs());
+    for (int i = 0; i < scheduler.GetTaskCount(); i++)
+        if (scheduler.GetAllocs(i) != 0)
+            printf("  task %s: %u allocs\n", scheduler.GetTaskName(i), scheduler.GetAllocs(i));
+    return false;
+#else
+    printf("Steady state: not checked, needs ALLOC_HOOK\n");
+    return true;
+#endif
+}
+
+static bool writeReport(const char *path)
+{
+    FILE *f = fopen(path, "w");
+    if (f == nullptr)
+    {
+        printf("Can't write %s\n", path);
+        return false;
+    }
+    fprintf(f, "{\n  \"benchmarks\": [\n");
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        BenchResult &r = results[i];
+        fprintf(f, "    {\"name\": \"%s\", \"iterations\": %i, \"host_ns\": %.1f, \"sim_us\": %.2f, "
+                   "\"allocs\": %.3f, \"heap_bytes\": %.1f, \"peak_heap_bytes\": %lld, \"stack_bytes\": %lld}%s\n",
+                r.name.c_str(), r.iterations, r.hostNs, r.simUs, r.allocs, r.heapBytes,
+                (long long)r.peakHeapBytes, (long long)r.stackBytes, i + 1 < results.size() ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+    fclose(f);
+    return true;
+}
+
+// Reads a number following "key": on a report line
+static bool jsonNumber(const char *line, const char *key, double *value)
+{
+    char pattern[32];
+    snprintf(pattern, sizeof(pattern), "\"%s\": ", key);
+    const char *p = strstr(line, pattern);
+    if (p == nullptr)
+        return false;
+    *value = strtod(p + strlen(pattern), nullptr);
+    return true;
+}
+
+static bool regressed(const char *name, const char *metric, double value, double baseline, double tolerance, double slack)
+{
+    double limit = baseline * (1 + tolerance) + slack;
+    if (value <= limit)
+        return false;
+    printf("REGRESSION %s %s %.2f > %.2f (baseline %.2f)\n", name, metric, value, limit, baseline);
+    return true;
+}
+
+// Compares results against a report written by an earlier run. Returns
+// the number of regressions
+static int compareBaseline(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    if (f == nullptr)
+    {
+        printf("Can't read baseline %s\n", path);
+        return 1;
+    }
+
+    int regressions = 0;
+    char line[512];
+    while (fgets(line, sizeof(line), f))
+    {
+        const char *p = strstr(line, "\"name\": \"");
+        if (p == nullptr)
+            continue;
+        p += 9;
+        std::string name(p, strcspn(p, "\""));
+        for (BenchResult &r : results)
+        {
+            if (r.name != name)
+                continue;
+            double hostNs, simUs, allocs, heapBytes, peak, stack;
+            if (!jsonNumber(line, "host_ns", &hostNs) || !jsonNumber(line, "sim_us", &simUs) ||
+                !jsonNumber(line, "allocs", &allocs) || !jsonNumber(line, "heap_bytes", &heapBytes) ||
+                !jsonNumber(line, "peak_heap_bytes", &peak) || !jsonNumber(line, "stack_bytes", &stack))
+            {
+                printf("Malformed baseline entry %s\n", name.c_str());
+                regressions++;
+                break;
+            }
+            regressions += regressed(r.name.c_str(), "host_ns", r.hostNs, hostNs, HOST_TIME_TOLERANCE, 0);
+            regressions += regressed(r.name.c_str(), "sim_us", r.simUs, simUs, SIM_TIME_TOLERANCE, 1);
+            regressions += regressed(r.name.c_str(), "allocs", r.allocs, allocs, 0, 0.001);
+            regressions += regressed(r.name.c_str(), "heap_bytes", r.heapBytes, heapBytes, HEAP_TOLERANCE, 16);
+            regressions += regressed(r.name.c_str(), "peak_heap_bytes", r.peakHeapBytes, peak, HEAP_TOLERANCE, 64);
+            regressions += regressed(r.name.c_str(), "stack_bytes", r.stackBytes, stack, STACK_TOLERANCE, 256);
+            break;
+        }
+    }
+    fclose(f);
+    return regressions;
+}
+
+int RunBenchmarks(const char *reportPath, const char *baselinePath)
+{
+    // Let every driver produce a reading first
+    Sim::SetSerialEcho(false);
+    setup();
+    uint64_t end = Sim::Micros() + (uint64_t)WARM_UP_SECONDS * 1000000;
+    while (Sim::Micros() < end)
+    {
+        loop();
+        Sim::AdvanceMicros(LOOP_PASS_MICROS);
+    }
+
+    // Before the benchmarks, which make requests
+    bool steady = checkSteadyState();
+    runBenchmarks();
+
+    printf("%-28s %10s %10s %8s %10s %10s %8s\n", "benchmark", "host ns", "sim us", "allocs", "heap B", "peak B", "stack B");
+    for (BenchResult &r : results)
+        printf("%-28s %10.0f %10.1f %8.2f %10.1f %10lld %8lld\n", r.name.c_str(), r.hostNs, r.simUs, r.allocs,
+               r.heapBytes, (long long)r.peakHeapBytes, (long long)r.stackBytes);
+
+    if (!writeReport(reportPath) || !steady)
+        return 1;
+    if (baselinePath == nullptr)
+        return 0;
+    int regressions = compareBaseline(baselinePath);
+    printf("%i regression(s) against %s\n", regressions, baselinePath);
+    return regressions == 0 ? 0 : 1;
+}
@@ -0,0 +1,159 @@
+#include <stdio.h>
+#include <Arduino.h>
+#include "series_block.h"
+#include "telemetry.h"
+
+// Round trip check of the compressed telemetry format. Encodes a fixed
+// pseudo random run of samples that covers every timestamp class and
+// value window case, writes the packets as --udp does and prints the
+// line protocol scripts/uplink_decoder.py should turn them back into:
+//   program --series-check blocks.bin > expected.txt
+//   python3 scripts/uplink_decoder.py --file blocks.bin --expect expected.txt
+
+#define CHECK_SAMPLES 5000
+#define CHECK_FIRST_TIME 1760000000000ULL
+
+static constexpr char smallName[] PROGMEM = "small";
+static constexpr char centiName[] PROGMEM = "centi";
+static constexpr char wideName[] PROGMEM = "wide";
+static constexpr Measurement schema[] = {
+    {smallName, smallName, 0, MEASUREMENT_ANY_MIN, MEASUREMENT_ANY_MAX, nullptr, 0, 0},
+    {centiName, centiName, 2, MEASUREMENT_ANY_MIN, MEASUREMENT_ANY_MAX, nullptr, 0, 0},
+    {wideName, wideName, 4, MEASUREMENT_ANY_MIN, MEASUREMENT_ANY_MAX, nullptr, 0, 0}};
+#define CHECK_FIELDS (int)(sizeof(schema) / sizeof(schema[0]))
+
+// Only its id and schema are used
+class CheckDriver : public SensorDriver
+{
+public:
+    int32_t values[CHECK_FIELDS] = {};
+
+    int GetPacketData(char *ptr) { return 0; }
+    uint32_t Handle() { return 0; }
+    bool IsLastReadingValid() { return true; }
+    void GetValues(void callback(const __FlashStringHelper *, const char *)) {}
+    int GetReadings(const Measurement **schemaOut, const int32_t **valuesOut)
+    {
+        *schemaOut = schema;
+        *valuesOut = values;
+        return CHECK_FIELDS;
+    }
+    const char *GetId() { return "CHECK"; }
+    FilterChain *GetFilter(int measurement) { return nullptr; }
+};
+
+// Same sequence on every machine
+static uint32_t seed = 1;
+static uint32_t next()
+{
+    seed = seed * 1664525 + 1013904223;
+    return seed >> 8;
+}
+
+static int32_t between(int32_t low, int32_t high)
+{
+    return low + (int32_t)(next() % (uint32_t)(high - low + 1));
+}
+
+// A delta of delta in each of the encoder's classes, edges included
+static int32_t deltaOfDelta()
+{
+    static const int32_t edges[] = {-64, 63, -65, 64, -256, 255, -257, 256, -2048, 2047, -2049, 2048};
+    switch (next() % 6)
+    {
+    case 0:
+        return 0;
+    case 1:
+        return between(-64, 63);
+    case 2:
+        return between(-256, 255);
+    case 3:
+        return between(-2048, 2047);
+    case 4:
+        return between(-1000000, 1000000);
+    default:
+        return edges[next() % (sizeof(edges) / sizeof(edges[0]))];
+    }
+}
+
+// Repeats, changes inside and outside the last window and the extremes
+static int32_t nextValue(int32_t value)
+{
+    static const int32_t edges[] = {0, -1, 1, INT32_MIN, INT32_MAX, INT32_MIN + 1, 0x55555555, (int32_t)0xAAAAAAAA};
+    switch (next() % 6)
+    {
+    case 0:
+    case 1:
+        return value;
+    case 2:
+        return value ^ (int32_t)(next() & 0xF);
+    case 3:
+        return value + between(-1000, 1000);
+    case 4:
+        return (int32_t)(next() << 8 ^ next());
+    default:
+        return edges[next() % (sizeof(edges) / sizeof(edges[0]))];
+    }
+}
+
+static void writePacket(FILE *f, SeriesBlock *block, uint8_t *blockData)
+{
+    uint8_t packet[TELEMETRY_PACKET_HEADER + TELEMETRY_BLOCK_SIZE] = {TELEMETRY_PACKET_MAGIC[0], TELEMETRY_PACKET_MAGIC[1],
+                                                                     TELEMETRY_PACKET_VERSION, 0};
+    int len = block->Finish();
+    memcpy(&packet[TELEMETRY_PACKET_HEADER], blockData, len);
+    len += TELEMETRY_PACKET_HEADER;
+    uint8_t header[2] = {(uint8_t)len, (uint8_t)(len >> 8)};
+    fwrite(header, 1, sizeof(header), f);
+    fwrite(packet, 1, len, f);
+    block->Clear();
+}
+
+int RunSeriesCheck(const char *path)
+{
+    FILE *f = fopen(path, "wb");
+    if (f == nullptr)
+    {
+        fprintf(stderr, "Can't write %s\n", path);
+        return 1;
+    }
+
+    CheckDriver driver;
+    SeriesBlock block;
+    static uint8_t blockData[TELEMETRY_BLOCK_SIZE];
+    uint64_t time = CHECK_FIRST_TIME;
+    int64_t delta = 1000;
+    int blocks = 0;
+    for (int n = 0; n < CHECK_SAMPLES; n++)
+    {
+        // Times only go forwards, as the node's do
+        delta = max(delta + deltaOfDelta(), (int64_t)1);
+        time += delta;
+        for (int i = 0; i < CHECK_FIELDS; i++)
+            driver.values[i] = nextValue(driver.values[i]);
+
+        if (block.GetCount() > 0 && !block.Append(time, driver.values))
+        {
+            writePacket(f, &block, blockData);
+            blocks++;
+        }
+        if (block.GetCount() == 0 &&
+            (!block.Begin(blockData, sizeof(blockData), &driver, SERIES_BLOCK_EPOCH) || !block.Append(time, driver.values)))
+        {
+            fprintf(stderr, "Sample %i doesn't fit an empty block\n", n);
+            fclose(f);
+            return 1;
+        }
+
+        for (int i = 0; i < CHECK_FIELDS; i++)
+        {
+            char value[MEASUREMENT_MAX_VALUE + 1];
+            FormatFixed(value, driver.values[i], schema[i].decimals);
+            printf("%s,id=%s value=%s %llu000000\n", schema[i].name, driver.GetId(), value, (unsigned long long)time);
+        }
+    }
+    writePacket(f, &block, blockData);
+    fclose(f);
+    fprintf(stderr, "%i samples in %i blocks written to %s\n", CHECK_SAMPLES, blocks + 1, path);
+    return 0;
+}
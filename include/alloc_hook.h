@@ -0,0 +1,50 @@
+#ifndef ALLOCHOOK_H
+#define ALLOCHOOK_H
+
+#include <stdint.h>
+
+// Set to 1 to count heap allocations, per scheduler task and per loop()
+// pass. On the ESP8266 the allocator is wrapped, which needs
+//   -Wl,--wrap=malloc -Wl,--wrap=calloc -Wl,--wrap=realloc -Wl,--wrap=free
+// in build_flags as well. The native build counts them through the
+// simulator's heap tracker and bench/ fails if the steady state loop
+// allocates
+#ifndef ALLOC_HOOK
+#define ALLOC_HOOK 0
+#endif
+
+// Allocations (a realloc counts as one) and frees since boot
+struct AllocCounts
+{
+    uint32_t allocs;
+    uint32_t frees;
+};
+AllocCounts GetAllocCounts();
+
+// Heap use of the work each loop() pass does
+class AllocTracker
+{
+public:
+    void BeginPass();
+    void EndPass();
+
+    uint32_t GetPasses() { return _passes; }
+    // Passes that allocated or freed, the most allocations one made and
+    // when (millis()) the last one was
+    uint32_t GetHeapPasses() { return _heapPasses; }
+    uint32_t GetMaxPassAllocs() { return _maxPassAllocs; }
+    unsigned long GetLastHeapMillis() { return _lastHeapMillis; }
+
+private:
+    AllocCounts _start = {};
+    uint32_t _passes = 0;
+    uint32_t _heapPasses = 0;
+    uint32_t _maxPassAllocs = 0;
+    unsigned long _lastHeapMillis = 0;
+};
+
+#if ALLOC_HOOK
+extern AllocTracker allocTracker;
+#endif
+
+#endif // ALLOCHOOK_H
@@ -0,0 +1,32 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <new>
+
+// Hands out pieces of a fixed buffer for objects that live until the
+// next restart, such as the drivers. Nothing is freed, so unlike the
+// heap it can't fragment
+class Arena
+{
+public:
+    Arena(uint8_t *buf, size_t size) : _buf(buf), _size(size) {}
+
+    // Returns aligned space for an object, construct it with placement
+    // new. nullptr if the arena is full
+    void *Allocate(size_t size, size_t align);
+
+    size_t GetUsed() { return _used; }
+    size_t GetSize() { return _size; }
+
+private:
+    uint8_t *_buf;
+    size_t _size;
+    size_t _used = 0;
+};
+
+// Where CreateDriverInstances() places the drivers
+extern Arena driverArena;
+
+#endif // ARENA_H
@@ -1,4 +1,4 @@
-#include <Wire.h>
+#include <i2c_bus.h>
 #include <sensor_driver.h>
 
 class Bh1750Driver : SensorDriver
@@ -7,18 +7,25 @@ public:
     // Creates a driver instance for each physical device found starting at
     // firstInstance. Creates no more than maxInstances. Returns the number
     // of instances created.
-    static int CreateDriverInstances(TwoWire *wire, SensorDriver *firstInstance[], int maxInstances);
+    static int CreateDriverInstances(I2cBus *bus, SensorDriver *firstInstance[], int maxInstances);
     int GetPacketData(char *ptr);
-    void Handle();
-    bool IsLastReadingValid() { return _lastLux >= 0; }
-    void GetValues(void callback(const char *, const char *));
+    uint32_t Handle();
+    bool IsLastReadingValid();
+    void GetValues(void callback(const __FlashStringHelper *, const char *));
+    int GetReadings(const Measurement **schema, const int32_t **values);
+    const char *GetId() { return _id; }
+    FilterChain *GetFilter(int measurement) { return &_filter; }
 
 private:
-    TwoWire *_i2c;
+    I2cBus *_bus;
     int _address;
     char _id[14];
-    float _lastLux = -1;
+    int32_t _lastLux = -1;
+    FilterChain _filter;
+    FilterState _filterState[1];
     long _lastPollMillis = 0;
+    unsigned long _queuedMicros = 0;
 
-    Bh1750Driver(TwoWire *i2c, int address);
+    Bh1750Driver(I2cBus *bus, int address);
+    static void OnReading(void *context, uint8_t status, const uint8_t *data, uint8_t len);
 };
@@ -1,6 +1,19 @@
-#include <Wire.h>
+#include <i2c_bus.h>
 #include <sensor_driver.h>
 #include <bsec.h>
+#include <bsec_state.h>
+
+// Readings in schema order
+enum Bme680Reading
+{
+    BME680_TEMP,
+    BME680_PRESSURE,
+    BME680_HUMIDITY,
+    BME680_IAQ,
+    BME680_ACCURACY,
+    BME680_CO2,
+    BME680_READINGS
+};
 
 class Bme680Driver : SensorDriver
 {
@@ -8,28 +21,37 @@ public:
     // Creates a driver instance for each physical device found starting at
     // firstInstance. Creates no more than maxInstances. Returns the number
     // of instances created.
-    static int CreateDriverInstances(TwoWire *wire, SensorDriver *firstInstance[], int maxInstances, float trim1, float trim2 = 0.0f);
+    static int CreateDriverInstances(I2cBus *bus, SensorDriver *firstInstance[], int maxInstances, float trim1, float trim2 = 0.0f);
     int GetPacketData(char *ptr);
-    void Handle();
+    uint32_t Handle();
     bool IsLastReadingValid() {return _lastReadingValid;}
-    void GetValues(void callback(const char *, const char *));
+    void GetValues(void callback(const __FlashStringHelper *, const char *));
+    int GetReadings(const Measurement **schema, const int32_t **values);
+    const char *GetId() { return _id; }
     void Recalibrate();
+    FilterChain *GetFilter(int measurement) { return &_filters[measurement]; }
 
 private:
+    I2cBus *_bus;
     TwoWire *_i2c;
     int _address;
     char _id[14];
     Bsec _iaqSensor;
-    float _lastTemp;
-    float _lastPressure;
-    float _lastHumidity;
-    float _lastIaq;
-    uint8_t _lastIaqAccuracy;
-    float _lastCo2Equivalent;
+    BsecState _state;
+    int32_t _lastReadings[BME680_READINGS];
     bool _lastReadingValid = false;
+    bool _errorLogged = false;
+    FilterChain _filters[BME680_READINGS];
     uint32_t _lastSaveMs = 0;
+    uint32_t _lastRtcSaveMs = 0;
     float _trim;
+    bool _runQueued = false;
+    uint32_t _lastTimeMs = 0;
+    uint32_t _millisOverflowCounter = 0;
 
-    Bme680Driver(TwoWire *i2c, int address, const char *prefix, float trim);
-    bool IsBadStatus(const char *str);
+    Bme680Driver(I2cBus *bus, int address, const char *prefix, int rtcSlot, float trim);
+    bool IsBadStatus(PGM_P str);
+    static void OnRun(void *context, uint8_t status, const uint8_t *data, uint8_t len);
+    void Run();
+    int64_t GetTimeMs();
 };
@@ -0,0 +1,88 @@
+#ifndef BSEC_STATE_H
+#define BSEC_STATE_H
+
+#include <stdint.h>
+#include <bsec.h>
+
+// Each copy of the state is a header (magic, version, length, sequence
+// and a CRC-32 of the whole record) followed by the BSEC blob
+#define BSEC_STATE_MAGIC 0xB5
+#define BSEC_STATE_VERSION 1
+
+// Two RTC copies of 38 blocks after the 32 blocks (128 bytes) the OTA
+// boot loader uses, RTC memory survives all but a power cycle
+#define BSEC_STATE_RTC_SLOTS 2
+#define BSEC_STATE_RTC_FIRST_BLOCK 32
+
+struct BsecStateHeader
+{
+    uint8_t magic;
+    uint8_t version;
+    uint16_t length;
+    uint32_t sequence;
+    uint32_t crc;
+};
+
+// Where a restored state came from
+enum BsecStateSource : uint8_t
+{
+    BSEC_STATE_NONE,
+    BSEC_STATE_FLASH,
+    BSEC_STATE_RTC,
+    BSEC_STATE_LEGACY
+};
+
+// Keeps the BSEC state in two flash files, "<name>.0" and "<name>.1",
+// written in turn so a reset during a write leaves the other intact.
+// A copy in RTC memory is kept more often and covers soft resets.
+// Copies that already hold the blob are not written again
+class BsecState
+{
+public:
+    // name is the driver id, rtcSlot picks the RTC copy
+    void Begin(const char *name, int rtcSlot);
+
+    // Newest valid copy into blob, false if there is none
+    bool Restore(uint8_t *blob);
+
+    // Updates the RTC copy, and the flash copy too if toFlash
+    void Save(const uint8_t *blob, bool toFlash);
+
+    // Forgets every copy, including the file from before the A/B slots
+    void Clear();
+
+    // "flash 12 (slot 1), RTC 14" for the status page, returns the length
+    int Describe(char *buf, int size);
+    // "RTC 14 in 850 us", "NO" if nothing was restored
+    int DescribeRestore(char *buf, int size);
+    // "flash 3, RTC 40, unchanged 12"
+    int DescribeWrites(char *buf, int size);
+
+private:
+    const char *_name = nullptr;
+    int _rtcSlot = 0;
+    uint32_t _sequence = 0;
+    int8_t _flashSlot = -1;
+    uint32_t _flashSequence = 0;
+    uint32_t _flashBlobCrc = 0;
+    bool _rtcValid = false;
+    uint32_t _rtcSequence = 0;
+    uint32_t _rtcBlobCrc = 0;
+    bool _legacy = false;
+    BsecStateSource _restoredFrom = BSEC_STATE_NONE;
+    uint32_t _restoredSequence = 0;
+    uint32_t _restoreMicros = 0;
+    uint32_t _flashWrites = 0;
+    uint32_t _rtcWrites = 0;
+    uint32_t _unchanged = 0;
+
+    bool ReadFlash(int slot, BsecStateHeader *header, uint8_t *blob);
+    bool ReadRtc(BsecStateHeader *header, uint8_t *blob);
+    void WriteFlash(const uint8_t *blob, uint32_t blobCrc);
+    void WriteRtc(const uint8_t *blob, uint32_t blobCrc);
+    void SlotName(int slot, char *name);
+    static void Seal(BsecStateHeader *header, uint32_t sequence, const uint8_t *blob);
+    static bool IsValid(BsecStateHeader *header, const uint8_t *blob);
+};
+
+#endif // BSEC_STATE_H
@@ -0,0 +1,33 @@
+#ifndef CHUNKWRITER_H
+#define CHUNKWRITER_H
+
+#include <stdarg.h>
+#include <ESP8266WebServer.h>
+
+// Size of the buffer used to batch up content before it is sent
+#define CHUNK_SIZE 512
+
+// Streams a response to the current web client using chunked transfer
+// encoding. Content is collected in a fixed size buffer and sent each
+// time the buffer fills, so the response size is not limited by RAM.
+class ChunkWriter
+{
+public:
+    ChunkWriter(ESP8266WebServer *server);
+    void Begin(int code, const char *contentType);
+    void Write(const char *str);
+    void Write(const char *str, size_t len);
+    void Write_P(PGM_P str);
+    void Printf_P(PGM_P format, ...) __attribute__((format(printf, 2, 3)));
+    void VPrintf_P(PGM_P format, va_list args);
+    void End();
+
+private:
+    ESP8266WebServer *_server;
+    char _buf[CHUNK_SIZE];
+    size_t _len = 0;
+
+    void Flush();
+};
+
+#endif // CHUNKWRITER_H
@@ -1,4 +1,4 @@
-#include <OneWire.h>
+#include <one_wire_bus.h>
 #include <sensor_driver.h>
 
 class Ds18b20Driver : SensorDriver
@@ -7,19 +7,23 @@ public:
     // Creates a driver instance for each physical device found starting at
     // firstInstance. Creates no more than maxInstances. Returns the number
     // of instances created.
-    static int CreateDriverInstances(OneWire *wire, SensorDriver *firstInstance[], int maxInstances);
+    static int CreateDriverInstances(OneWireBus *bus, SensorDriver *firstInstance[], int maxInstances);
     int GetPacketData(char *ptr);
-    void Handle();
+    uint32_t Handle();
     bool IsLastReadingValid() {return _lastReadingValid;}
-    void GetValues(void callback(const char *, const char *));
+    void GetValues(void callback(const __FlashStringHelper *, const char *));
+    int GetReadings(const Measurement **schema, const int32_t **values);
+    const char *GetId() { return _id; }
+    FilterChain *GetFilter(int measurement) { return &_filter; }
 
 private:
-    OneWire *_wire;
     byte _address[8];
     char _id[14];
-    float _lastReadingCelsius;
-    long _lastPollMillis = 0;
+    int32_t _lastReadingCelsius;
     bool _lastReadingValid = false;
+    FilterChain _filter;
+    FilterState _filterState[2];
 
-    Ds18b20Driver(OneWire *wire, byte address[8]);
+    Ds18b20Driver(byte address[8]);
+    static void OnScratchpad(void *context, bool valid, const uint8_t *data);
 };
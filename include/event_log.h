@@ -0,0 +1,79 @@
+#ifndef EVENTLOG_H
+#define EVENTLOG_H
+
+#include <stdint.h>
+#include <LittleFS.h>
+
+// Events are appended to segment files in this directory, the oldest
+// segment goes once there are EVENT_LOG_SEGMENTS, which keeps the last
+// 224 to 256 events
+#define EVENT_LOG_DIR "/ev"
+#define EVENT_LOG_SEGMENT_RECORDS 32
+#define EVENT_LOG_SEGMENTS 8
+
+// What happened, what arg and value hold depends on the type
+enum EventType : uint8_t
+{
+    EVENT_BOOT = 1,          // arg reset reason, value exception cause
+    EVENT_CLOCK_SET,         // the first NTP sync after boot
+    EVENT_TIME_SYNC_FAILED,  // arg 0 not set in time, 1 resync gone stale
+    EVENT_TIME_ZONE_FAILED,  // value tries
+    EVENT_WIFI_CONNECTED,    // value RSSI in dBm
+    EVENT_WIFI_DISCONNECTED, // arg WiFi status
+    EVENT_SENSOR_ERROR,      // arg I2C address, value BSEC status << 8 | bme680 status
+    EVENT_OTA_START,         // arg 0 sketch, 1 file system
+    EVENT_OTA_END,
+    EVENT_OTA_ERROR          // arg OTA error
+};
+
+// Records are fixed size, so an event's place in its segment follows
+// from its sequence number
+struct EventRecord
+{
+    uint32_t sequence;
+    uint32_t time;     // epoch seconds, 0 before the clock was set
+    uint32_t uptimeMs; // millis() when it happened
+    uint8_t type;
+    uint8_t arg;
+    int16_t value;
+    uint32_t crc;      // CRC-32 of the record up to here
+};
+
+// Append only log of boots, resets, link and sensor trouble for
+// diagnosing flaky nodes. Appending writes one record to the end of a
+// file and reading a page seeks straight to it
+class EventLog
+{
+public:
+    // Finds the segments left from before the restart, call once the
+    // file system is mounted. Events added before are dropped
+    void Begin();
+
+    void Add(EventType type, uint8_t arg = 0, int16_t value = 0);
+
+    // Up to max events older than sequence before, newest first. 0 for
+    // before starts at the newest. Returns the number read, missing and
+    // corrupt records are skipped
+    int Read(uint32_t before, EventRecord *records, int max);
+
+    // Oldest event kept and the sequence the next will get, sequences
+    // start at 1
+    uint32_t GetFirstSequence() { return _first; }
+    uint32_t GetNextSequence() { return _next; }
+    uint32_t GetCorruptRecords() { return _corruptRecords; }
+
+    static PGM_P GetTypeName(uint8_t type);
+
+private:
+    bool _begun = false;
+    uint32_t _first = 1;
+    uint32_t _next = 1;
+    uint32_t _corruptRecords = 0;
+
+    bool ReadRecord(File *f, uint32_t *segment, uint32_t sequence, EventRecord *record);
+    void SegmentName(uint32_t segment, char *name);
+};
+
+extern EventLog eventLog;
+
+#endif // EVENTLOG_H
@@ -0,0 +1,70 @@
+#ifndef EVENTSTREAM_H
+#define EVENTSTREAM_H
+
+#include <ESP8266WebServer.h>
+#include "sensor_driver.h"
+
+// lwIP on the ESP8266 has few TCP connections to spare
+#define EVENT_STREAM_MAX_CLIENTS 3
+#define EVENT_STREAM_MAX_DRIVERS 8
+#define EVENT_STREAM_MAX_READINGS 8
+
+// Drivers are checked for new readings every EVENT_STREAM_PERIOD_MS
+// while anyone is listening
+#define EVENT_STREAM_PERIOD_MS 250
+#define EVENT_STREAM_IDLE_MS 1000
+
+// A comment is sent when nothing else has been for KEEPALIVE_MS so
+// dead peers are found. Clients that can't take an event for STALL_MS
+// are dropped, as is the stalled or oldest client when another
+// connects with every slot taken
+#define EVENT_STREAM_KEEPALIVE_MS 15000
+#define EVENT_STREAM_STALL_MS 10000
+
+// Largest event, one driver's changed readings as
+// data: {"id":"<id>","<label>":"<value>",...}
+#define EVENT_STREAM_EVENT_SIZE 512
+
+// Server-Sent Events for the status page. Each event is a JSON object
+// of status page label and value for the readings of one driver that
+// changed since the last event. New clients, and clients that missed an
+// event, are sent every reading
+class EventStream
+{
+public:
+    EventStream(ESP8266WebServer *server);
+    // Takes over the client of the current request
+    void Accept();
+    // Returns the ms until Handle() next needs calling
+    uint32_t Handle(SensorDriver *drivers[], int count);
+
+    int GetClientCount();
+    uint32_t GetEvents() { return _events; }
+    uint32_t GetEvicted() { return _evicted; }
+
+private:
+    struct Client
+    {
+        WiFiClient client;
+        bool resync;                // missed an event
+        unsigned long stalledSince; // 0 if writes are getting through
+        unsigned long acceptedMillis;
+    };
+
+    ESP8266WebServer *_server;
+    Client _clients[EVENT_STREAM_MAX_CLIENTS];
+    uint32_t _generations[EVENT_STREAM_MAX_DRIVERS];
+    int32_t _sent[EVENT_STREAM_MAX_DRIVERS][EVENT_STREAM_MAX_READINGS];
+    bool _sentValid[EVENT_STREAM_MAX_DRIVERS];
+    char _event[EVENT_STREAM_EVENT_SIZE];
+    unsigned long _lastWriteMillis = 0;
+    uint32_t _events = 0;
+    uint32_t _evicted = 0;
+
+    int BuildEvent(SensorDriver *driver, int index, bool all);
+    void Send(Client *c, const char *event, int len);
+    Client *Oldest();
+    void Evict();
+};
+
+#endif // EVENTSTREAM_H
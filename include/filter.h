@@ -0,0 +1,94 @@
+#ifndef FILTER_H
+#define FILTER_H
+
+#include <stdint.h>
+#include "measurement.h"
+
+// Stages a chain can have and the longest median window
+#define FILTER_MAX_STAGES 3
+#define FILTER_MAX_WINDOW 5
+
+// Every chain first rejects values outside the measurement's min..max,
+// then runs its stages in order. n and limit depend on the stage
+enum FilterType : uint8_t
+{
+    // Median of the last n values (odd, up to FILTER_MAX_WINDOW). Values
+    // further than limit from the median are counted as rejected
+    FILTER_MEDIAN,
+    // Rejects a value that changed by more than limit per second since
+    // the last one passed, unless it is the nth in a row (a real step)
+    FILTER_RATE,
+    // Exponential moving average, each value moves the output 1/2^n of
+    // the way
+    FILTER_EMA,
+    // Passes the mean of every n values
+    FILTER_DECIMATE
+};
+
+struct FilterStage
+{
+    FilterType type;
+    uint8_t n;
+    int32_t limit;
+};
+
+// Per stage state, what each field means depends on the stage
+struct FilterState
+{
+    int32_t window[FILTER_MAX_WINDOW];
+    int32_t last;
+    int32_t sum;
+    unsigned long lastMillis;
+    uint8_t count;
+    uint8_t next;
+};
+
+enum FilterResult : uint8_t
+{
+    FILTER_PASSED,       // value is the filtered reading
+    FILTER_PENDING,      // needs more values before the next reading
+    FILTER_REJECTED,     // a glitch, keep the last reading
+    FILTER_OUT_OF_RANGE  // outside the measurement's min..max
+};
+
+// Filters the raw values of one measurement with fixed state, the stage
+// table and state array are owned by the driver
+class FilterChain
+{
+public:
+    template <size_t N>
+    void Begin(const Measurement *m, const FilterStage (&stages)[N], FilterState (&state)[N])
+    {
+        static_assert(N <= FILTER_MAX_STAGES, "Too many filter stages");
+        Begin(m, stages, N, state);
+    }
+    // Range check only
+    void Begin(const Measurement *m) { Begin(m, nullptr, 0, nullptr); }
+
+    // Runs a raw value through the chain, value is the reading if passed
+    FilterResult Add(int32_t raw, int32_t *value);
+
+    // Rejects by stage, stage -1 is the range check
+    int GetStageCount() { return _stageCount; }
+    PGM_P GetStageName(int stage);
+    uint32_t GetRejects(int stage) { return stage < 0 ? _rangeRejects : _rejects[stage]; }
+
+    // "range 0, median 2" for the status page, returns the length
+    int Describe(char *buf, int size);
+
+private:
+    const Measurement *_measurement = nullptr;
+    const FilterStage *_stages = nullptr;
+    FilterState *_state = nullptr;
+    uint8_t _stageCount = 0;
+    uint32_t _rangeRejects = 0;
+    uint32_t _rejects[FILTER_MAX_STAGES] = {};
+
+    void Begin(const Measurement *m, const FilterStage *stages, int count, FilterState *state);
+    FilterResult Median(const FilterStage &stage, FilterState *s, int32_t *value);
+    FilterResult Rate(const FilterStage &stage, FilterState *s, int32_t *value);
+    FilterResult Ema(const FilterStage &stage, FilterState *s, int32_t *value);
+    FilterResult Decimate(const FilterStage &stage, FilterState *s, int32_t *value);
+};
+
+#endif // FILTER_H
@@ -0,0 +1,26 @@
+#ifndef FIXEDPOINT_H
+#define FIXEDPOINT_H
+
+#include <stdint.h>
+
+// Readings are kept as integers scaled by 10^decimals (20997 with 3
+// decimals is 20.997) so reporting needs no soft-float. Each driver
+// declares the decimals of its measurements
+
+#define FIXED_MAX_DECIMALS 9
+
+// 10^decimals
+constexpr int32_t FixedScale(uint8_t decimals)
+{
+    return decimals == 0 ? 1 : 10 * FixedScale(decimals - 1);
+}
+
+// Converts a float from a library that only reports floats (BSEC),
+// once per reading rather than on every report
+int32_t ToFixed(float value, uint8_t decimals);
+
+// Writes value / 10^decimals with exactly decimals places using integer
+// maths only. Returns the length written, buf needs room for 13 chars
+int FormatFixed(char *buf, int32_t value, uint8_t decimals);
+
+#endif // FIXEDPOINT_H
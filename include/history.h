@@ -0,0 +1,138 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <stdint.h>
+#include "arena.h"
+#include "sensor_driver.h"
+
+// One series per driver measurement, anything past this isn't kept
+#define HISTORY_MAX_SERIES 16
+
+// Tiers, newest point last. Raw points are the last reading in each
+// period, the others the min/mean/max of every reading in the period.
+// The POINTS are the most a tier holds
+#define HISTORY_RAW_PERIOD_S 30
+#define HISTORY_RAW_POINTS 120 // 1 hour
+#define HISTORY_MINUTE_PERIOD_S 60
+#define HISTORY_MINUTE_POINTS 60 // 1 hour
+#define HISTORY_QUARTER_PERIOD_S (15 * 60)
+#define HISTORY_QUARTER_POINTS 96 // 24 hours
+
+// Set to 1 to keep the raw tier as well, at 2 bytes a point. Without it
+// the minute tier's min/mean/max covers the last hour
+#ifndef HISTORY_RAW_TIER
+#define HISTORY_RAW_TIER 0
+#endif
+
+// The pool holds every tier in full for this many series, the default
+// node's 10 (Si7051, BH1750, two DS18B20 and the BME680's 6). Begin()
+// shares it out between the series found, the 15 minute tier first,
+// then the minute tier, then the raw tier, each the same length for
+// every series. A node with more series gets shorter minute and raw tiers
+#define HISTORY_POOL_SERIES 10
+#define HISTORY_SERIES_BYTES \
+    ((HISTORY_QUARTER_POINTS + HISTORY_MINUTE_POINTS) * 6 + HISTORY_RAW_TIER * HISTORY_RAW_POINTS * 2)
+#define HISTORY_POOL_BYTES (HISTORY_POOL_SERIES * HISTORY_SERIES_BYTES)
+
+// Periods without a valid reading
+#define HISTORY_MISSING INT16_MIN
+
+// Set to 1 to save the 15 minute tier to LittleFS every
+// HISTORY_MIRROR_PERIOD_S and load it back after a restart
+#ifndef HISTORY_MIRROR
+#define HISTORY_MIRROR 0
+#endif
+#define HISTORY_MIRROR_FILE "/history"
+#define HISTORY_MIRROR_PERIOD_S (60 * 60)
+
+enum HistoryTier
+{
+    HISTORY_RAW,
+    HISTORY_MINUTE,
+    HISTORY_QUARTER,
+    HISTORY_TIERS
+};
+
+struct HistoryPoint
+{
+    int16_t min;
+    int16_t mean;
+    int16_t max;
+};
+
+// Multi-resolution history of every measurement in a fixed amount of
+// RAM. Points are 16 bit, the reading divided by 10^exponent, and the
+// exponent of a series goes up (rescaling its points) when a reading
+// doesn't fit. Each reading costs the same whatever the tier lengths
+class History
+{
+public:
+    History() : _arena(_pool, sizeof(_pool)) {}
+
+    // Creates a series for each driver measurement. The mirror, if
+    // there is one, is loaded by the first Sample() after the clock is set
+    void Begin(SensorDriver *drivers[], int count);
+
+    // Adds the latest reading of each series
+    void Sample();
+
+    int GetSeriesCount() { return _seriesCount; }
+    SensorDriver *GetDriver(int series) { return _series[series].driver; }
+    const Measurement &GetMeasurement(int series);
+    uint8_t GetExponent(int series) { return _series[series].exponent; }
+    // Points held, the most a tier holds and its period
+    int GetCount(HistoryTier tier) { return _count[tier]; }
+    int GetSize(HistoryTier tier) { return _size[tier]; }
+    uint32_t GetPeriodSeconds(HistoryTier tier);
+    // End of the newest point as an epoch time, 0 if the clock isn't set
+    time_t GetEndTime(HistoryTier tier);
+    // Point index 0 is the oldest, raw points have min = mean = max
+    HistoryPoint GetPoint(int series, HistoryTier tier, int index);
+
+private:
+    struct Accumulator
+    {
+        int32_t min;
+        int32_t max;
+        int64_t sum;
+        uint16_t count;
+    };
+
+    struct Series
+    {
+        SensorDriver *driver;
+        uint8_t measurement;
+        uint8_t exponent;
+        uint32_t generation;
+        bool hasLast;
+        int32_t last;
+        Accumulator minute;
+        Accumulator quarter;
+        // In _pool, _size[tier] points each
+        int16_t *raw;
+        HistoryPoint *minutePoints;
+        HistoryPoint *quarterPoints;
+    };
+
+    Series _series[HISTORY_MAX_SERIES];
+    int _seriesCount = 0;
+    alignas(int16_t) uint8_t _pool[HISTORY_POOL_BYTES];
+    Arena _arena;
+    int _size[HISTORY_TIERS] = {};
+    int _head[HISTORY_TIERS] = {};
+    int _count[HISTORY_TIERS] = {};
+    unsigned long _endMillis[HISTORY_TIERS] = {};
+    unsigned long _mirrorMillis = 0;
+    bool _mirrorLoaded = false;
+
+    void Allocate();
+    void Close(HistoryTier tier);
+    int Push(HistoryTier tier);
+    void Fit(Series *s, int32_t value);
+    int16_t Scale(Series *s, int32_t value);
+    void Rescale(Series *s);
+    void Load();
+    void Save();
+};
+
+#endif // HISTORY_H
@@ -0,0 +1,24 @@
+#ifndef HISTORYPAGE_H
+#define HISTORYPAGE_H
+
+#include <ESP8266WebServer.h>
+
+// /api/history?tier=raw|1m|15m&format=bin|csv&id=<driver id>&m=<name>
+// Defaults to the 15 minute tier of every series as binary. The raw
+// tier has no points unless built with HISTORY_RAW_TIER.
+//
+// Binary, little endian and packed: "EH", version 1, the series count,
+// then for each series its id, measurement name and status page label
+// (each a length byte and the characters), decimals, exponent, values
+// per point (1 for raw, 3 for min/mean/max), a zero byte, the period in
+// seconds (uint32), the end of the newest point as an epoch time or 0
+// (uint32), the point count (uint16) and the points oldest first
+// (int16). A reading is value * 10^exponent / 10^decimals, -32768 is a
+// period without a reading.
+//
+// CSV has an id,measurement,time,min,mean,max row per point. Time is
+// the end of the point's period, in seconds before now (negative) when
+// the clock isn't set
+void SendHistory(ESP8266WebServer *server);
+
+#endif // HISTORYPAGE_H
@@ -0,0 +1,88 @@
+#ifndef I2CBUS_H
+#define I2CBUS_H
+
+#include <Wire.h>
+
+#define I2C_QUEUE_SIZE 8
+#define I2C_MAX_WRITE 4
+#define I2C_MAX_READ 8
+#define I2C_IDLE_MS 1000
+
+// Completion status, 1-4 are the endTransmission() errors
+#define I2C_OK 0
+#define I2C_ERROR_READ 5
+
+// Called when a transaction completes with the bytes read
+typedef void (*I2cCallback)(void *context, uint8_t status, const uint8_t *data, uint8_t len);
+
+// Queues I2C transactions from all the drivers sharing a bus and runs
+// them a step at a time from Handle(), so no single loop() pass waits
+// on more than one bus operation. While a transaction waits between its
+// write and read (a conversion) other transactions use the bus
+class I2cBus
+{
+public:
+    I2cBus(TwoWire *wire);
+    TwoWire *GetWire() { return _wire; }
+
+    // Writes writeLen bytes, waits readDelayMs and then reads readLen
+    // bytes. Either part can be empty. Returns false if the queue is full
+    bool Queue(uint8_t address, const uint8_t *writeData, uint8_t writeLen, uint8_t readLen, uint16_t readDelayMs, I2cCallback callback, void *context);
+
+    // Runs callback as a step of its own, for libraries that drive the
+    // bus themselves (BSEC)
+    bool QueueExclusive(I2cCallback callback, void *context);
+
+    // Performs at most one bus operation. Returns the ms until there is
+    // more to do, I2C_IDLE_MS if the queue is empty
+    uint32_t Handle();
+
+    uint32_t GetTransactions() { return _transactions; }
+    uint32_t GetErrors() { return _errors; }
+    uint32_t GetMinLatencyMicros() { return _transactions ? _minLatencyMicros : 0; }
+    uint32_t GetAvgLatencyMicros() { return _transactions ? _totalLatencyMicros / _transactions : 0; }
+    uint32_t GetMaxLatencyMicros() { return _maxLatencyMicros; }
+    uint32_t GetMaxStepMicros() { return _maxStepMicros; }
+
+private:
+    enum State
+    {
+        FREE,
+        PENDING,
+        WAITING
+    };
+
+    struct Transaction
+    {
+        State state;
+        bool exclusive;
+        uint8_t address;
+        uint8_t writeData[I2C_MAX_WRITE];
+        uint8_t writeLen;
+        uint8_t readLen;
+        uint16_t readDelayMs;
+        unsigned long readAtMillis;
+        unsigned long queuedMicros;
+        uint32_t seq;
+        I2cCallback callback;
+        void *context;
+    };
+
+    TwoWire *_wire;
+    Transaction _queue[I2C_QUEUE_SIZE];
+    uint32_t _nextSeq = 0;
+    uint32_t _transactions = 0;
+    uint32_t _errors = 0;
+    uint32_t _minLatencyMicros = 0;
+    uint64_t _totalLatencyMicros = 0;
+    uint32_t _maxLatencyMicros = 0;
+    uint32_t _maxStepMicros = 0;
+
+    Transaction *Allocate();
+    Transaction *Next();
+    uint32_t NextDelay();
+    void Step(Transaction *t);
+    void Complete(Transaction *t, uint8_t status, const uint8_t *data, uint8_t len);
+};
+
+#endif // I2CBUS_H
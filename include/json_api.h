@@ -0,0 +1,33 @@
+#ifndef JSONAPI_H
+#define JSONAPI_H
+
+#include <ESP8266WebServer.h>
+
+// Longest ?fields= list that is honoured, longer lists are cut short
+#define JSON_API_MAX_FIELDS 96
+
+// Most events returned in one page
+#define JSON_API_MAX_EVENTS 64
+
+// /api/readings, the latest reading of every driver
+// {"readings":[{"id":"SLc25732","valid":true,"health":100,"temperature":29.5556},...]}
+// Readings that fail the schema's range check are left out and the
+// driver marked "valid":false. health is the driver's 0 to 100 score
+void SendReadingsJson(ESP8266WebServer *server);
+
+// /api/board, the board counters shown on the status page
+// {"hostname":"es-study","uptime_s":1234,...}
+void SendBoardJson(ESP8266WebServer *server);
+
+// /api/events?before=<seq>&count=<n>, the event log newest first, n
+// (default 20) at a time up to JSON_API_MAX_EVENTS. next is the before
+// of the following page, 0 once there is nothing older. time is 0 for
+// events before the clock was set
+// {"next":38,"events":[{"seq":57,"time":1760000006,"uptime_ms":6058,
+// "type":"boot","arg":4,"value":0,"detail":"Boot, Software Restart"},...]}
+void SendEventsJson(ESP8266WebServer *server);
+
+// readings and board take ?fields=a,b to return only the named fields. Ids are always
+// included and drivers without a selected field are left out
+
+#endif // JSONAPI_H
@@ -6,12 +6,17 @@ public:
     // Creates a driver instance for witty cloud LDR
     static int CreateDriverInstances(SensorDriver *firstInstance[], int maxInstances);
     int GetPacketData(char *ptr);
-    void Handle() {}
+    uint32_t Handle();
     bool IsLastReadingValid() { return true; }
-    void GetValues(void cb(const char *, const char *));
+    void GetValues(void cb(const __FlashStringHelper *, const char *));
+    int GetReadings(const Measurement **schema, const int32_t **values);
+    const char *GetId() { return _id; }
+    FilterChain *GetFilter(int measurement) { return &_filter; }
 
 private:
     char _id[16];
-    int _lastReading = 0;
+    int32_t _lastReading = 0;
+    FilterChain _filter;
+    FilterState _filterState[1];
     LdrDriver();
 };
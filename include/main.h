@@ -4,22 +4,85 @@
 #include <ezTime.h>
 #include <Arduino.h>
 #include "sensor_driver.h"
+#include "telemetry.h"
+#include "telemetry_journal.h"
+#include "i2c_bus.h"
+#include "one_wire_bus.h"
+#include "scheduler.h"
+#include "event_stream.h"
+#include "history.h"
+#include "event_log.h"
 
-#define POLL_PERIOD_MS 20000
+// Sensor outputs are sampled every SAMPLE_PERIOD_MS and sent in
+// batches every FLUSH_PERIOD_MS
+#define SAMPLE_PERIOD_MS 5000
+#define FLUSH_PERIOD_MS 60000
+
+// Journaled packets are replayed one every JOURNAL_REPLAY_PERIOD_MS,
+// otherwise the journal is checked every JOURNAL_HANDLE_PERIOD_MS
+#define JOURNAL_REPLAY_PERIOD_MS 100
+#define JOURNAL_HANDLE_PERIOD_MS 1000
+
+// OTA and the web server are polled every SERVICE_PERIOD_MS
+#define SERVICE_PERIOD_MS 10
 
 #define MAX_SENSOR_DRIVERS 8
 extern int drivers_count;
 extern SensorDriver *drivers[MAX_SENSOR_DRIVERS];
+extern I2cBus i2cBus;
+extern OneWireBus oneWireBus;
+extern Scheduler scheduler;
+extern EventStream eventStream;
+
+extern Timezone myTZ;
+
+// Why the board last reset, resetInfo.reason
+uint32 getResetReason();
 
-#define MAX_STARTUP_LOG_ENTRIES 5
-struct startupEntry
+// setup() brings up the sensors while WiFi associates, the network
+// services and clock follow in the background. Times are millis()
+enum bootPhaseId
 {
-    time_t time;
-    uint32 reason;
+    BOOT_SETUP,       // all of setup()
+    BOOT_FILE_SYSTEM, // mounting LittleFS
+    BOOT_SENSORS,     // bus and driver detection, BSEC state restore
+    BOOT_SERVICES,    // journal, history and web routes
+    BOOT_WIFI,        // WiFi.begin() until associated
+    BOOT_TIME_SYNC,   // associated until the clock is set
+    BOOT_TIME_ZONE,   // the ezTime location lookup
+    BOOT_PHASES
 };
-extern Timezone myTZ;
-extern startupEntry startupLog[MAX_STARTUP_LOG_ENTRIES];
+struct bootPhase
+{
+    unsigned long startMillis;
+    unsigned long endMillis;
+    bool started;
+    bool done;
+};
+extern bootPhase bootPhases[BOOT_PHASES];
+PGM_P GetBootPhaseName(int phase);
+
+// Sensors are detected no sooner than this after power on
+#define SENSOR_POWER_UP_MS 1000
+
+// The boot task polls for WiFi and the clock every BOOT_POLL_MS, and
+// retries the time zone lookup up to BOOT_TIME_ZONE_TRIES times
+#define BOOT_POLL_MS 100
+#define BOOT_TIME_ZONE_TRIES 5
+// ezTime's NTP resync is checked every TIME_EVENTS_PERIOD_MS after boot
+#define TIME_EVENTS_PERIOD_MS 1000
+// A clock not set this long after WiFi associated is logged
+#define TIME_SYNC_LATE_MS 60000
 
 extern const char *hostname;
 
+extern Telemetry telemetry;
+extern TelemetryJournal journal;
+extern History history;
+extern uint32_t packetsSent;
+extern uint32_t packetsReplayed;
+
+void flushTelemetry();
+void startTasks();
+
 #endif // MAIN_H
@@ -0,0 +1,88 @@
+#ifndef MEASUREMENT_H
+#define MEASUREMENT_H
+
+#include <Arduino.h>
+#include <fixed_point.h>
+
+// Drivers describe what they report with a constexpr table of
+// Measurements. Line protocol, status rows and validity all come from
+// the table, so adding a measurement is one entry. The strings are in
+// flash (PROGMEM), the table itself stays in RAM for byte access
+
+#define MEASUREMENT_ANY_MIN INT32_MIN
+#define MEASUREMENT_ANY_MAX INT32_MAX
+
+// Longest driver id and formatted fixed point value
+#define MEASUREMENT_MAX_ID 16
+#define MEASUREMENT_MAX_VALUE 12
+
+// Buffer size for FormatValue()
+#define MEASUREMENT_MAX_TEXT 64
+
+// Telemetry only sends a value when it has moved by the measurement's
+// deadband since the last one sent, or nothing has been sent for its
+// heartbeat (this when 0)
+#define MEASUREMENT_HEARTBEAT_S (5 * 60)
+
+struct Measurement
+{
+    PGM_P name;        // line protocol measurement
+    PGM_P label;       // status page label
+    uint8_t decimals;  // values are scaled by 10^decimals
+    int32_t min;       // values outside min..max are invalid
+    int32_t max;
+    PGM_P (*describe)(int32_t value); // optional status suffix
+    int32_t deadband;  // smallest change sent, 0 sends any change
+    uint16_t heartbeat; // longest silence in seconds, 0 for the default
+};
+
+constexpr size_t ConstLength(const char *s)
+{
+    return *s ? 1 + ConstLength(s + 1) : 0;
+}
+
+// Longest output of EncodeLineProtocol() for a schema
+template <size_t N>
+constexpr size_t MaxLineProtocolLength(const Measurement (&schema)[N])
+{
+    size_t len = 0;
+    for (size_t i = 0; i < N; i++)
+        len += ConstLength(schema[i].name) + ConstLength(",id= value=\n") + MEASUREMENT_MAX_ID + MEASUREMENT_MAX_VALUE;
+    return len;
+}
+
+bool IsMeasurementValid(const Measurement &m, int32_t value);
+int EncodeLine(char *ptr, const Measurement &m, const char *id, int32_t value);
+// Value as shown on the status page, with any description, returns the length
+int FormatValue(char *buf, const Measurement &m, int32_t value);
+void EncodeValue(void cb(const __FlashStringHelper *, const char *), const Measurement &m, int32_t value);
+
+// True if every value is within its measurement's range
+template <size_t N>
+bool IsValid(const Measurement (&schema)[N], const int32_t *values)
+{
+    for (size_t i = 0; i < N; i++)
+        if (!IsMeasurementValid(schema[i], values[i]))
+            return false;
+    return true;
+}
+
+// A "name,id=<id> value=<value>\n" line per measurement, returns the length
+template <size_t N>
+int EncodeLineProtocol(char *ptr, const Measurement (&schema)[N], const char *id, const int32_t *values)
+{
+    int len = 0;
+    for (size_t i = 0; i < N; i++)
+        len += EncodeLine(&ptr[len], schema[i], id, values[i]);
+    return len;
+}
+
+// Calls back with a label and value pair per measurement
+template <size_t N>
+void EncodeValues(void cb(const __FlashStringHelper *, const char *), const Measurement (&schema)[N], const int32_t *values)
+{
+    for (size_t i = 0; i < N; i++)
+        EncodeValue(cb, schema[i], values[i]);
+}
+
+#endif // MEASUREMENT_H
@@ -0,0 +1,18 @@
+#ifndef METRICSPAGE_H
+#define METRICSPAGE_H
+
+#include <ESP8266WebServer.h>
+
+// The driver families are rendered once and reused until a driver reads
+// its sensor again. Room for the default node, larger ones are streamed
+// uncached
+#define METRICS_BODY_SIZE 2048
+// The board counters, written after the families for each request.
+// Their longest is 533 bytes
+#define METRICS_BOARD_SIZE 576
+
+// Sends the board counters and every driver reading in the Prometheus
+// text format to the client of the current request
+void SendMetricsPage(ESP8266WebServer *server);
+
+#endif // METRICSPAGE_H
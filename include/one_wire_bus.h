@@ -0,0 +1,69 @@
+#ifndef ONEWIREBUS_H
+#define ONEWIREBUS_H
+
+#include <OneWire.h>
+#include <sensor_health.h>
+
+#define ONE_WIRE_MAX_PROBES 8
+#define ONE_WIRE_PERIOD_MS 5000
+
+// Called with a probe's scratchpad, valid is false if the CRC failed
+typedef void (*OneWireCallback)(void *context, bool valid, const uint8_t *scratchpad);
+
+// Coordinates the DS18B20 probes on a OneWire bus. Each cycle sends a
+// single Skip-ROM Convert T to every probe, waits the conversion time
+// for the highest resolution seen without blocking, then reads the
+// scratchpads back one probe per Handle() call. A probe that keeps
+// failing is skipped until its backoff is over
+class OneWireBus
+{
+public:
+    OneWireBus(OneWire *wire);
+    OneWire *GetWire() { return _wire; }
+
+    // Returns false if there are already ONE_WIRE_MAX_PROBES. Reads are
+    // recorded in health, which may be null
+    bool Register(const uint8_t rom[8], OneWireCallback callback, void *context, SensorHealth *health = nullptr);
+    bool IsFull() { return _probeCount >= ONE_WIRE_MAX_PROBES; }
+
+    // Performs at most one bus operation. Returns the ms until the next
+    // step is due
+    uint32_t Handle();
+
+    uint32_t GetConversions() { return _conversions; }
+    uint32_t GetCrcErrors() { return _crcErrors; }
+
+private:
+    enum State
+    {
+        IDLE,
+        CONVERTING,
+        READING
+    };
+
+    struct Probe
+    {
+        uint8_t rom[8];
+        OneWireCallback callback;
+        void *context;
+        SensorHealth *health;
+    };
+
+    OneWire *_wire;
+    Probe _probes[ONE_WIRE_MAX_PROBES];
+    int _probeCount = 0;
+    State _state = IDLE;
+    int _nextProbe = 0;
+    uint8_t _resolutionBits = 12;
+    unsigned long _cycleStartMillis = 0;
+    unsigned long _readAtMillis = 0;
+    bool _started = false;
+    uint32_t _conversions = 0;
+    uint32_t _crcErrors = 0;
+
+    void StartConversion();
+    void ReadProbe(Probe *probe);
+    uint16_t ConversionMillis();
+};
+
+#endif // ONEWIREBUS_H
@@ -0,0 +1,13 @@
+#ifndef PROFILEPAGE_H
+#define PROFILEPAGE_H
+
+#include <ESP8266WebServer.h>
+
+// /debug/profile[?reset]
+// A text table of each scheduler task's runs and their times in us
+// (min, avg, p99, max), then the same for loop passes that ran a task
+// and the worst pass. With reset the timings are cleared after they are
+// sent
+void SendProfile(ESP8266WebServer *server);
+
+#endif // PROFILEPAGE_H
@@ -0,0 +1,56 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <Arduino.h>
+
+// Times each scheduler task and loop pass with the CPU cycle counter.
+// Set to 0 to build without it, the timing, status rows and
+// /debug/profile all go
+#ifndef PROFILER
+#define PROFILER 1
+#endif
+
+// Histogram buckets, two per doubling of the duration starting at
+// 2^PROFILE_BUCKET_SHIFT cycles. The last bucket (over 10 s at 80 MHz)
+// takes anything longer
+#define PROFILE_BUCKETS 48
+#define PROFILE_BUCKET_SHIFT 6
+
+#if PROFILER
+#define PROFILE_CYCLES() ESP.getCycleCount()
+#endif
+
+// Durations of one piece of code, min/avg/max are exact and
+// percentiles come from the histogram, within a bucket's width
+class Profile
+{
+public:
+    // Adds a duration, the cycle counter wraps every 53 s at 80 MHz so
+    // longer ones can't be measured
+    void Add(uint32_t cycles);
+    void Clear();
+
+    uint32_t GetCount() { return _count; }
+    uint32_t GetMinMicros() { return _count ? ToMicros(_minCycles) : 0; }
+    uint32_t GetAvgMicros() { return _count ? ToMicros(_totalCycles / _count) : 0; }
+    uint32_t GetMaxMicros() { return ToMicros(_maxCycles); }
+
+    // Upper end of the bucket the percentile falls in, at most the max
+    uint32_t GetPercentileMicros(int percent);
+
+    // "min/avg/p99/max" in us, returns the length
+    int Describe(char *buf, int size);
+
+    static uint32_t ToMicros(uint64_t cycles) { return cycles / ESP.getCpuFreqMHz(); }
+
+private:
+    uint32_t _count = 0;
+    uint64_t _totalCycles = 0;
+    uint32_t _minCycles = 0;
+    uint32_t _maxCycles = 0;
+    // Halved when one is about to overflow, which keeps the shape
+    uint16_t _buckets[PROFILE_BUCKETS] = {};
+    uint32_t _bucketTotal = 0;
+};
+
+#endif // PROFILER_H
@@ -0,0 +1,102 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <Arduino.h>
+#include "profiler.h"
+#include "alloc_hook.h"
+
+#define SCHEDULER_MAX_TASKS 16
+
+// Longest Idle() sleep, keeps the background WiFi stack serviced
+#define SCHEDULER_MAX_SLEEP_MS 100
+
+// Idle percentage is measured over this window
+#define SCHEDULER_IDLE_WINDOW_MS 60000
+
+// Runs the task and returns the ms until it next wants to run
+typedef uint32_t (*TaskCallback)(void *context);
+
+// Cooperative scheduler. Tasks are kept in a min-heap ordered by their
+// next deadline, Run() calls the ones that are due and Idle() sleeps
+// until the earliest deadline so loop() doesn't spin
+class Scheduler
+{
+public:
+    // Returns the task id (first run is immediate) or -1 if full
+    int Add(const char *name, TaskCallback callback, void *context);
+
+    // Brings a task's deadline forward to delayMs from now
+    void Wake(int id, uint32_t delayMs = 0);
+
+    // Runs each due task at most once
+    void Run();
+
+    // Sleeps until the next deadline
+    void Idle();
+
+    int GetTaskCount() { return _taskCount; }
+    const char *GetTaskName(int id) { return _tasks[id].name; }
+    uint32_t GetRuns(int id) { return _tasks[id].runs; }
+    uint32_t GetAvgLatenessMicros(int id) { return _tasks[id].runs ? _tasks[id].totalLatenessMicros / _tasks[id].runs : 0; }
+    uint32_t GetMaxLatenessMicros(int id) { return _tasks[id].maxLatenessMicros; }
+    uint8_t GetIdlePercent() { return _idlePercent; }
+
+#if PROFILER
+    // Time each task's runs take, and each Run() pass that ran a task
+    Profile *GetProfile(int id) { return &_tasks[id].profile; }
+    Profile *GetLoopProfile() { return &_loopProfile; }
+
+    // The longest pass, when it was (millis()) and its longest task
+    uint32_t GetWorstLoopMicros() { return Profile::ToMicros(_worstLoopCycles); }
+    unsigned long GetWorstLoopMillis() { return _worstLoopMillis; }
+    int GetWorstLoopTask() { return _worstLoopTask; }
+    uint32_t GetWorstLoopTaskMicros() { return Profile::ToMicros(_worstLoopTaskCycles); }
+
+    void ClearProfiles();
+#endif
+
+#if ALLOC_HOOK
+    // Heap allocations a task's runs have made
+    uint32_t GetAllocs(int id) { return _tasks[id].allocs; }
+#endif
+
+private:
+    struct Task
+    {
+        const char *name;
+        TaskCallback callback;
+        void *context;
+        unsigned long deadlineMicros;
+        uint8_t heapIndex;
+        uint32_t runs;
+        uint64_t totalLatenessMicros;
+        uint32_t maxLatenessMicros;
+#if PROFILER
+        Profile profile;
+#endif
+#if ALLOC_HOOK
+        uint32_t allocs;
+#endif
+    };
+
+    Task _tasks[SCHEDULER_MAX_TASKS];
+    uint8_t _heap[SCHEDULER_MAX_TASKS];
+    int _taskCount = 0;
+    unsigned long _windowStartMicros = 0;
+    uint32_t _windowSleptMicros = 0;
+    uint8_t _idlePercent = 0;
+#if PROFILER
+    Profile _loopProfile;
+    uint32_t _worstLoopCycles = 0;
+    unsigned long _worstLoopMillis = 0;
+    int _worstLoopTask = -1;
+    uint32_t _worstLoopTaskCycles = 0;
+#endif
+
+    bool IsBefore(int a, int b);
+    void Swap(int a, int b);
+    void SiftUp(int i);
+    void SiftDown(int i);
+};
+
+#endif // SCHEDULER_H
@@ -1,20 +1,52 @@
 #ifndef SENSORDRIVER_H
 #define SENSORDRIVER_H
 
+#include <measurement.h>
+#include <filter.h>
+#include <sensor_health.h>
+
 #define MIN_SANE_VALUE -40
 #define MAX_SANE_VALUE 60
 
+static const char InsaneTemprature[] PROGMEM = "Reported temprature is outside sane range";
+
+// Longest GetPacketData() output, drivers check their schema against it
+#define MAX_PACKET_DATA 320
+
+// Drivers poll their sensor every SENSOR_POLL_MS, retrying after
+// SENSOR_RETRY_MS if the bus queue was full. A failing sensor backs off
+// (sensor_health.h)
+#define SENSOR_POLL_MS 5000
+#define SENSOR_RETRY_MS 10
+
 class SensorDriver
 {
 public:
     virtual int GetPacketData(char *ptr) = 0;
-    virtual void Handle() = 0;
+    // Returns the ms until Handle() next needs calling
+    virtual uint32_t Handle() = 0;
     virtual bool IsLastReadingValid() = 0;
-    virtual void GetValues(void callback(const char *, const char *)) = 0;
+    // Calls back with name (in flash) and value pairs for the status page
+    virtual void GetValues(void callback(const __FlashStringHelper *, const char *)) = 0;
     virtual void Recalibrate() {}
 
+    // Schema and latest values, returns the number of measurements
+    virtual int GetReadings(const Measurement **schema, const int32_t **values) = 0;
+    virtual const char *GetId() = 0;
+
+    // Filter chain a measurement's raw values go through, for its reject
+    // counters
+    virtual FilterChain *GetFilter(int measurement) = 0;
+
+    // Changes each time the driver takes a reading
+    uint32_t GetGeneration() { return _generation; }
+
+    // Read counters, latency and backoff, drivers record each read
+    SensorHealth *GetHealth() { return &_health; }
+
 protected:
-    const char *InsaneTemprature = "Reported temprature is outside sane range";
+    uint32_t _generation = 0;
+    SensorHealth _health;
 };
 
 #endif // SENSORDRIVER_H
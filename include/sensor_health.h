@@ -0,0 +1,57 @@
+#ifndef SENSORHEALTH_H
+#define SENSORHEALTH_H
+
+#include <stdint.h>
+#include <measurement.h>
+
+// A device that keeps failing is polled half as often after each
+// failure in a row, up to SENSOR_MAX_BACKOFF_MS, and at the normal rate
+// again after its first good read
+#define SENSOR_MAX_BACKOFF_MS (5 * 60 * 1000UL)
+
+// Each read moves the score 1/SENSOR_HEALTH_WEIGHT of the way to 100 for
+// a success or 0 for a failure, so it recovers over a few dozen reads
+#define SENSOR_HEALTH_WEIGHT 16
+
+// health,id=SLc25732 value=97
+extern const Measurement healthMeasurement;
+
+// Read counters, latency and backoff of one sensor driver
+class SensorHealth
+{
+public:
+    // A good read, latencyMicros from asking the device to having the data
+    void Success(uint32_t latencyMicros);
+    void Failure();
+
+    // ms until the device should be read again, 0 if it is not backing off
+    uint32_t GetWaitMs();
+    // Failing more than once in a row, so polled less often
+    bool IsBackingOff() { return _failuresInRow > 1; }
+
+    // 0 to 100, recent reads count the most
+    int32_t GetScore() { return (_score + 128) >> 8; }
+    uint32_t GetSuccesses() { return _successes; }
+    uint32_t GetFailures() { return _failures; }
+    uint32_t GetFailuresInRow() { return _failuresInRow; }
+    uint32_t GetMinLatencyMicros() { return _minLatency; }
+    uint32_t GetAvgLatencyMicros() { return _successes ? _totalLatency / _successes : 0; }
+    uint32_t GetMaxLatencyMicros() { return _maxLatency; }
+
+    // "97% (1200 ok, 3 failed)", with the backoff if any, returns the length
+    int Describe(char *buf, int size);
+    // "min/avg/max" in us, returns the length
+    int DescribeLatency(char *buf, int size);
+
+private:
+    uint16_t _score = 100 << 8; // scaled by 256
+    uint32_t _successes = 0;
+    uint32_t _failures = 0;
+    uint32_t _failuresInRow = 0;
+    unsigned long _lastFailureMillis = 0;
+    uint32_t _minLatency = 0;
+    uint32_t _maxLatency = 0;
+    uint64_t _totalLatency = 0;
+};
+
+#endif // SENSORHEALTH_H
@@ -0,0 +1,77 @@
+#ifndef SERIESBLOCK_H
+#define SERIESBLOCK_H
+
+#include <stdint.h>
+#include "sensor_driver.h"
+
+// Compressed samples in the style of Facebook's Gorilla. A block holds a
+// run of samples from one driver, which share a timestamp: timestamps
+// are stored as the change in the interval between samples and each
+// measurement as its XOR with the previous value, so a steady sensor
+// costs a few bits a sample. scripts/uplink_decoder.py turns blocks
+// back into line protocol
+//
+// Block, little endian: its length in bytes (uint16), flags, the driver
+// id, the measurement count and each measurement's name and decimals
+// (strings are a length byte and the characters), the sample count
+// (uint16), the first timestamp in ms (uint64), then a bit stream, most
+// significant bit first. The first sample is each value in 32 bits,
+// every later one is
+//   delta of delta ms: 0 as '0', -64..63 as '10' + 7 bits, -256..255
+//     as '110' + 9 bits, -2048..2047 as '1110' + 12 bits, else '1111' +
+//     32 bits (two's complement)
+//   then per value, XOR with the previous one: 0 as '0', within the
+//     previous meaningful bits as '10' + those bits, else '11' + leading
+//     zeros (5 bits) + meaningful bit count - 1 (5 bits) + the bits
+#define SERIES_BLOCK_EPOCH 0x01 // timestamps are epoch ms, else millis()
+
+// Measurements a block can hold
+#define SERIES_BLOCK_MAX_FIELDS 8
+
+class SeriesBlock
+{
+public:
+    // Starts an empty block in buf for the driver's measurements,
+    // returns false if the header doesn't fit
+    bool Begin(uint8_t *buf, int size, SensorDriver *driver, uint8_t flags);
+
+    // Adds a sample, returns false and leaves the block as it was if
+    // the sample doesn't fit
+    bool Append(uint64_t time, const int32_t *values);
+
+    // Fills in the length and sample count, returns the block length
+    int Finish();
+
+    // Empties the block once it has been sent on
+    void Clear() { _count = 0; }
+
+    int GetCount() { return _count; }
+    uint8_t GetFlags() { return _flags; }
+
+private:
+    struct Field
+    {
+        int32_t value;
+        uint8_t leading;
+        uint8_t trailing;
+    };
+
+    uint8_t *_buf = nullptr;
+    int _size = 0;
+    int _countOffset = 0;
+    int _bitsOffset = 0;
+    uint32_t _bits = 0;
+    bool _overflow = false;
+    uint8_t _flags = 0;
+    uint8_t _fieldCount = 0;
+    uint16_t _count = 0;
+    uint64_t _time = 0;
+    int64_t _delta = 0;
+    Field _fields[SERIES_BLOCK_MAX_FIELDS];
+
+    void WriteBits(uint32_t value, int count);
+    void WriteTime(uint64_t time);
+    void WriteValue(Field *field, int32_t value);
+};
+
+#endif // SERIESBLOCK_H
@@ -1,4 +1,4 @@
-#include <Wire.h>
+#include <i2c_bus.h>
 #include <sensor_driver.h>
 
 class Si705Driver : SensorDriver
@@ -7,24 +7,31 @@ public:
     // Creates a driver instance for each physical device found starting at
     // firstInstance. Creates no more than maxInstances. Returns the number
     // of instances created.
-    static int CreateDriverInstances(TwoWire *wire, SensorDriver *firstInstance[], int maxInstances);
+    static int CreateDriverInstances(I2cBus *bus, SensorDriver *firstInstance[], int maxInstances);
     int GetPacketData(char *ptr);
-    void Handle();
+    uint32_t Handle();
     bool IsLastReadingValid() { return _lastReadingValid; }
-    void GetValues(void cb(const char *, const char *));
+    void GetValues(void cb(const __FlashStringHelper *, const char *));
+    int GetReadings(const Measurement **schema, const int32_t **values);
+    const char *GetId() { return _id; }
+    FilterChain *GetFilter(int measurement) { return &_filter; }
 
 private:
+    I2cBus *_bus;
     TwoWire *_i2c;
     int _address;
     char _chipType[8];
     char _id[16];
     const char *_firmwareVersion;
-    float _lastReadingCelsius;
+    int32_t _lastReadingCelsius;
     bool _lastReadingValid = false;
-    bool _conversionStarted = false;
+    FilterChain _filter;
+    FilterState _filterState[1];
     long _lastPollMillis = 0;
+    unsigned long _queuedMicros = 0;
 
-    Si705Driver(TwoWire *i2c, int address);
+    Si705Driver(I2cBus *bus, int address);
+    static void OnReading(void *context, uint8_t status, const uint8_t *data, uint8_t len);
     void set14BitResolution();
     uint8_t readChipType();
     uint8_t readFirmwareVersion();
@@ -0,0 +1,27 @@
+#ifndef STATICASSETS_H
+#define STATICASSETS_H
+
+#include <ESP8266WebServer.h>
+
+// Immutable assets are referenced with their hash in the URL, so they
+// can be cached for a year. Pages are revalidated with their ETag
+#define STATIC_ASSET_IMMUTABLE_CACHE "public, max-age=31536000, immutable"
+#define STATIC_ASSET_PAGE_CACHE "no-cache"
+
+// A file from web/, gzipped at build time and kept in flash
+struct StaticAsset
+{
+    const char *uri;
+    const char *contentType;
+    const uint8_t *gzip; // in flash
+    size_t length;
+    const char *etag; // quoted
+    bool immutable;
+};
+
+// Adds a route for each asset. Clients that send back the ETag get
+// 304 Not Modified, needs If-None-Match in the server's collected
+// headers
+void RegisterStaticAssets(ESP8266WebServer *server);
+
+#endif // STATICASSETS_H
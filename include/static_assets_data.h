@@ -0,0 +1,171 @@
+// Generated by scripts/compress_assets.py from web/, do not edit
+#ifndef STATICASSETSDATA_H
+#define STATICASSETSDATA_H
+
+#include <static_assets.h>
+
+// status.css, 928 bytes, 399 gzipped
+static const uint8_t statusCss[] PROGMEM = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xad, 0x53, 0xcb, 0x4e, 0xc3, 0x30,
+    0x10, 0xbc, 0xe7, 0x2b, 0x2c, 0xb8, 0x80, 0xd4, 0xa0, 0xf4, 0x29, 0x70, 0xee, 0x48, 0x9c, 0x11,
+    0x1f, 0xb0, 0x8e, 0x9d, 0x74, 0x55, 0xd7, 0x1b, 0xd9, 0x4e, 0x1f, 0x42, 0xfc, 0x3b, 0xeb, 0x36,
+    0x7d, 0x00, 0x05, 0x21, 0x84, 0x56, 0x89, 0xe2, 0x9d, 0xc9, 0xec, 0x64, 0x56, 0x51, 0xa4, 0xb7,
+    0xe2, 0x35, 0x53, 0x50, 0x2d, 0x1a, 0x4f, 0x9d, 0xd3, 0x79, 0x45, 0x96, 0xbc, 0x14, 0xd7, 0xa3,
+    0x22, 0x55, 0x99, 0xd5, 0xe4, 0x62, 0x5e, 0xc3, 0x12, 0xed, 0x56, 0x8a, 0xab, 0x67, 0x70, 0xe2,
+    0xd1, 0x83, 0xab, 0x30, 0x54, 0x74, 0x35, 0xe0, 0x86, 0x69, 0xc8, 0x88, 0x97, 0x27, 0x7e, 0x0e,
+    0xe0, 0x42, 0x1e, 0x8c, 0xc7, 0xba, 0xcc, 0xde, 0xb2, 0x3b, 0x45, 0xe0, 0x75, 0xd2, 0x26, 0xaf,
+    0x8d, 0xcf, 0x3d, 0x68, 0xec, 0x82, 0x14, 0x93, 0x76, 0x53, 0x66, 0x1a, 0x43, 0x6b, 0x81, 0x05,
+    0x23, 0x28, 0x6b, 0xca, 0xac, 0x05, 0xad, 0xd1, 0x35, 0x52, 0xdc, 0x27, 0xf4, 0xab, 0x1b, 0xdf,
+    0xa8, 0x9b, 0xd9, 0x64, 0x20, 0xa6, 0xc3, 0x81, 0x18, 0x4e, 0xc7, 0xb7, 0x65, 0x76, 0x06, 0x8c,
+    0x46, 0xe3, 0x81, 0x38, 0xdc, 0x18, 0x5a, 0x82, 0x6f, 0xd0, 0xe5, 0x8a, 0x62, 0xa4, 0x65, 0x3f,
+    0x90, 0xfd, 0x04, 0xe3, 0x02, 0xf9, 0x7f, 0x34, 0x34, 0x9c, 0xf1, 0xc8, 0x07, 0xbe, 0xc6, 0xb3,
+    0x3f, 0x19, 0xf2, 0xb4, 0x66, 0x37, 0x1f, 0x27, 0xe7, 0xdc, 0xdc, 0x81, 0xe0, 0x1c, 0x7d, 0x45,
+    0x2b, 0x63, 0xed, 0x71, 0xd4, 0x35, 0xdc, 0xa7, 0xea, 0x57, 0xb4, 0x36, 0xd8, 0xcc, 0xa3, 0x14,
+    0xd3, 0xa2, 0x38, 0xb3, 0x3f, 0x6a, 0x37, 0x49, 0x4d, 0x43, 0x84, 0xef, 0xd4, 0x3e, 0x73, 0x43,
+    0x0b, 0x7e, 0xf1, 0x1b, 0x72, 0x99, 0xad, 0x8c, 0x8f, 0x58, 0x81, 0xcd, 0xc1, 0x62, 0xe3, 0xa4,
+    0x58, 0xa2, 0xd6, 0x29, 0xbd, 0xa3, 0x4a, 0x4b, 0x76, 0x6b, 0xd1, 0x19, 0x96, 0xab, 0xd1, 0x5a,
+    0x29, 0x1c, 0x39, 0xc6, 0x43, 0xf4, 0xb4, 0x30, 0x97, 0xc3, 0xda, 0x63, 0xf9, 0x1a, 0x75, 0x9c,
+    0x4b, 0x31, 0x4c, 0x62, 0xe8, 0xda, 0x2e, 0x9e, 0x16, 0x17, 0xe2, 0xd6, 0xf2, 0xcb, 0x81, 0x2c,
+    0xea, 0xf2, 0xd0, 0xec, 0x33, 0x51, 0x9c, 0x9f, 0xbb, 0xb4, 0x30, 0x65, 0xb9, 0xf5, 0xd3, 0x96,
+    0x8e, 0x6b, 0x8a, 0xd4, 0xf2, 0xdc, 0x22, 0x7d, 0xdf, 0xbc, 0xcf, 0x74, 0xbc, 0x3b, 0x1d, 0x2c,
+    0xed, 0x4f, 0xc7, 0x78, 0x94, 0xa5, 0xa4, 0xdc, 0xdb, 0x94, 0x50, 0x45, 0x5c, 0x99, 0xcb, 0xff,
+    0xd4, 0xa4, 0x48, 0x75, 0xe2, 0xd6, 0x54, 0x75, 0x81, 0xa9, 0xd4, 0xc5, 0x94, 0xd2, 0x81, 0xa7,
+    0x39, 0x3a, 0x6f, 0x74, 0xe2, 0xbd, 0x03, 0x7b, 0x5e, 0x85, 0xcc, 0xa0, 0x03, 0x00, 0x00,
+};
+
+// status.js, 4168 bytes, 1592 gzipped
+static const uint8_t statusJs[] PROGMEM = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x8d, 0x57, 0x5b, 0x57, 0xdb, 0x38,
+    0x10, 0x7e, 0xe7, 0x57, 0xcc, 0xe6, 0xa1, 0x76, 0x8a, 0x71, 0x80, 0x76, 0xd9, 0x6e, 0x43, 0xd8,
+    0xd3, 0x52, 0x5a, 0xd8, 0xed, 0x65, 0x0f, 0xa1, 0xdd, 0x07, 0x0e, 0x87, 0x23, 0x6c, 0x25, 0x56,
+    0x6b, 0xa4, 0xac, 0x2c, 0x27, 0xf8, 0xb4, 0xf9, 0xef, 0x3b, 0x23, 0x5f, 0x22, 0x3b, 0x09, 0xdd,
+    0x3c, 0x80, 0xed, 0x91, 0xe6, 0xf2, 0xcd, 0x68, 0xe6, 0xd3, 0x60, 0x00, 0x6f, 0x45, 0x9a, 0x66,
+    0x20, 0x24, 0x98, 0x84, 0xc3, 0x9d, 0x62, 0x3a, 0x06, 0x26, 0x63, 0xc8, 0xb8, 0xcc, 0x94, 0x06,
+    0xad, 0x16, 0x59, 0x60, 0x45, 0x9a, 0x67, 0x06, 0xd4, 0xc4, 0x3e, 0xcf, 0xd8, 0x94, 0x83, 0xc8,
+    0x20, 0x62, 0x51, 0xc2, 0xe3, 0x70, 0x67, 0x30, 0x80, 0x4b, 0xce, 0x62, 0x21, 0xa7, 0x19, 0x30,
+    0xcd, 0x69, 0x8d, 0xc4, 0x45, 0x86, 0xa4, 0xa4, 0x7a, 0xa2, 0xd5, 0x3d, 0x0c, 0xf8, 0x9c, 0x4b,
+    0x83, 0x0b, 0x32, 0x92, 0x17, 0x10, 0x25, 0x4c, 0x4e, 0x79, 0x00, 0x0b, 0x61, 0x12, 0x95, 0x1b,
+    0x52, 0x72, 0x46, 0x2b, 0xc6, 0x2a, 0xd7, 0x11, 0x7e, 0x47, 0xeb, 0x4a, 0x46, 0x56, 0x19, 0x7a,
+    0xa3, 0xe7, 0x5c, 0x43, 0x94, 0xaa, 0x8c, 0xa3, 0xb3, 0x06, 0x26, 0x28, 0x9d, 0x2a, 0x15, 0x57,
+    0xbe, 0xa1, 0x97, 0x64, 0x98, 0x74, 0x4c, 0x78, 0x69, 0x96, 0x4d, 0x19, 0x5a, 0x46, 0x9b, 0xba,
+    0x80, 0xf1, 0xd5, 0xab, 0xab, 0xcf, 0xe3, 0xdb, 0xcb, 0xb3, 0xb7, 0x97, 0x67, 0xe3, 0xf3, 0xdb,
+    0x0f, 0x63, 0xeb, 0xf2, 0x19, 0x7a, 0x8f, 0x61, 0x59, 0xbf, 0x61, 0xca, 0xc9, 0x35, 0xc8, 0x66,
+    0x4c, 0x7f, 0x4b, 0x85, 0xe4, 0x75, 0xa8, 0x29, 0xc3, 0xb0, 0x63, 0x56, 0x54, 0x31, 0xb0, 0x99,
+    0x18, 0x24, 0x22, 0x33, 0x4a, 0x17, 0x3b, 0x73, 0xa6, 0xd7, 0x35, 0xc3, 0x08, 0x0e, 0xf6, 0xf1,
+    0x37, 0x2c, 0xc5, 0x7f, 0xbf, 0xba, 0xfc, 0xeb, 0xf6, 0x9f, 0x8b, 0x37, 0x57, 0xe7, 0x28, 0xf8,
+    0xfd, 0xc8, 0xfd, 0x7a, 0x7e, 0x76, 0xf1, 0xee, 0xfc, 0x0a, 0x3f, 0x1f, 0xe2, 0xe2, 0x9d, 0x49,
+    0x2e, 0x23, 0x23, 0x94, 0x44, 0x87, 0x26, 0x08, 0x75, 0xe2, 0xf7, 0xe1, 0xfb, 0x0e, 0xe0, 0xcf,
+    0xc6, 0xe3, 0x7b, 0x83, 0xcc, 0x30, 0x93, 0x67, 0x5e, 0xdf, 0x7e, 0xa4, 0x5f, 0x48, 0x28, 0xfb,
+    0xcd, 0x3e, 0x5f, 0xe3, 0x0e, 0xdc, 0x6d, 0x72, 0x8d, 0x4a, 0x42, 0xc3, 0x1f, 0x8c, 0xdf, 0x1f,
+    0xc2, 0x72, 0xfb, 0x06, 0x53, 0x9b, 0xa8, 0x7f, 0xb1, 0x8a, 0xf2, 0x7b, 0xcc, 0x40, 0x88, 0x60,
+    0x9c, 0xa5, 0x9c, 0x1e, 0x5f, 0x17, 0x17, 0xb1, 0xef, 0xd5, 0xb6, 0x43, 0x21, 0x25, 0xd7, 0xe7,
+    0x57, 0x1f, 0xde, 0xa3, 0xdb, 0x66, 0xd8, 0xda, 0xdc, 0x20, 0x97, 0xa1, 0xd9, 0x46, 0xb2, 0xc4,
+    0xe7, 0xa5, 0x1b, 0x9d, 0x5a, 0xf8, 0x02, 0xb3, 0x96, 0xb2, 0x3b, 0x9e, 0xd6, 0xf6, 0x09, 0x93,
+    0xaa, 0xde, 0x46, 0x8f, 0x38, 0xb1, 0xe7, 0xc1, 0x2e, 0x88, 0xb8, 0xd2, 0x4e, 0x9b, 0x6c, 0xde,
+    0x47, 0xf5, 0xde, 0x3f, 0xaa, 0x87, 0xf0, 0xdf, 0x1c, 0x93, 0x3e, 0xe6, 0x29, 0x8f, 0x30, 0x4f,
+    0xaf, 0xd2, 0xd4, 0xf7, 0x42, 0x5c, 0xe9, 0xf5, 0xe1, 0x25, 0x5c, 0xdf, 0x94, 0xbb, 0xa9, 0x7e,
+    0x7c, 0x52, 0x21, 0x70, 0xff, 0xfe, 0x10, 0xff, 0x1d, 0x5b, 0x6d, 0x61, 0xca, 0xe5, 0xd4, 0x24,
+    0xf8, 0x61, 0x77, 0x77, 0x85, 0x9c, 0x98, 0x20, 0xbc, 0x28, 0xbd, 0x16, 0x37, 0x61, 0x94, 0x88,
+    0x34, 0xd6, 0x5c, 0x5e, 0xef, 0xdf, 0x58, 0x90, 0x4f, 0x95, 0x34, 0xe8, 0x23, 0x8c, 0x46, 0xa3,
+    0x2a, 0xaa, 0x16, 0x2c, 0x75, 0x42, 0xca, 0xdd, 0xa5, 0xf1, 0xea, 0x9b, 0xcc, 0xd3, 0xd4, 0xa2,
+    0x83, 0xb5, 0xf8, 0x4a, 0xc2, 0xf8, 0xcb, 0x3b, 0x98, 0xa9, 0xb4, 0x70, 0xab, 0xef, 0x9e, 0x33,
+    0x89, 0xe7, 0x6f, 0xca, 0x66, 0x19, 0x2c, 0x12, 0x8e, 0x47, 0x8b, 0xc1, 0x8c, 0x6b, 0xa1, 0x62,
+    0x48, 0x58, 0x0c, 0x52, 0xd5, 0xf5, 0xbb, 0x42, 0xd8, 0xe6, 0x01, 0x43, 0x4b, 0x73, 0x9e, 0xb9,
+    0x00, 0xa7, 0x0a, 0x23, 0xbd, 0x90, 0x13, 0x21, 0x85, 0x29, 0x02, 0x48, 0x28, 0xf0, 0xbd, 0xfa,
+    0xbd, 0x86, 0x94, 0x36, 0x85, 0x88, 0x0d, 0x1d, 0x0d, 0xa7, 0x52, 0xe6, 0x6e, 0xa5, 0x10, 0x18,
+    0x73, 0x1b, 0x2e, 0x05, 0xb0, 0x29, 0xda, 0x55, 0xfa, 0xad, 0xd1, 0x0f, 0xcc, 0x24, 0xe1, 0xbd,
+    0x90, 0x7e, 0xaa, 0x02, 0x98, 0x3b, 0xc5, 0x61, 0x7d, 0x28, 0xa5, 0xec, 0xc1, 0x4f, 0xc4, 0x4a,
+    0xba, 0x74, 0x92, 0x6c, 0x6b, 0x0a, 0x17, 0x5e, 0xdf, 0x04, 0x88, 0x8f, 0xa0, 0x16, 0x32, 0x6a,
+    0xf2, 0xb8, 0xdd, 0xe5, 0x00, 0xc4, 0x23, 0x5e, 0x77, 0x2a, 0x9f, 0xa4, 0xa5, 0xee, 0xaa, 0x00,
+    0xda, 0x61, 0xd9, 0x50, 0xc8, 0x8d, 0x70, 0x96, 0xe3, 0xd1, 0x2c, 0x57, 0xf6, 0xdb, 0xf5, 0xbf,
+    0xe6, 0xda, 0x36, 0x4c, 0x96, 0xcd, 0x13, 0x45, 0xf7, 0x80, 0x3b, 0xaa, 0x20, 0x4a, 0xcb, 0x70,
+    0x02, 0x07, 0x58, 0xca, 0x02, 0x9e, 0xb6, 0xba, 0xc7, 0x00, 0xfc, 0xf6, 0xb2, 0x3d, 0x38, 0xa0,
+    0x82, 0xde, 0x1f, 0xb6, 0xd4, 0x15, 0xa8, 0x0e, 0x61, 0x3d, 0x21, 0xe4, 0xff, 0x00, 0xc4, 0x14,
+    0xd7, 0x61, 0xf6, 0x9e, 0xb6, 0x7b, 0xce, 0xa0, 0x92, 0xa4, 0x8a, 0x54, 0x74, 0x44, 0x87, 0x2b,
+    0x8d, 0x15, 0x24, 0x36, 0xe8, 0x87, 0xd0, 0xa8, 0xb7, 0xe2, 0x81, 0xc7, 0x3e, 0xda, 0xdd, 0x05,
+    0x2f, 0xa0, 0xd3, 0x58, 0x38, 0x1f, 0x3b, 0xa9, 0x7b, 0x04, 0xd2, 0x6d, 0x50, 0xda, 0x3e, 0x30,
+    0x9f, 0x62, 0x08, 0xde, 0x31, 0xfd, 0x5f, 0x88, 0xd8, 0x24, 0xa3, 0x1e, 0x19, 0x72, 0xa1, 0x40,
+    0xe3, 0x3d, 0x48, 0xb8, 0x98, 0x26, 0xc6, 0x15, 0x56, 0x01, 0x90, 0xf4, 0xc4, 0x2b, 0x15, 0x96,
+    0x86, 0xd6, 0x8b, 0x63, 0x46, 0xad, 0x92, 0x2c, 0xec, 0x92, 0xa9, 0xe6, 0xd0, 0x95, 0xce, 0x94,
+    0x3a, 0x67, 0xe1, 0x57, 0x7c, 0xf3, 0x3d, 0xf0, 0x6c, 0xb4, 0xbd, 0x01, 0xea, 0x6c, 0x62, 0xab,
+    0x0e, 0xb0, 0xd5, 0x80, 0x0a, 0x06, 0xf8, 0x40, 0x26, 0xcb, 0xa3, 0xfc, 0x5a, 0x48, 0x86, 0x33,
+    0xe7, 0xe0, 0x57, 0xc0, 0x9a, 0xcf, 0x0d, 0x0e, 0x30, 0xc1, 0x75, 0x80, 0xbd, 0x89, 0x43, 0x35,
+    0x39, 0x6e, 0x69, 0x7e, 0x86, 0x89, 0x6d, 0x42, 0xe5, 0x8c, 0x29, 0x68, 0x00, 0xb6, 0x8f, 0x70,
+    0xd5, 0x4a, 0x3b, 0x53, 0xc0, 0x99, 0x3f, 0xff, 0x7b, 0x14, 0x30, 0xad, 0x59, 0xf1, 0x3a, 0x9f,
+    0x4c, 0xb8, 0xfe, 0xc9, 0x44, 0xb8, 0xeb, 0x9e, 0x0b, 0xca, 0x48, 0x8c, 0xf9, 0x90, 0x7c, 0x01,
+    0x6f, 0x98, 0x61, 0x5f, 0x04, 0x5f, 0xe0, 0xaa, 0x00, 0x18, 0x36, 0x3c, 0x78, 0xde, 0x2e, 0xf4,
+    0x46, 0x4f, 0x39, 0x7b, 0x3a, 0xaa, 0x9a, 0xe3, 0x8c, 0xd4, 0x00, 0xbb, 0x3c, 0xb5, 0xf7, 0xcf,
+    0x08, 0xf7, 0x0b, 0x9f, 0x19, 0xd4, 0x47, 0x07, 0xc7, 0xf3, 0x86, 0x6b, 0x3b, 0x36, 0xf5, 0x69,
+    0xd4, 0xd0, 0xe9, 0xcf, 0xad, 0x39, 0x44, 0x49, 0x1d, 0x1b, 0x8d, 0x4d, 0x31, 0xa4, 0x99, 0x7d,
+    0x9a, 0x30, 0x7d, 0xaa, 0x62, 0xee, 0xb7, 0x4c, 0x62, 0xde, 0x0e, 0x68, 0x9a, 0xf4, 0xfb, 0xeb,
+    0x36, 0x49, 0x3a, 0xb2, 0x62, 0xb2, 0xb4, 0x26, 0xae, 0x93, 0xdf, 0x96, 0x2c, 0x77, 0x36, 0xba,
+    0xdd, 0x89, 0xf5, 0x19, 0xe2, 0x2f, 0xf1, 0x74, 0x62, 0x24, 0x72, 0x6f, 0x6f, 0x1b, 0x44, 0x82,
+    0x20, 0x2f, 0x41, 0x0c, 0x40, 0xb2, 0x7b, 0xee, 0xbc, 0xda, 0x11, 0xd3, 0xbc, 0x0f, 0x37, 0xee,
+    0x9f, 0x08, 0x9e, 0xc6, 0x59, 0x17, 0x65, 0x8c, 0xe7, 0x10, 0x15, 0x44, 0x2a, 0xa7, 0x69, 0xb5,
+    0x92, 0x1d, 0x1c, 0x55, 0x78, 0x1c, 0x22, 0x99, 0xd2, 0x39, 0xdf, 0x8e, 0xc8, 0xf3, 0xcd, 0xe6,
+    0xca, 0xbe, 0xb4, 0xa1, 0xf3, 0x6d, 0x4b, 0xa0, 0x75, 0xc1, 0xa6, 0x30, 0xa8, 0x54, 0x1f, 0x62,
+    0x87, 0x2a, 0xbd, 0xde, 0x84, 0x49, 0x63, 0xa8, 0x76, 0xfb, 0x62, 0xe5, 0xb5, 0x5f, 0x07, 0x8b,
+    0x9d, 0xfd, 0x19, 0xb6, 0xbc, 0x43, 0xea, 0x89, 0xfd, 0xad, 0x91, 0x38, 0x33, 0xc3, 0xf6, 0x9f,
+    0x72, 0x24, 0xec, 0x3d, 0x3b, 0xfc, 0xed, 0xe8, 0x05, 0xee, 0xa6, 0xd9, 0x80, 0x0a, 0xe6, 0x1b,
+    0x76, 0x2e, 0x37, 0xc6, 0x4e, 0x8c, 0xa5, 0xcd, 0x69, 0xd6, 0x77, 0x5a, 0xf6, 0x00, 0x4f, 0x9e,
+    0x54, 0xd0, 0x9f, 0x50, 0xe3, 0xde, 0x1e, 0x64, 0xc4, 0x53, 0xca, 0x6f, 0x87, 0xc5, 0x20, 0x85,
+    0xb1, 0x5d, 0x01, 0xbb, 0xd1, 0x8f, 0x1f, 0x74, 0xa6, 0x67, 0x33, 0x2e, 0xe3, 0x53, 0xe2, 0x22,
+    0x7e, 0xc3, 0x98, 0x22, 0x24, 0x03, 0x86, 0x57, 0xa4, 0xc9, 0xf7, 0x62, 0x31, 0xf7, 0xfa, 0x5b,
+    0x30, 0x20, 0x2b, 0x61, 0x84, 0xe4, 0x36, 0xfb, 0x58, 0xd6, 0x97, 0x57, 0xaa, 0x7f, 0x64, 0xb5,
+    0xcb, 0xfd, 0x5a, 0x24, 0xe3, 0x67, 0x58, 0x2d, 0xbb, 0x6c, 0x10, 0x9b, 0xe4, 0xf7, 0x9e, 0x88,
+    0x7b, 0x2f, 0x7b, 0xc7, 0xb1, 0x16, 0x44, 0xec, 0x45, 0x7c, 0xd2, 0x0b, 0x7a, 0xc7, 0x16, 0xc1,
+    0x13, 0xfa, 0x6e, 0x55, 0xe3, 0xb7, 0x30, 0x0c, 0x97, 0x41, 0xc5, 0xe9, 0x33, 0x87, 0xeb, 0x13,
+    0xb9, 0x27, 0x3d, 0xc2, 0xb9, 0x90, 0xc4, 0x8a, 0x67, 0xd2, 0x33, 0xc8, 0x8c, 0xe6, 0x48, 0xa0,
+    0x1a, 0x12, 0x75, 0x0f, 0x05, 0x77, 0x9a, 0xab, 0xbd, 0x96, 0xf8, 0xdc, 0xa5, 0x46, 0xba, 0xbe,
+    0xbb, 0x8c, 0xe0, 0xcf, 0xf1, 0xa7, 0x8f, 0x21, 0x06, 0x97, 0x71, 0x9f, 0x87, 0x31, 0x76, 0x3c,
+    0x67, 0x9a, 0xfd, 0xf2, 0x13, 0x6a, 0x5a, 0xab, 0x09, 0x91, 0xa3, 0xba, 0x19, 0x6e, 0x18, 0xfd,
+    0x70, 0x67, 0x13, 0x27, 0x28, 0xe1, 0xf9, 0x74, 0xf7, 0x15, 0x13, 0x1d, 0x7e, 0xe3, 0x45, 0xe6,
+    0xd7, 0x8a, 0xfa, 0x1b, 0x46, 0x57, 0x8b, 0x38, 0xd7, 0x9e, 0x55, 0x4d, 0x01, 0x2b, 0xd9, 0x13,
+    0xb1, 0xf7, 0x38, 0x25, 0x73, 0xab, 0xd6, 0xf1, 0x78, 0xbd, 0x7c, 0x6d, 0xd9, 0x76, 0x74, 0xad,
+    0xd8, 0xef, 0x41, 0x87, 0xfd, 0x36, 0xd1, 0x5f, 0x5b, 0x3d, 0x4e, 0x27, 0xe0, 0x69, 0xc6, 0x3b,
+    0x1e, 0xb5, 0xf0, 0x58, 0x15, 0x85, 0x73, 0xfd, 0xc3, 0x45, 0x91, 0xc2, 0x82, 0x8b, 0x90, 0x52,
+    0xdd, 0x15, 0x78, 0xe3, 0xcb, 0x78, 0x3a, 0x01, 0x36, 0x31, 0x58, 0x2c, 0x0c, 0xc7, 0x91, 0x59,
+    0x28, 0xfd, 0x0d, 0xb8, 0xd6, 0x0a, 0x47, 0xeb, 0x5d, 0x6e, 0x90, 0x0a, 0xdb, 0x1b, 0x64, 0xb5,
+    0x42, 0x96, 0x22, 0xd4, 0x32, 0x4b, 0x0b, 0x27, 0xf7, 0x0a, 0x2f, 0x03, 0x35, 0x78, 0x99, 0xed,
+    0x23, 0x78, 0xb1, 0x64, 0xa9, 0x5f, 0xb9, 0x14, 0xac, 0xdf, 0xe7, 0x4a, 0xe7, 0x1c, 0x97, 0x09,
+    0x96, 0x85, 0x90, 0xb1, 0x5a, 0x84, 0x8e, 0xbf, 0x6e, 0x39, 0x55, 0xf7, 0xdc, 0x72, 0x6a, 0x3a,
+    0x6b, 0x70, 0x7c, 0x97, 0x22, 0xaf, 0x8a, 0xbc, 0x7c, 0x0b, 0x95, 0xbc, 0xe7, 0x59, 0x46, 0x15,
+    0x3c, 0x2a, 0xab, 0xb3, 0x23, 0x2d, 0x43, 0x19, 0xad, 0xe6, 0xab, 0xdf, 0xcd, 0x7f, 0xb5, 0x94,
+    0x52, 0x50, 0x8c, 0xf1, 0xae, 0xc6, 0x6d, 0x2d, 0x38, 0xa6, 0xc3, 0xd3, 0xf7, 0x9f, 0xc6, 0x67,
+    0x6f, 0xfa, 0x1d, 0xc6, 0x4a, 0x68, 0x54, 0x49, 0xc0, 0x30, 0x57, 0x99, 0xaa, 0x25, 0x2e, 0x44,
+    0x2b, 0x52, 0x12, 0x10, 0xb7, 0x79, 0x0a, 0x47, 0xfb, 0xf8, 0x87, 0xee, 0xba, 0xb8, 0xf0, 0x3f,
+    0x40, 0x8a, 0x0a, 0x67, 0x48, 0x10, 0x00, 0x00,
+};
+
+// status.html, 497 bytes, 326 gzipped
+static const uint8_t statusHtml[] PROGMEM = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x85, 0x51, 0x4d, 0x4f, 0xc3, 0x30,
+    0x0c, 0xbd, 0xf3, 0x2b, 0x42, 0xce, 0x2b, 0xdd, 0xc4, 0x86, 0x40, 0x5a, 0x86, 0xc6, 0xd8, 0x01,
+    0x09, 0x09, 0x34, 0x7a, 0xe1, 0x98, 0x26, 0x2e, 0x35, 0xa4, 0x49, 0x95, 0xb8, 0x9d, 0xf6, 0xef,
+    0x71, 0xb6, 0xa1, 0x1d, 0xb9, 0xc4, 0xb2, 0xf5, 0x3e, 0xfc, 0x9c, 0xe5, 0xf5, 0xf3, 0xdb, 0xa6,
+    0xfa, 0x7c, 0xdf, 0x8a, 0x96, 0x3a, 0xb7, 0xba, 0x5a, 0xe6, 0x22, 0x9c, 0xf6, 0x5f, 0x4a, 0x82,
+    0x97, 0x79, 0x00, 0xda, 0x72, 0xe9, 0x80, 0xb4, 0x30, 0xad, 0x8e, 0x09, 0x48, 0xc9, 0x81, 0x9a,
+    0xe2, 0x5e, 0xfe, 0x8d, 0xbd, 0xee, 0x40, 0xc9, 0x11, 0x61, 0xdf, 0x87, 0x48, 0x52, 0x98, 0xe0,
+    0x09, 0x3c, 0xc3, 0xf6, 0x68, 0xa9, 0x55, 0x16, 0x46, 0x34, 0x50, 0x1c, 0x9b, 0x09, 0x7a, 0x24,
+    0xd4, 0xae, 0x48, 0x46, 0x3b, 0x50, 0xb3, 0x49, 0x6a, 0x23, 0xfa, 0x9f, 0x82, 0x42, 0xd1, 0x20,
+    0x29, 0x1f, 0x26, 0x7f, 0x32, 0xc7, 0xde, 0x84, 0x11, 0x62, 0xf6, 0x71, 0x0c, 0x12, 0x11, 0x9c,
+    0x92, 0x89, 0x0e, 0x0e, 0x52, 0x0b, 0xc0, 0x46, 0x6d, 0x84, 0x46, 0xc9, 0x32, 0x91, 0xa6, 0x21,
+    0xdd, 0x98, 0x94, 0x1e, 0x47, 0x55, 0xdf, 0x99, 0xc5, 0x62, 0xf1, 0x30, 0xcf, 0xac, 0xf2, 0xbc,
+    0x7c, 0x1d, 0xec, 0x81, 0x8b, 0xc5, 0x51, 0xa0, 0xcd, 0x12, 0x19, 0x2f, 0x57, 0xcb, 0x92, 0x27,
+    0xa7, 0x39, 0xbf, 0x4d, 0x88, 0x9d, 0xe0, 0x3c, 0x6d, 0x60, 0x48, 0x1f, 0x12, 0xeb, 0x6b, 0x43,
+    0x18, 0x3c, 0x3b, 0x98, 0xd0, 0x75, 0xda, 0xdb, 0x94, 0x45, 0xd1, 0xf7, 0x03, 0x09, 0x3a, 0xf4,
+    0x9c, 0x39, 0x0d, 0x75, 0x87, 0x0c, 0x1c, 0xb5, 0x1b, 0xb8, 0xdd, 0x6d, 0x3f, 0xaa, 0xf5, 0xae,
+    0x92, 0xe7, 0x8b, 0x44, 0x60, 0x27, 0x3e, 0xc8, 0x7f, 0xa4, 0xcd, 0xfa, 0xf5, 0xe5, 0x69, 0xb7,
+    0xae, 0xb6, 0x17, 0x22, 0x5f, 0x07, 0xeb, 0xa8, 0x09, 0x8e, 0x31, 0xf2, 0x6a, 0xb9, 0x9e, 0x16,
+    0x4d, 0x26, 0x62, 0x4f, 0x22, 0x45, 0x73, 0xc9, 0xfe, 0x9d, 0xa3, 0x37, 0x76, 0x3a, 0x9f, 0xde,
+    0x4e, 0x67, 0x39, 0xd9, 0x09, 0x94, 0x49, 0xe7, 0xf0, 0xe5, 0xe9, 0x83, 0x7f, 0x01, 0xd9, 0xcb,
+    0xc9, 0x6f, 0xf1, 0x01, 0x00, 0x00,
+};
+
+static const StaticAsset staticAssets[] = {
+    {"/status.css", "text/css", statusCss, sizeof(statusCss), "\"b6c5559483027b9c\"", true},
+    {"/status.js", "application/javascript", statusJs, sizeof(statusJs), "\"fd040301bfa089c1\"", true},
+    {"/", "text/html", statusHtml, sizeof(statusHtml), "\"f9ebf2745768e079\"", false},
+};
+
+#endif // STATICASSETSDATA_H
@@ -1,2 +1,20 @@
+#include <ESP8266WebServer.h>
 #include "sensor_driver.h"
-const char *BuildStatusPage();
+#include "event_log.h"
+
+// Streams the board and sensor rows of the status page to the client
+// of the current request, the static page around them is a
+// StaticAsset
+void SendStatusPage(ESP8266WebServer *server);
+
+// Events shown, newest first. /api/events pages through the rest
+#define STATUS_EVENTS 8
+
+// Description of a reset reason, in flash
+PGM_P GetResetReasonName(uint32 reason);
+
+// "Boot, Software Restart" for an event log record, returns the length
+int DescribeEvent(const EventRecord *e, char *buf, int size);
+
+// Formats the station IP without a String, buf needs 16 bytes
+char *FormatLocalIp(char *buf);
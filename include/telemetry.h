@@ -0,0 +1,96 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+#include "sensor_driver.h"
+#include "series_block.h"
+
+// Bytes of timestamped line protocol held between flushes. Oldest
+// samples are dropped when it is full, the flush is woken well before
+// that so it only has to cover one send
+#define SAMPLE_RING_SIZE 4096
+
+// Largest UDP packet sent, keeps clear of fragmentation
+#define MAX_PACKET_SIZE 1400
+
+// Set to 1 to send samples as compressed blocks (series_block.h) rather
+// than line protocol, for scripts/uplink_decoder.py to expand on the
+// server. Each driver has an open block that is queued when it fills or
+// at the next flush
+#ifndef TELEMETRY_COMPRESSED
+#define TELEMETRY_COMPRESSED 0
+#endif
+#define TELEMETRY_BLOCK_SIZE 256
+
+// Drivers and measurements per driver whose last sent value is tracked
+// for deadband reporting, others are sent every sample
+#define TELEMETRY_MAX_DRIVERS 8 // MAX_SENSOR_DRIVERS
+#define TELEMETRY_MAX_FIELDS SERIES_BLOCK_MAX_FIELDS
+
+// Compressed packets start with "EG", the version, a zero byte and
+// millis() when sent (uint32, to place samples stamped with millis()),
+// then whole blocks
+#define TELEMETRY_PACKET_MAGIC "EG"
+#define TELEMETRY_PACKET_VERSION 1
+#define TELEMETRY_PACKET_HEADER 8
+
+// Holds timestamped driver samples until they are sent as batches
+class Telemetry
+{
+public:
+    // Queues the values of each driver with a valid reading that have
+    // moved past their deadband or heartbeat, stamped with the time now.
+    // Compressed blocks hold whole samples, so any such value sends the
+    // driver's sample. Line protocol also carries each driver's health
+    // score, valid reading or not
+    void Sample(SensorDriver *drivers[], int count);
+
+    // Moves as many whole samples as fit into packet, oldest first,
+    // and null terminates it. Returns the packet length, 0 if the lines
+    // sampled before the clock was set are being held until it is
+    int BuildPacket(char *packet, int size);
+
+    bool IsEmpty() { return _used == 0 && _openSamples == 0; }
+    bool IsNearlyFull() { return _used >= SAMPLE_RING_SIZE * 3 / 4; }
+    int GetQueuedBytes() { return _used; }
+    uint32_t GetDroppedSamples() { return _droppedSamples; }
+    // Values not sent because they were within their deadband
+    uint32_t GetSuppressedValues() { return _suppressedValues; }
+
+private:
+    struct LastSent
+    {
+        int32_t value;
+        unsigned long millis;
+        bool sent;
+    };
+
+    char _ring[SAMPLE_RING_SIZE];
+    int _head = 0;
+    int _used = 0;
+    uint32_t _droppedSamples = 0;
+    int _openSamples = 0;
+    uint32_t _suppressedValues = 0;
+    LastSent _lastSent[TELEMETRY_MAX_DRIVERS][TELEMETRY_MAX_FIELDS] = {};
+    LastSent _lastHealth[TELEMETRY_MAX_DRIVERS] = {};
+#if TELEMETRY_COMPRESSED
+    SeriesBlock _blocks[TELEMETRY_MAX_DRIVERS];
+    uint8_t _blockData[TELEMETRY_MAX_DRIVERS][TELEMETRY_BLOCK_SIZE];
+#endif
+
+    void SampleLines(SensorDriver *drivers[], int count);
+    void SampleBlocks(SensorDriver *drivers[], int count);
+    bool IsDue(int driver, int field, const Measurement &m, int32_t value);
+    void Sent(int driver, int field, int32_t value);
+    bool IsDue(LastSent *last, const Measurement &m, int32_t value);
+    void Sent(LastSent *last, int32_t value);
+    void Seal(int block);
+    void Push(const char *data, int len);
+    bool IsUntimed();
+    int ReadStamped(char *dest, int size);
+    int PeekLength();
+    void Read(int offset, char *dest, int len);
+    void Drop(int len);
+};
+
+#endif // TELEMETRY_H
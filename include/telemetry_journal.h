@@ -0,0 +1,62 @@
+#ifndef TELEMETRYJOURNAL_H
+#define TELEMETRYJOURNAL_H
+
+#include <stdint.h>
+#include <LittleFS.h>
+
+// Packets that couldn't be sent are appended to segment files in this
+// directory, oldest segments are dropped once there are too many
+#define JOURNAL_DIR "/tj"
+#define JOURNAL_SEGMENT_SIZE 4096
+#define JOURNAL_MAX_SEGMENTS 64
+
+// Appends are collected in RAM and written together when the buffer
+// fills or has held data for JOURNAL_COMMIT_MS, to limit flash wear
+#define JOURNAL_WRITE_BUFFER 2048
+#define JOURNAL_COMMIT_MS (2 * 60 * 1000)
+
+// Store and forward journal for telemetry packets. Records are CRC
+// protected and replayed oldest first
+class TelemetryJournal
+{
+public:
+    // Finds the segments left from before the last restart
+    void Begin();
+
+    // Queue a packet for later
+    void Append(const char *packet, int len);
+
+    // Write out buffered appends once they have waited long enough
+    void Handle();
+
+    // Copies the oldest packet into packet (null terminated) and returns
+    // its length, or 0 if there is nothing to replay. The packet stays
+    // in the journal until Pop() is called
+    int Peek(char *packet, int size);
+    void Pop();
+
+    bool IsEmpty() { return _firstSeq == _lastSeq && _lastSize == 0 && _bufferLen == 0; }
+    int GetSegmentCount() { return _lastSeq - _firstSeq + (_lastSize > 0 ? 1 : 0); }
+    uint32_t GetDroppedSegments() { return _droppedSegments; }
+    uint32_t GetCorruptRecords() { return _corruptRecords; }
+
+private:
+    uint32_t _firstSeq = 0;
+    uint32_t _lastSeq = 0;
+    int _lastSize = 0;
+    File _readFile;
+    uint32_t _readOffset = 0;
+    int _pendingLen = 0;
+    char _buffer[JOURNAL_WRITE_BUFFER];
+    int _bufferLen = 0;
+    unsigned long _bufferSinceMillis = 0;
+    uint32_t _droppedSegments = 0;
+    uint32_t _corruptRecords = 0;
+
+    void Commit();
+    void Seal();
+    void RemoveOldest();
+    void SegmentName(uint32_t seq, char *name);
+};
+
+#endif // TELEMETRYJOURNAL_H
@@ -0,0 +1,11 @@
+#ifndef WEBARGS_H
+#define WEBARGS_H
+
+#include <ESP8266WebServer.h>
+
+// The value of the request argument named name (in flash), nullptr if
+// there isn't one. Unlike hasArg() and arg(name) this makes no String
+// copies, the value lasts until the request has been handled
+const char *FindArg(ESP8266WebServer *server, PGM_P name);
+
+#endif // WEBARGS_H
@@ -0,0 +1,165 @@
+#include <Arduino.h>
+#include "sim.h"
+
+HardwareSerial Serial;
+EspClass ESP;
+
+unsigned long millis()
+{
+    return (unsigned long)(Sim::Micros() / 1000);
+}
+
+unsigned long micros()
+{
+    return (unsigned long)Sim::Micros();
+}
+
+void delay(unsigned long ms)
+{
+    Sim::AdvanceMicros((uint64_t)ms * 1000);
+}
+
+void delayMicroseconds(unsigned int us)
+{
+    Sim::AdvanceMicros(us);
+}
+
+void yield()
+{
+}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+}
+
+void digitalWrite(uint8_t pin, uint8_t value)
+{
+}
+
+int digitalRead(uint8_t pin)
+{
+    return LOW;
+}
+
+int analogRead(uint8_t pin)
+{
+    return Sim::AnalogValue();
+}
+
+static char *formatInteger(unsigned long value, bool negative, char *str, int base)
+{
+    char tmp[34];
+    int i = 0;
+    do
+    {
+        int digit = value % base;
+        tmp[i++] = digit < 10 ? '0' + digit : 'a' + digit - 10;
+        value /= base;
+    } while (value != 0);
+    char *p = str;
+    if (negative)
+        *p++ = '-';
+    while (i > 0)
+        *p++ = tmp[--i];
+    *p = 0;
+    return str;
+}
+
+char *itoa(int value, char *str, int base)
+{
+    return ltoa(value, str, base);
+}
+
+char *utoa(unsigned int value, char *str, int base)
+{
+    return formatInteger(value, false, str, base);
+}
+
+char *ultoa(unsigned long value, char *str, int base)
+{
+    return formatInteger(value, false, str, base);
+}
+
+char *ltoa(long value, char *str, int base)
+{
+    if (value < 0 && base == 10)
+        return formatInteger(-(unsigned long)value, true, str, base);
+    return formatInteger((unsigned long)value, false, str, base);
+}
+
+char *dtostrf(double value, signed char width, unsigned char prec, char *str)
+{
+    sprintf(str, "%*.*f", width, prec, value);
+    return str;
+}
+
+size_t HardwareSerial::write(uint8_t c)
+{
+    return write(&c, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size)
+{
+    if (Sim::SerialEcho())
+        fwrite(buffer, 1, size, stdout);
+    return size;
+}
+
+void HardwareSerial::flush()
+{
+    fflush(stdout);
+}
+
+uint32_t EspClass::getChipId()
+{
+    return Sim::ChipId();
+}
+
+uint32_t EspClass::getFreeHeap()
+{
+    return Sim::FreeHeap();
+}
+
+uint8_t EspClass::getHeapFragmentation()
+{
+    return Sim::HeapFragmentation();
+}
+
+uint32_t EspClass::getMaxFreeBlockSize()
+{
+    return Sim::FreeHeap() * (100 - Sim::HeapFragmentation()) / 100;
+}
+
+// The core runs at 80 MHz
+uint32_t EspClass::getCycleCount()
+{
+    return (uint32_t)(Sim::Micros() * 80);
+}
+
+static uint32_t rtcUserMemory[128];
+
+bool EspClass::rtcUserMemoryRead(uint32_t offset, uint32_t *data, size_t size)
+{
+    if (size == 0 || offset * 4 + size > sizeof(rtcUserMemory))
+        return false;
+    memcpy(data, (uint8_t *)rtcUserMemory + offset * 4, size);
+    return true;
+}
+
+bool EspClass::rtcUserMemoryWrite(uint32_t offset, uint32_t *data, size_t size)
+{
+    if (size == 0 || offset * 4 + size > sizeof(rtcUserMemory))
+        return false;
+    memcpy((uint8_t *)rtcUserMemory + offset * 4, data, size);
+    return true;
+}
+
+void EspClass::restart()
+{
+    Sim::Restart();
+}
+
+void EspClass::reset()
+{
+    Sim::Restart();
+}
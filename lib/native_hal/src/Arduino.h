@@ -0,0 +1,100 @@
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+// Host stand-in for the parts of the ESP8266 Arduino core the firmware uses
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <algorithm>
+#include "WString.h"
+#include "Print.h"
+#include "user_interface.h"
+
+using std::max;
+using std::min;
+
+typedef uint8_t byte;
+typedef uint8_t uint8;
+typedef uint16_t uint16;
+typedef uint32_t uint32;
+typedef int32_t sint32;
+
+// Flash and RAM are the same address space on the host, so the _P
+// functions are the plain ones
+#define PROGMEM
+#define PSTR(s) (s)
+#define F(s) (reinterpret_cast<const __FlashStringHelper *>(s))
+#define FPSTR(p) (reinterpret_cast<const __FlashStringHelper *>(p))
+typedef const char *PGM_P;
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+#define strlen_P strlen
+#define strcpy_P strcpy
+#define strncpy_P strncpy
+#define strcmp_P strcmp
+#define strncmp_P strncmp
+#define memcpy_P memcpy
+#define sprintf_P sprintf
+#define snprintf_P snprintf
+#define vsnprintf_P vsnprintf
+
+#define LOW 0
+#define HIGH 1
+#define INPUT 0
+#define OUTPUT 1
+#define LED_BUILTIN 2
+#define A0 17
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+
+char *itoa(int value, char *str, int base);
+char *utoa(unsigned int value, char *str, int base);
+char *ultoa(unsigned long value, char *str, int base);
+char *ltoa(long value, char *str, int base);
+char *dtostrf(double value, signed char width, unsigned char prec, char *str);
+
+// Serial port, output goes to stdout
+class HardwareSerial : public Print
+{
+public:
+    void begin(unsigned long baud) {}
+    size_t write(uint8_t c);
+    size_t write(const uint8_t *buffer, size_t size);
+    using Print::write;
+    void flush();
+};
+extern HardwareSerial Serial;
+
+// Chip and heap information
+class EspClass
+{
+public:
+    uint32_t getChipId();
+    uint8_t getCpuFreqMHz() { return 80; }
+    uint32_t getFreeHeap();
+    uint8_t getHeapFragmentation();
+    uint32_t getMaxFreeBlockSize();
+    uint32_t getCycleCount();
+    // 512 bytes that survive a restart, offset is in 4 byte blocks
+    bool rtcUserMemoryRead(uint32_t offset, uint32_t *data, size_t size);
+    bool rtcUserMemoryWrite(uint32_t offset, uint32_t *data, size_t size);
+    void restart();
+    void reset();
+};
+extern EspClass ESP;
+
+#endif // ARDUINO_H
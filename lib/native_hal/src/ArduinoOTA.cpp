@@ -0,0 +1,3 @@
+#include <ArduinoOTA.h>
+
+ArduinoOTAClass ArduinoOTA;
@@ -0,0 +1,170 @@
+#include <ESP8266WebServer.h>
+#include "sim.h"
+
+// Roughly 1 us per byte at 11 Mbit/s
+#define SEND_MICROS_PER_BYTE 1
+
+static ESP8266WebServer *activeServer = nullptr;
+
+void ESP8266WebServer::begin()
+{
+    activeServer = this;
+}
+
+void ESP8266WebServer::on(const String &uri, HTTPMethod method, THandlerFunction handler)
+{
+    SimHeapPause pause;
+    _routes.push_back({uri.c_str(), method, handler});
+}
+
+String ESP8266WebServer::arg(const String &name)
+{
+    auto it = _args.find(name.c_str());
+    return it == _args.end() ? String() : String(it->second);
+}
+
+bool ESP8266WebServer::hasArg(const String &name)
+{
+    return _args.count(name.c_str()) != 0;
+}
+
+// Held by the server like the ESP8266 core does, so no copies are made
+const String &ESP8266WebServer::arg(int i)
+{
+    static const String empty;
+    return i >= 0 && i < (int)_argValues.size() ? _argValues[i] : empty;
+}
+
+const String &ESP8266WebServer::argName(int i)
+{
+    static const String empty;
+    return i >= 0 && i < (int)_argNames.size() ? _argNames[i] : empty;
+}
+
+void ESP8266WebServer::collectHeaders(const char *headerKeys[], const size_t headerKeysCount)
+{
+    SimHeapPause pause;
+    _collect.assign(headerKeys, headerKeys + headerKeysCount);
+}
+
+String ESP8266WebServer::header(const String &name)
+{
+    auto it = _requestHeaders.find(name.c_str());
+    return it == _requestHeaders.end() ? String() : String(it->second);
+}
+
+bool ESP8266WebServer::hasHeader(const String &name)
+{
+    return _requestHeaders.count(name.c_str()) != 0;
+}
+
+void ESP8266WebServer::sendHeader(const String &name, const String &value, bool first)
+{
+    SimHeapPause pause;
+    _headers[name.c_str()] = value.c_str();
+}
+
+void ESP8266WebServer::send(int code, const char *contentType, const char *content, size_t contentLength)
+{
+    SimHeapPause pause;
+    if (_response == nullptr)
+        return;
+    _response->code = code;
+    _response->contentType = contentType ? contentType : "";
+    _response->headers = _headers;
+    size_t len = contentLength;
+    _response->body.append(content, len);
+    Sim::AdvanceMicros(200 + len * SEND_MICROS_PER_BYTE);
+}
+
+// Chunked content is collected already decoded, counting the chunks
+void ESP8266WebServer::sendContent(const char *content, size_t size)
+{
+    SimHeapPause pause;
+    if (_response == nullptr)
+        return;
+    if (size > 0)
+    {
+        _response->body.append(content, size);
+        _response->chunks++;
+    }
+    Sim::AdvanceMicros(200 + size * SEND_MICROS_PER_BYTE);
+}
+
+bool ESP8266WebServer::Dispatch(HTTPMethod method, const char *uri, const std::map<std::string, std::string> &args,
+                                const std::map<std::string, std::string> &headers, SimHttpResponse *response)
+{
+    {
+        SimHeapPause pause;
+        _uri = uri;
+        _method = method;
+        _args = args;
+        _argNames.clear();
+        _argValues.clear();
+        for (auto &a : args)
+        {
+            _argNames.push_back(String(a.first));
+            _argValues.push_back(String(a.second));
+        }
+        _headers.clear();
+        _requestHeaders.clear();
+        for (const std::string &key : _collect)
+        {
+            auto it = headers.find(key);
+            if (it != headers.end())
+                _requestHeaders[key] = it->second;
+        }
+    }
+    _contentLength = CONTENT_LENGTH_NOT_SET;
+    _response = response;
+    _client = WiFiClient(response->connection);
+
+    bool handled = false;
+    for (Route &route : _routes)
+    {
+        if (route.uri == uri && (route.method == HTTP_ANY || route.method == method))
+        {
+            route.handler();
+            handled = true;
+            break;
+        }
+    }
+    if (!handled && _notFound)
+    {
+        _notFound();
+        handled = true;
+    }
+    _response = nullptr;
+    _client = WiFiClient();
+    return handled;
+}
+
+// A query in the uri (a=1&b=2, not decoded) is added to args
+SimHttpResponse Sim::HttpRequest(int method, const char *uri, const std::map<std::string, std::string> &args,
+                                 const std::map<std::string, std::string> &headers)
+{
+    SimHttpResponse response;
+    std::string path = uri;
+    std::map<std::string, std::string> allArgs = args;
+    {
+        SimHeapPause pause;
+        response.connection = std::make_shared<SimTcpConnection>();
+        size_t query = path.find('?');
+        if (query != std::string::npos)
+        {
+            std::string rest = path.substr(query + 1);
+            path.resize(query);
+            while (!rest.empty())
+            {
+                size_t end = rest.find('&');
+                std::string pair = rest.substr(0, end);
+                size_t eq = pair.find('=');
+                allArgs[pair.substr(0, eq)] = eq == std::string::npos ? "" : pair.substr(eq + 1);
+                rest = end == std::string::npos ? "" : rest.substr(end + 1);
+            }
+        }
+    }
+    if (activeServer == nullptr || !activeServer->Dispatch((HTTPMethod)method, path.c_str(), allArgs, headers, &response))
+        response.code = 404;
+    return response;
+}
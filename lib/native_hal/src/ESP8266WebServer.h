@@ -0,0 +1,96 @@
+#ifndef ESP8266WEBSERVER_H
+#define ESP8266WEBSERVER_H
+
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+#include <Arduino.h>
+#include "WiFiClient.h"
+
+enum HTTPMethod
+{
+    HTTP_ANY,
+    HTTP_GET,
+    HTTP_HEAD,
+    HTTP_POST,
+    HTTP_PUT,
+    HTTP_PATCH,
+    HTTP_DELETE,
+    HTTP_OPTIONS
+};
+
+#define CONTENT_LENGTH_UNKNOWN ((size_t)-1)
+#define CONTENT_LENGTH_NOT_SET ((size_t)-2)
+
+struct SimHttpResponse;
+
+// Requests are made with Sim::HttpRequest(), which runs the matching
+// handler and collects what it sends
+class ESP8266WebServer
+{
+public:
+    typedef std::function<void(void)> THandlerFunction;
+
+    ESP8266WebServer(int port = 80) {}
+    void begin();
+    void handleClient() {}
+    void close() {}
+
+    void on(const String &uri, THandlerFunction handler) { on(uri, HTTP_ANY, handler); }
+    void on(const String &uri, HTTPMethod method, THandlerFunction handler);
+    void onNotFound(THandlerFunction handler) { _notFound = handler; }
+
+    WiFiClient &client() { return _client; }
+    String uri() { return String(_uri); }
+    HTTPMethod method() { return _method; }
+    String arg(const String &name);
+    bool hasArg(const String &name);
+    int args() { return _argNames.size(); }
+    const String &arg(int i);
+    const String &argName(int i);
+
+    // Only request headers named here are kept
+    void collectHeaders(const char *headerKeys[], const size_t headerKeysCount);
+    String header(const String &name);
+    bool hasHeader(const String &name);
+
+    void setContentLength(size_t contentLength) { _contentLength = contentLength; }
+    void sendHeader(const String &name, const String &value, bool first = false);
+    void send(int code, const char *contentType, const char *content) { send(code, contentType, content, strlen(content)); }
+    void send(int code, const char *contentType, const char *content, size_t contentLength);
+    void send(int code, const char *contentType, const String &content) { send(code, contentType, content.c_str()); }
+    void send(int code, const String &contentType, const String &content) { send(code, contentType.c_str(), content.c_str()); }
+    void send(int code) { send(code, nullptr, ""); }
+    void send_P(int code, PGM_P contentType, PGM_P content, size_t contentLength) { send(code, contentType, content, contentLength); }
+    void sendContent(const char *content) { sendContent(content, strlen(content)); }
+    void sendContent(const char *content, size_t size);
+    void sendContent(const String &content) { sendContent(content.c_str(), content.length()); }
+    void sendContent_P(PGM_P content) { sendContent(content); }
+
+    bool Dispatch(HTTPMethod method, const char *uri, const std::map<std::string, std::string> &args,
+                  const std::map<std::string, std::string> &headers, SimHttpResponse *response);
+
+private:
+    struct Route
+    {
+        std::string uri;
+        HTTPMethod method;
+        THandlerFunction handler;
+    };
+    std::vector<Route> _routes;
+    THandlerFunction _notFound;
+    std::string _uri;
+    HTTPMethod _method = HTTP_GET;
+    std::map<std::string, std::string> _args;
+    std::vector<String> _argNames;
+    std::vector<String> _argValues;
+    std::map<std::string, std::string> _headers;
+    std::vector<std::string> _collect;
+    std::map<std::string, std::string> _requestHeaders;
+    size_t _contentLength = CONTENT_LENGTH_NOT_SET;
+    SimHttpResponse *_response = nullptr;
+    WiFiClient _client;
+};
+
+#endif // ESP8266WEBSERVER_H
@@ -0,0 +1,31 @@
+#include <ESP8266WiFi.h>
+#include "sim.h"
+
+ESP8266WiFiClass WiFi;
+
+// Association completes Sim::WifiConnectMicros() after begin()
+wl_status_t ESP8266WiFiClass::begin(const char *ssid, const char *passphrase)
+{
+    _connectAt = Sim::Micros() + Sim::WifiConnectMicros();
+    return WL_DISCONNECTED;
+}
+
+int8_t ESP8266WiFiClass::waitForConnectResult(unsigned long timeoutLength)
+{
+    uint64_t end = Sim::Micros() + (uint64_t)timeoutLength * 1000;
+    while (status() != WL_CONNECTED && Sim::Micros() < end)
+        delay(100);
+    return status();
+}
+
+wl_status_t ESP8266WiFiClass::status()
+{
+    if (_connectAt == 0 || Sim::Micros() < _connectAt)
+        return WL_DISCONNECTED;
+    return Sim::WifiConnected() ? WL_CONNECTED : WL_CONNECTION_LOST;
+}
+
+IPAddress ESP8266WiFiClass::localIP()
+{
+    return isConnected() ? IPAddress(192, 168, 0, 42) : IPAddress();
+}
@@ -0,0 +1,55 @@
+#ifndef ESP8266WIFI_H
+#define ESP8266WIFI_H
+
+#include <Arduino.h>
+#include "IPAddress.h"
+#include "WiFiClient.h"
+
+typedef enum
+{
+    WIFI_OFF = 0,
+    WIFI_STA = 1,
+    WIFI_AP = 2,
+    WIFI_AP_STA = 3
+} WiFiMode_t;
+
+typedef enum
+{
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_SCAN_COMPLETED = 2,
+    WL_CONNECTED = 3,
+    WL_CONNECT_FAILED = 4,
+    WL_CONNECTION_LOST = 5,
+    WL_WRONG_PASSWORD = 6,
+    WL_DISCONNECTED = 7
+} wl_status_t;
+
+typedef enum
+{
+    WIFI_NONE_SLEEP = 0,
+    WIFI_LIGHT_SLEEP = 1,
+    WIFI_MODEM_SLEEP = 2
+} WiFiSleepType_t;
+
+// Station connected to the simulated access point, see Sim::SetWifiConnected()
+class ESP8266WiFiClass
+{
+public:
+    bool mode(WiFiMode_t mode) { return true; }
+    bool hostname(const char *name) { return true; }
+    bool setSleepMode(WiFiSleepType_t type) { return true; }
+    wl_status_t begin(const char *ssid, const char *passphrase = nullptr);
+    int8_t waitForConnectResult(unsigned long timeoutLength = 60000);
+    wl_status_t status();
+    bool isConnected() { return status() == WL_CONNECTED; }
+    IPAddress localIP();
+    int32_t RSSI() { return -60; }
+
+private:
+    uint64_t _connectAt = 0;
+};
+
+extern ESP8266WiFiClass WiFi;
+
+#endif // ESP8266WIFI_H
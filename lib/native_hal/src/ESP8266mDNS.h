@@ -0,0 +1,13 @@
+#ifndef ESP8266MDNS_H
+#define ESP8266MDNS_H
+
+class MDNSResponder
+{
+public:
+    bool begin(const char *hostname) { return true; }
+    void update() {}
+};
+
+extern MDNSResponder MDNS;
+
+#endif // ESP8266MDNS_H
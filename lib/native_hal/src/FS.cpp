@@ -0,0 +1,196 @@
+#include <string.h>
+#include <LittleFS.h>
+#include "sim.h"
+
+// Matches a 1 MB LittleFS partition with 8 KB blocks
+#define TOTAL_BYTES (1024 * 1024)
+#define BLOCK_SIZE 8192
+#define PAGE_SIZE 256
+
+// Flash programming and metadata costs in microseconds
+#define WRITE_MICROS_PER_BYTE 3
+#define OPEN_MICROS 200
+
+fs::FS LittleFS;
+
+// LittleFS paths are always relative to the root
+static std::string normalise(const char *path)
+{
+    while (*path == '/')
+        path++;
+    return std::string(path);
+}
+
+namespace fs
+{
+
+File::File(const std::string &name, std::shared_ptr<FileData> data, bool readable, bool writable, bool append)
+    : _name(name), _data(data), _readable(readable), _writable(writable), _append(append)
+{
+    if (append)
+        _pos = _data->bytes.size();
+}
+
+size_t File::write(const uint8_t *buf, size_t size)
+{
+    SimHeapPause pause;
+    if (!_data || !_writable)
+        return 0;
+    if (_append)
+        _pos = _data->bytes.size();
+    if (_pos + size > _data->bytes.size())
+        _data->bytes.resize(_pos + size);
+    memcpy(&_data->bytes[_pos], buf, size);
+    _pos += size;
+    Sim::CountFlashWrite(size);
+    Sim::AdvanceMicros(size * WRITE_MICROS_PER_BYTE);
+    return size;
+}
+
+int File::available()
+{
+    if (!_data || !_readable)
+        return 0;
+    return _data->bytes.size() - _pos;
+}
+
+int File::read()
+{
+    uint8_t c;
+    return read(&c, 1) == 1 ? c : -1;
+}
+
+size_t File::read(uint8_t *buf, size_t size)
+{
+    size_t n = available();
+    if (n > size)
+        n = size;
+    memcpy(buf, &_data->bytes[_pos], n);
+    _pos += n;
+    return n;
+}
+
+int File::peek()
+{
+    return available() ? _data->bytes[_pos] : -1;
+}
+
+bool File::seek(uint32_t pos, SeekMode mode)
+{
+    if (!_data)
+        return false;
+    size_t base = mode == SeekSet ? 0 : (mode == SeekCur ? _pos : _data->bytes.size());
+    if (base + pos > _data->bytes.size())
+        return false;
+    _pos = base + pos;
+    return true;
+}
+
+bool File::truncate(uint32_t size)
+{
+    SimHeapPause pause;
+    if (!_data || !_writable)
+        return false;
+    _data->bytes.resize(size);
+    if (_pos > size)
+        _pos = size;
+    return true;
+}
+
+size_t Dir::fileSize()
+{
+    File f = openFile("r");
+    return f.size();
+}
+
+File Dir::openFile(const char *mode)
+{
+    SimHeapPause pause;
+    return _fs->open((_path + "/" + _names[_index]).c_str(), mode);
+}
+
+bool FS::format()
+{
+    _files.clear();
+    return true;
+}
+
+bool FS::info(FSInfo &info)
+{
+    size_t used = 0;
+    for (auto &f : _files)
+        used += (f.second->bytes.size() + BLOCK_SIZE - 1) / BLOCK_SIZE * BLOCK_SIZE;
+    info.totalBytes = TOTAL_BYTES;
+    info.usedBytes = used;
+    info.blockSize = BLOCK_SIZE;
+    info.pageSize = PAGE_SIZE;
+    info.maxOpenFiles = 5;
+    info.maxPathLength = 32;
+    return _mounted;
+}
+
+// Modes as fopen(): r, r+, w, w+, a, a+
+File FS::open(const char *path, const char *mode)
+{
+    SimHeapPause pause;
+    if (!_mounted)
+        return File();
+    Sim::AdvanceMicros(OPEN_MICROS);
+    std::string name = normalise(path);
+    bool plus = strchr(mode, '+') != nullptr;
+    auto it = _files.find(name);
+    if (mode[0] == 'r')
+    {
+        if (it == _files.end())
+            return File();
+        return File(name, it->second, true, plus, false);
+    }
+
+    if (it == _files.end())
+        it = _files.emplace(name, std::make_shared<FileData>()).first;
+    if (mode[0] == 'w')
+        it->second->bytes.clear();
+    return File(name, it->second, plus, true, mode[0] == 'a');
+}
+
+bool FS::exists(const char *path)
+{
+    SimHeapPause pause;
+    return _mounted && _files.count(normalise(path)) != 0;
+}
+
+bool FS::remove(const char *path)
+{
+    SimHeapPause pause;
+    return _mounted && _files.erase(normalise(path)) != 0;
+}
+
+bool FS::rename(const char *from, const char *to)
+{
+    SimHeapPause pause;
+    auto it = _files.find(normalise(from));
+    if (!_mounted || it == _files.end())
+        return false;
+    _files[normalise(to)] = it->second;
+    _files.erase(it);
+    return true;
+}
+
+Dir FS::openDir(const char *path)
+{
+    SimHeapPause pause;
+    std::string dir = normalise(path);
+    std::vector<std::string> names;
+    std::string prefix = dir.empty() ? "" : dir + "/";
+    for (auto &f : _files)
+    {
+        if (f.first.compare(0, prefix.size(), prefix) != 0)
+            continue;
+        std::string name = f.first.substr(prefix.size());
+        if (name.find('/') == std::string::npos)
+            names.push_back(name);
+    }
+    return Dir(this, names, dir);
+}
+
+} // namespace fs
@@ -0,0 +1,125 @@
+#ifndef FS_H
+#define FS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Print.h"
+
+namespace fs
+{
+
+enum SeekMode
+{
+    SeekSet = 0,
+    SeekCur = 1,
+    SeekEnd = 2
+};
+
+struct FSInfo
+{
+    size_t totalBytes;
+    size_t usedBytes;
+    size_t blockSize;
+    size_t pageSize;
+    size_t maxOpenFiles;
+    size_t maxPathLength;
+};
+
+// File contents shared between open handles
+struct FileData
+{
+    std::vector<uint8_t> bytes;
+};
+
+class File : public Print
+{
+public:
+    File() {}
+    File(const std::string &name, std::shared_ptr<FileData> data, bool readable, bool writable, bool append);
+
+    operator bool() const { return _data != nullptr; }
+    size_t write(uint8_t c) { return write(&c, 1); }
+    size_t write(const uint8_t *buf, size_t size);
+    using Print::write;
+    int available();
+    int read();
+    size_t read(uint8_t *buf, size_t size);
+    size_t readBytes(char *buffer, size_t length) { return read((uint8_t *)buffer, length); }
+    int peek();
+    void flush() {}
+    bool seek(uint32_t pos, SeekMode mode = SeekSet);
+    size_t position() const { return _pos; }
+    size_t size() const { return _data ? _data->bytes.size() : 0; }
+    bool truncate(uint32_t size);
+    void close() { _data = nullptr; }
+    const char *name() const { return _name.c_str(); }
+
+private:
+    std::string _name;
+    std::shared_ptr<FileData> _data;
+    size_t _pos = 0;
+    bool _readable = false;
+    bool _writable = false;
+    bool _append = false;
+};
+
+class FS;
+
+// Iterates the files directly inside a directory
+class Dir
+{
+public:
+    Dir() {}
+    Dir(FS *fs, const std::vector<std::string> &names, const std::string &path) : _fs(fs), _names(names), _path(path) {}
+    bool next() { return ++_index < (int)_names.size(); }
+    String fileName() const { return String(_names[_index]); }
+    size_t fileSize();
+    File openFile(const char *mode);
+
+private:
+    FS *_fs = nullptr;
+    std::vector<std::string> _names;
+    std::string _path;
+    int _index = -1;
+};
+
+// Flash file system kept in memory for the length of the run
+class FS
+{
+public:
+    bool begin() { return _mounted = true; }
+    void end() { _mounted = false; }
+    bool format();
+    bool info(FSInfo &info);
+    File open(const char *path, const char *mode);
+    File open(const String &path, const char *mode) { return open(path.c_str(), mode); }
+    bool exists(const char *path);
+    bool exists(const String &path) { return exists(path.c_str()); }
+    bool remove(const char *path);
+    bool remove(const String &path) { return remove(path.c_str()); }
+    bool rename(const char *from, const char *to);
+    bool mkdir(const char *path) { return true; }
+    bool rmdir(const char *path) { return true; }
+    Dir openDir(const char *path);
+
+private:
+    bool _mounted = false;
+    std::map<std::string, std::shared_ptr<FileData>> _files;
+};
+
+} // namespace fs
+
+using fs::Dir;
+using fs::File;
+using fs::FS;
+using fs::FSInfo;
+using fs::SeekCur;
+using fs::SeekEnd;
+using fs::SeekMode;
+using fs::SeekSet;
+
+#endif // FS_H
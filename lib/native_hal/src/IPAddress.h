@@ -0,0 +1,30 @@
+#ifndef IPADDRESS_H
+#define IPADDRESS_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include "Print.h"
+
+class IPAddress : public Printable
+{
+public:
+    IPAddress() {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : _bytes{a, b, c, d} {}
+
+    uint8_t operator[](int i) const { return _bytes[i]; }
+    bool operator==(const IPAddress &rhs) const { return (uint32_t)*this == (uint32_t)rhs; }
+    operator uint32_t() const { return _bytes[0] | _bytes[1] << 8 | _bytes[2] << 16 | (uint32_t)_bytes[3] << 24; }
+
+    String toString() const
+    {
+        char buf[16];
+        snprintf(buf, sizeof(buf), "%u.%u.%u.%u", _bytes[0], _bytes[1], _bytes[2], _bytes[3]);
+        return String(buf);
+    }
+    size_t printTo(Print &p) const { return p.print(toString()); }
+
+private:
+    uint8_t _bytes[4] = {0, 0, 0, 0};
+};
+
+#endif // IPADDRESS_H
@@ -0,0 +1,138 @@
+#include <string.h>
+#include <OneWire.h>
+#include "sim.h"
+
+// Bus timings in microseconds
+#define RESET_MICROS 960
+#define BYTE_MICROS 560
+
+// Returns 1 if a presence pulse was seen
+uint8_t OneWire::reset()
+{
+    Sim::AdvanceMicros(RESET_MICROS);
+    _state = IDLE;
+    _all = false;
+    return Sim::Ds18b20s().empty() ? 0 : 1;
+}
+
+void OneWire::select(const uint8_t rom[8])
+{
+    Sim::AdvanceMicros(BYTE_MICROS * 9);
+    memcpy(_selectedRom, rom, 8);
+    _all = false;
+    _state = ROM_SELECTED;
+}
+
+void OneWire::skip()
+{
+    Sim::AdvanceMicros(BYTE_MICROS);
+    _all = true;
+    _state = ROM_SELECTED;
+}
+
+void OneWire::write(uint8_t v, uint8_t power)
+{
+    Sim::AdvanceMicros(BYTE_MICROS);
+    if (_state != ROM_SELECTED)
+        return;
+
+    for (SimDs18b20 *probe : Sim::Ds18b20s())
+    {
+        if (!_all && memcmp(probe->rom, _selectedRom, 8) != 0)
+            continue;
+        switch (v)
+        {
+        case 0x44: // Convert T
+            probe->convertingUntil = Sim::Micros() + probe->ConversionMicros();
+            _state = CONVERTING;
+            break;
+        case 0xBE: // Read Scratchpad
+            if (probe->convertingUntil != 0 && Sim::Micros() >= probe->convertingUntil)
+            {
+                probe->CompleteConversion();
+                probe->convertingUntil = 0;
+            }
+            _state = READING_SCRATCHPAD;
+            _readIndex = 0;
+            break;
+        }
+    }
+}
+
+void OneWire::write_bytes(const uint8_t *buf, uint16_t count, bool power)
+{
+    for (uint16_t i = 0; i < count; i++)
+        write(buf[i], power);
+}
+
+// Scratchpad bytes when reading, otherwise 0 while a conversion is in
+// progress and 0xFF once it completes. Nothing selected reads 0xFF
+uint8_t OneWire::read()
+{
+    Sim::AdvanceMicros(BYTE_MICROS);
+    for (SimDs18b20 *probe : Sim::Ds18b20s())
+    {
+        if (!_all && memcmp(probe->rom, _selectedRom, 8) != 0)
+            continue;
+        if (_state == READING_SCRATCHPAD && !_all)
+        {
+            if (_readIndex >= 9)
+                return 0xFF;
+            uint8_t b = probe->scratchpad[_readIndex++];
+            if (probe->corruptReads > 0)
+            {
+                b ^= 0x01;
+                if (_readIndex == 9)
+                    probe->corruptReads--;
+            }
+            return b;
+        }
+        if (_state == CONVERTING && probe->convertingUntil > Sim::Micros())
+            return 0;
+    }
+    return 0xFF;
+}
+
+void OneWire::read_bytes(uint8_t *buf, uint16_t count)
+{
+    for (uint16_t i = 0; i < count; i++)
+        buf[i] = read();
+}
+
+void OneWire::reset_search()
+{
+    _searchIndex = 0;
+}
+
+// Returns the probes in the order they were added
+bool OneWire::search(uint8_t *newAddr, bool search_mode)
+{
+    std::vector<SimDs18b20 *> &probes = Sim::Ds18b20s();
+    Sim::AdvanceMicros(RESET_MICROS + BYTE_MICROS * 24);
+    if (_searchIndex >= (int)probes.size())
+    {
+        _searchIndex = 0;
+        return false;
+    }
+    memcpy(newAddr, probes[_searchIndex++]->rom, 8);
+    return true;
+}
+
+// Dallas/Maxim CRC8
+uint8_t OneWire::crc8(const uint8_t *addr, uint8_t len)
+{
+    uint8_t crc = 0;
+    while (len--)
+    {
+        uint8_t inbyte = *addr++;
+        for (uint8_t i = 8; i; i--)
+        {
+            uint8_t mix = (crc ^ inbyte) & 0x01;
+            crc >>= 1;
+            if (mix)
+                crc ^= 0x8C;
+            inbyte >>= 1;
+        }
+    }
+    return crc;
+}
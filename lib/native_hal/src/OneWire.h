@@ -0,0 +1,41 @@
+#ifndef ONEWIRE_H
+#define ONEWIRE_H
+
+#include <stdint.h>
+
+// OneWire master talking to the probes added with Sim::AddDs18b20()
+class OneWire
+{
+public:
+    OneWire() {}
+    OneWire(uint8_t pin) {}
+    void begin(uint8_t pin) {}
+
+    uint8_t reset();
+    void select(const uint8_t rom[8]);
+    void skip();
+    void write(uint8_t v, uint8_t power = 0);
+    void write_bytes(const uint8_t *buf, uint16_t count, bool power = 0);
+    uint8_t read();
+    void read_bytes(uint8_t *buf, uint16_t count);
+    void depower() {}
+    void reset_search();
+    bool search(uint8_t *newAddr, bool search_mode = true);
+
+    static uint8_t crc8(const uint8_t *addr, uint8_t len);
+
+private:
+    enum
+    {
+        IDLE,
+        ROM_SELECTED,
+        READING_SCRATCHPAD,
+        CONVERTING
+    } _state = IDLE;
+    bool _all = false;
+    uint8_t _selectedRom[8];
+    int _readIndex = 0;
+    int _searchIndex = 0;
+};
+
+#endif // ONEWIRE_H
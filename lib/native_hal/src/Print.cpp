@@ -0,0 +1,75 @@
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include "Print.h"
+
+size_t Print::write(const uint8_t *buffer, size_t size)
+{
+    size_t n = 0;
+    while (size--)
+        n += write(*buffer++);
+    return n;
+}
+
+size_t Print::write(const char *str)
+{
+    if (str == nullptr)
+        return 0;
+    return write((const uint8_t *)str, strlen(str));
+}
+
+static size_t vprintf(Print *p, const char *format, va_list args)
+{
+    char buf[256];
+    int n = vsnprintf(buf, sizeof(buf), format, args);
+    if (n < 0)
+        return 0;
+    if ((size_t)n >= sizeof(buf))
+        n = sizeof(buf) - 1;
+    return p->write((const uint8_t *)buf, n);
+}
+
+size_t Print::printf(const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    size_t n = vprintf(this, format, args);
+    va_end(args);
+    return n;
+}
+
+size_t Print::printf_P(const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    size_t n = vprintf(this, format, args);
+    va_end(args);
+    return n;
+}
+
+size_t Print::print(long value, int base)
+{
+    char buf[24];
+    if (base == 16)
+        snprintf(buf, sizeof(buf), "%lx", value);
+    else
+        snprintf(buf, sizeof(buf), "%ld", value);
+    return write(buf);
+}
+
+size_t Print::print(unsigned long value, int base)
+{
+    char buf[24];
+    if (base == 16)
+        snprintf(buf, sizeof(buf), "%lx", value);
+    else
+        snprintf(buf, sizeof(buf), "%lu", value);
+    return write(buf);
+}
+
+size_t Print::print(double value, int digits)
+{
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.*f", digits, value);
+    return write(buf);
+}
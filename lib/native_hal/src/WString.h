@@ -0,0 +1,65 @@
+#ifndef WSTRING_H
+#define WSTRING_H
+
+#include <string>
+
+class __FlashStringHelper;
+
+// Subset of the Arduino String class backed by std::string
+class String
+{
+public:
+    String() {}
+    String(const char *str) : _s(str ? str : "") {}
+    String(const std::string &str) : _s(str) {}
+    String(const __FlashStringHelper *str) : _s(reinterpret_cast<const char *>(str)) {}
+    String(char c) : _s(1, c) {}
+    explicit String(int value) : _s(std::to_string(value)) {}
+    explicit String(unsigned int value) : _s(std::to_string(value)) {}
+    explicit String(long value) : _s(std::to_string(value)) {}
+    explicit String(unsigned long value) : _s(std::to_string(value)) {}
+
+    const char *c_str() const { return _s.c_str(); }
+    unsigned int length() const { return _s.length(); }
+    bool isEmpty() const { return _s.empty(); }
+    long toInt() const { return strtol(_s.c_str(), nullptr, 10); }
+    bool equals(const char *str) const { return _s == str; }
+    bool startsWith(const char *str) const { return _s.rfind(str, 0) == 0; }
+    int indexOf(char c, unsigned int from = 0) const
+    {
+        size_t i = _s.find(c, from);
+        return i == std::string::npos ? -1 : (int)i;
+    }
+    String substring(unsigned int from, unsigned int to) const { return String(_s.substr(from, to - from)); }
+    String substring(unsigned int from) const { return String(_s.substr(from)); }
+    char operator[](unsigned int i) const { return _s[i]; }
+
+    String &operator+=(const String &rhs)
+    {
+        _s += rhs._s;
+        return *this;
+    }
+    String &operator+=(const char *rhs)
+    {
+        _s += rhs;
+        return *this;
+    }
+    String &operator+=(char rhs)
+    {
+        _s += rhs;
+        return *this;
+    }
+    bool operator==(const String &rhs) const { return _s == rhs._s; }
+    bool operator==(const char *rhs) const { return _s == rhs; }
+    bool operator!=(const String &rhs) const { return _s != rhs._s; }
+    bool operator!=(const char *rhs) const { return _s != rhs; }
+
+    friend String operator+(const String &lhs, const String &rhs) { return String(lhs._s + rhs._s); }
+    friend String operator+(const String &lhs, const char *rhs) { return String(lhs._s + rhs); }
+    friend String operator+(const char *lhs, const String &rhs) { return String(lhs + rhs._s); }
+
+private:
+    std::string _s;
+};
+
+#endif // WSTRING_H
@@ -0,0 +1,37 @@
+#include <ESP8266WiFi.h>
+#include <WiFiClient.h>
+#include "sim.h"
+
+// Roughly 1 us per byte at 11 Mbit/s plus fixed overhead
+#define SEGMENT_MICROS 200
+
+uint8_t WiFiClient::connected()
+{
+    return _connection && _connection->open && WiFi.isConnected();
+}
+
+size_t WiFiClient::availableForWrite()
+{
+    return connected() ? _connection->window : 0;
+}
+
+// The peer reads everything at once unless its window is closed
+size_t WiFiClient::write(const uint8_t *buffer, size_t size)
+{
+    if (!connected())
+        return 0;
+    size_t n = size < _connection->window ? size : _connection->window;
+    {
+        SimHeapPause pause;
+        _connection->received.append((const char *)buffer, n);
+    }
+    Sim::AdvanceMicros(SEGMENT_MICROS + n);
+    return n;
+}
+
+void WiFiClient::stop()
+{
+    if (_connection)
+        _connection->open = false;
+    _connection = nullptr;
+}
@@ -0,0 +1,32 @@
+#ifndef WIFICLIENT_H
+#define WIFICLIENT_H
+
+#include <memory>
+#include "Print.h"
+
+struct SimTcpConnection;
+
+// TCP connection to a simulated peer. Copies share the connection, as
+// they share the ClientContext on the board
+class WiFiClient : public Print
+{
+public:
+    WiFiClient() {}
+    WiFiClient(const std::shared_ptr<SimTcpConnection> &connection) : _connection(connection) {}
+
+    uint8_t connected();
+    explicit operator bool() { return connected(); }
+    void setNoDelay(bool nodelay) {}
+    size_t availableForWrite();
+    size_t write(uint8_t c) { return write(&c, 1); }
+    size_t write(const uint8_t *buffer, size_t size);
+    size_t write_P(PGM_P buffer, size_t size) { return write((const uint8_t *)buffer, size); }
+    using Print::write;
+    void flush() {}
+    void stop();
+
+private:
+    std::shared_ptr<SimTcpConnection> _connection;
+};
+
+#endif // WIFICLIENT_H
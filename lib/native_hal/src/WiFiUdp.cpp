@@ -0,0 +1,32 @@
+#include <ESP8266WiFi.h>
+#include <WiFiUdp.h>
+#include "sim.h"
+
+// Roughly 1 us per byte at 11 Mbit/s plus fixed overhead
+#define PACKET_MICROS 400
+
+int WiFiUDP::beginPacket(IPAddress ip, uint16_t port)
+{
+    SimHeapPause pause;
+    _ip = ip;
+    _port = port;
+    _payload.clear();
+    return 1;
+}
+
+size_t WiFiUDP::write(const uint8_t *buffer, size_t size)
+{
+    SimHeapPause pause;
+    _payload.append((const char *)buffer, size);
+    return size;
+}
+
+int WiFiUDP::endPacket()
+{
+    Sim::AdvanceMicros(PACKET_MICROS + _payload.size());
+    if (!WiFi.isConnected())
+        return 0;
+    SimHeapPause pause;
+    Sim::UdpPackets().push_back({_ip, _port, _payload, Sim::Micros()});
+    return 1;
+}
@@ -0,0 +1,26 @@
+#ifndef WIFIUDP_H
+#define WIFIUDP_H
+
+#include <string>
+#include "Print.h"
+#include "IPAddress.h"
+
+// Packets are recorded in Sim::UdpPackets(). endPacket() fails while the
+// simulated WiFi is down
+class WiFiUDP : public Print
+{
+public:
+    uint8_t begin(uint16_t port) { return 1; }
+    int beginPacket(IPAddress ip, uint16_t port);
+    size_t write(uint8_t c) { return write(&c, 1); }
+    size_t write(const uint8_t *buffer, size_t size);
+    using Print::write;
+    int endPacket();
+
+private:
+    IPAddress _ip;
+    uint16_t _port = 0;
+    std::string _payload;
+};
+
+#endif // WIFIUDP_H
@@ -0,0 +1,64 @@
+#include <Wire.h>
+#include "sim.h"
+
+void TwoWire::beginTransmission(uint8_t address)
+{
+    _txAddress = address;
+    _txLength = 0;
+}
+
+size_t TwoWire::write(uint8_t data)
+{
+    if (_txLength >= I2C_BUFFER_LENGTH)
+        return 0;
+    _txBuffer[_txLength++] = data;
+    return 1;
+}
+
+size_t TwoWire::write(const uint8_t *data, size_t quantity)
+{
+    for (size_t i = 0; i < quantity; i++)
+        if (!write(data[i]))
+            return i;
+    return quantity;
+}
+
+// 0 success, 2 address NACK, 3 data NACK
+uint8_t TwoWire::endTransmission(uint8_t sendStop)
+{
+    Sim::AdvanceMicros(Sim::I2cByteMicros() * (_txLength + 1));
+    SimI2cDevice *device = Sim::FindI2c(_txAddress);
+    if (device == nullptr)
+        _lastStatus = 2;
+    else
+        _lastStatus = device->Write(_txBuffer, _txLength) ? 0 : (_txLength == 0 ? 2 : 3);
+    _txLength = 0;
+    return _lastStatus;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t address, size_t size, bool sendStop)
+{
+    if (size > I2C_BUFFER_LENGTH)
+        size = I2C_BUFFER_LENGTH;
+    _rxIndex = 0;
+    _rxLength = 0;
+    SimI2cDevice *device = Sim::FindI2c(address);
+    if (device != nullptr)
+        _rxLength = device->Read(_rxBuffer, size);
+    Sim::AdvanceMicros(Sim::I2cByteMicros() * (_rxLength + 1));
+    return _rxLength;
+}
+
+int TwoWire::read()
+{
+    if (_rxIndex >= _rxLength)
+        return -1;
+    return _rxBuffer[_rxIndex++];
+}
+
+int TwoWire::peek()
+{
+    if (_rxIndex >= _rxLength)
+        return -1;
+    return _rxBuffer[_rxIndex];
+}
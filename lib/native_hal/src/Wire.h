@@ -0,0 +1,47 @@
+#ifndef TWOWIRE_H
+#define TWOWIRE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define I2C_BUFFER_LENGTH 128
+
+// I2C master talking to the devices attached with Sim::AttachI2c()
+class TwoWire
+{
+public:
+    void begin(int sda, int scl) {}
+    void begin() {}
+    void setClock(uint32_t frequency) {}
+    void setClockStretchLimit(uint32_t limit) {}
+
+    void beginTransmission(uint8_t address);
+    void beginTransmission(int address) { beginTransmission((uint8_t)address); }
+    uint8_t endTransmission(uint8_t sendStop);
+    uint8_t endTransmission() { return endTransmission(true); }
+    uint8_t requestFrom(uint8_t address, size_t size, bool sendStop);
+    uint8_t requestFrom(uint8_t address, uint8_t quantity) { return requestFrom(address, quantity, true); }
+    uint8_t requestFrom(int address, int quantity) { return requestFrom((uint8_t)address, (size_t)quantity, true); }
+    uint8_t status() { return _lastStatus; }
+
+    size_t write(uint8_t data);
+    size_t write(const uint8_t *data, size_t quantity);
+    size_t write(unsigned long n) { return write((uint8_t)n); }
+    size_t write(long n) { return write((uint8_t)n); }
+    size_t write(unsigned int n) { return write((uint8_t)n); }
+    size_t write(int n) { return write((uint8_t)n); }
+    int available() { return _rxLength - _rxIndex; }
+    int read();
+    int peek();
+
+private:
+    uint8_t _txAddress = 0;
+    uint8_t _txBuffer[I2C_BUFFER_LENGTH];
+    size_t _txLength = 0;
+    uint8_t _rxBuffer[I2C_BUFFER_LENGTH];
+    size_t _rxLength = 0;
+    size_t _rxIndex = 0;
+    uint8_t _lastStatus = 0;
+};
+
+#endif // TWOWIRE_H
@@ -0,0 +1,68 @@
+#include <Arduino.h>
+#include <bsec.h>
+#include "sim.h"
+
+// Low power mode samples every 3 s
+#define SAMPLE_PERIOD_MS 3000
+
+void Bsec::begin(uint8_t i2cAddr, TwoWire &i2c)
+{
+    _i2c = &i2c;
+    _address = i2cAddr;
+    _startMs = millis();
+    nextCall = millis();
+    bme680Status = Device() ? BME680_OK : BME680_E_COM_FAIL;
+}
+
+bool Bsec::run()
+{
+    if ((int64_t)millis() < nextCall)
+        return false;
+    nextCall = millis() + SAMPLE_PERIOD_MS;
+
+    // Read the sensor over the bus
+    _i2c->beginTransmission(_address);
+    _i2c->write(0x1D);
+    if (_i2c->endTransmission() != 0 || _i2c->requestFrom(_address, (uint8_t)15) != 15)
+    {
+        bme680Status = BME680_E_COM_FAIL;
+        return false;
+    }
+    SimBme680 *device = Device();
+    if (device == nullptr)
+    {
+        bme680Status = BME680_E_COM_FAIL;
+        return false;
+    }
+    bme680Status = BME680_OK;
+
+    Sim::AdvanceMicros(device->runMicros);
+    temperature = device->temperature - _offset;
+    pressure = device->pressure;
+    humidity = device->humidity;
+    staticIaq = device->iaq;
+    co2Equivalent = device->co2Equivalent;
+    uint32_t steps = (millis() - _startMs) / device->accuracyStepMs;
+    uint32_t accuracy = _restoredAccuracy + steps;
+    staticIaqAccuracy = accuracy > 3 ? 3 : accuracy;
+    return true;
+}
+
+void Bsec::getState(uint8_t *state)
+{
+    for (int i = 0; i < BSEC_MAX_STATE_BLOB_SIZE; i++)
+        state[i] = (uint8_t)(i * 7);
+    state[0] = staticIaqAccuracy;
+    status = BSEC_OK;
+}
+
+void Bsec::setState(uint8_t *state)
+{
+    _restoredAccuracy = state[0] > 3 ? 3 : state[0];
+    status = BSEC_OK;
+}
+
+SimBme680 *Bsec::Device()
+{
+    return dynamic_cast<SimBme680 *>(Sim::FindI2c(_address));
+}
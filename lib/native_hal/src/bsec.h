@@ -0,0 +1,78 @@
+#ifndef BSEC_CLASS_H
+#define BSEC_CLASS_H
+
+#include <stdint.h>
+#include <Wire.h>
+
+#define BSEC_MAX_STATE_BLOB_SIZE 139
+#define BSEC_SAMPLE_RATE_LP 0.33333f
+#define BME680_OK 0
+#define BME680_E_COM_FAIL -2
+
+typedef enum
+{
+    BSEC_OK = 0,
+    BSEC_E_CONFIG_FAIL = -33
+} bsec_library_return_t;
+
+typedef enum
+{
+    BSEC_OUTPUT_IAQ = 1,
+    BSEC_OUTPUT_STATIC_IAQ = 2,
+    BSEC_OUTPUT_CO2_EQUIVALENT = 3,
+    BSEC_OUTPUT_BREATH_VOC_EQUIVALENT = 4,
+    BSEC_OUTPUT_RAW_TEMPERATURE = 6,
+    BSEC_OUTPUT_RAW_PRESSURE = 7,
+    BSEC_OUTPUT_RAW_HUMIDITY = 8,
+    BSEC_OUTPUT_RAW_GAS = 9,
+    BSEC_OUTPUT_STABILIZATION_STATUS = 12,
+    BSEC_OUTPUT_RUN_IN_STATUS = 13,
+    BSEC_OUTPUT_SENSOR_HEAT_COMPENSATED_TEMPERATURE = 14,
+    BSEC_OUTPUT_SENSOR_HEAT_COMPENSATED_HUMIDITY = 15
+} bsec_virtual_sensor_t;
+
+typedef struct
+{
+    uint8_t major;
+    uint8_t minor;
+    uint8_t major_bugfix;
+    uint8_t minor_bugfix;
+} bsec_version_t;
+
+class SimBme680;
+
+// BSEC stand-in reporting the outputs of the SimBme680 attached at its
+// address. The state blob records the accuracy reached
+class Bsec
+{
+public:
+    bsec_version_t version = {1, 4, 8, 0};
+    bsec_library_return_t status = BSEC_OK;
+    int8_t bme680Status = BME680_OK;
+    int64_t nextCall = 0;
+    float temperature = 0;
+    float pressure = 0;
+    float humidity = 0;
+    float staticIaq = 0;
+    uint8_t staticIaqAccuracy = 0;
+    float co2Equivalent = 0;
+
+    void begin(uint8_t i2cAddr, TwoWire &i2c);
+    void setConfig(const uint8_t *config) {}
+    void setTemperatureOffset(float tempOffset) { _offset = tempOffset; }
+    void updateSubscription(bsec_virtual_sensor_t sensorList[], uint8_t nSensors, float sampleRate) {}
+    bool run();
+    void getState(uint8_t *state);
+    void setState(uint8_t *state);
+
+private:
+    TwoWire *_i2c = nullptr;
+    uint8_t _address = 0;
+    float _offset = 0;
+    uint32_t _startMs = 0;
+    uint8_t _restoredAccuracy = 0;
+
+    SimBme680 *Device();
+};
+
+#endif // BSEC_CLASS_H
@@ -0,0 +1,10 @@
+#ifndef CORE_DECLS_H
+#define CORE_DECLS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// CRC-32 as implemented by the ESP8266 core (MSB first, poly 0x04c11db7)
+uint32_t crc32(const void *data, size_t length, uint32_t crc = 0xffffffff);
+
+#endif // CORE_DECLS_H
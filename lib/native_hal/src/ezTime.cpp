@@ -0,0 +1,62 @@
+#include <ESP8266WiFi.h>
+#include <ezTime.h>
+#include "sim.h"
+
+// Cost of a network round trip to the NTP or timezone server
+#define NETWORK_MICROS 50000
+
+static bool synced = false;
+static uint64_t lastReadMicros = 0;
+
+time_t now()
+{
+    lastReadMicros = Sim::Micros();
+    time_t t = (time_t)(lastReadMicros / 1000000);
+    return synced ? Sim::Epoch() + t : t;
+}
+
+uint16_t ms(time_t t)
+{
+    uint64_t us = t == LAST_READ ? lastReadMicros : Sim::Micros();
+    return (uint16_t)((us / 1000) % 1000);
+}
+
+bool waitForSync(uint16_t timeout)
+{
+    uint64_t end = Sim::Micros() + (uint64_t)timeout * 1000000;
+    while (!synced && (timeout == 0 || Sim::Micros() < end))
+    {
+        events();
+        if (!synced)
+            delay(1000);
+    }
+    return synced;
+}
+
+timeStatus_t timeStatus()
+{
+    return synced ? timeSet : timeNotSet;
+}
+
+void events()
+{
+    if (synced || !WiFi.isConnected() || !Sim::TimeSyncAvailable())
+        return;
+    Sim::AdvanceMicros(NETWORK_MICROS);
+    synced = true;
+}
+
+bool Timezone::setLocation(const String &location)
+{
+    Sim::AdvanceMicros(NETWORK_MICROS);
+    return WiFi.isConnected() && Sim::TimeSyncAvailable();
+}
+
+String Timezone::dateTime(time_t t, const ezLocalOrUTC_t local_or_utc, String format)
+{
+    char buf[48];
+    struct tm tm;
+    gmtime_r(&t, &tm);
+    strftime(buf, sizeof(buf), "%A, %d-%b-%Y %H:%M:%S UTC", &tm);
+    return String(buf);
+}
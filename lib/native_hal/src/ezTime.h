@@ -0,0 +1,43 @@
+#ifndef EZTIME_H
+#define EZTIME_H
+
+#include <time.h>
+#include <Arduino.h>
+
+#define TIME_NOW 0xFFFFFFFF
+#define LAST_READ 0xFFFFFFFE
+#define DEFAULT_TIMEFORMAT "l, d-M-Y H:i:s T"
+
+typedef enum
+{
+    timeNotSet,
+    timeNeedsSync,
+    timeSet
+} timeStatus_t;
+
+typedef enum
+{
+    LOCAL_TIME,
+    UTC_TIME
+} ezLocalOrUTC_t;
+
+// Time synchronises once WiFi is up and Sim::TimeSyncAvailable(), the
+// clock then reads Sim::Epoch() plus the time since boot
+time_t now();
+uint16_t ms(time_t t = TIME_NOW);
+bool waitForSync(uint16_t timeout = 0);
+timeStatus_t timeStatus();
+void events();
+
+// Always UTC
+class Timezone
+{
+public:
+    bool setLocation(const String &location = "GeoIP");
+    String dateTime(String format = DEFAULT_TIMEFORMAT) { return dateTime(::now(), UTC_TIME, format); }
+    String dateTime(time_t t, String format = DEFAULT_TIMEFORMAT) { return dateTime(t, UTC_TIME, format); }
+    String dateTime(time_t t, const ezLocalOrUTC_t local_or_utc, String format = DEFAULT_TIMEFORMAT);
+    time_t now() { return ::now(); }
+};
+
+#endif // EZTIME_H
@@ -0,0 +1,146 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <malloc.h>
+#include "sim.h"
+
+// Replaces the C library allocator entry points so every allocation the
+// firmware makes (including through operator new) can be counted
+
+extern "C" void *__libc_malloc(size_t size);
+extern "C" void *__libc_calloc(size_t count, size_t size);
+extern "C" void *__libc_realloc(void *ptr, size_t size);
+extern "C" void __libc_free(void *ptr);
+
+// Open addressed table of the firmware's live allocations. Fixed size so
+// that tracking never allocates itself
+#define TABLE_SIZE (1 << 16)
+
+struct Allocation
+{
+    void *ptr;
+    size_t size;
+};
+
+static Allocation table[TABLE_SIZE];
+static SimHeapStats stats;
+
+// Paused until the firmware starts so start up allocations made by the
+// C++ runtime aren't charged to it
+static int pauseDepth = 1;
+
+static size_t slotFor(void *ptr)
+{
+    return ((uintptr_t)ptr >> 4) * 2654435761u % TABLE_SIZE;
+}
+
+static void track(void *ptr, size_t size)
+{
+    if (ptr == nullptr || pauseDepth > 0)
+        return;
+    stats.allocations++;
+    stats.bytesAllocated += size;
+    stats.inUse += size;
+    if (stats.inUse > stats.peakInUse)
+        stats.peakInUse = stats.inUse;
+
+    size_t i = slotFor(ptr);
+    for (size_t n = 0; n < TABLE_SIZE; n++, i = (i + 1) % TABLE_SIZE)
+    {
+        if (table[i].ptr == nullptr)
+        {
+            table[i] = {ptr, size};
+            return;
+        }
+    }
+}
+
+// Linear probing with backward shift deletion, so lookups can stop at
+// the first empty slot
+static void removeSlot(size_t i)
+{
+    size_t j = i;
+    for (;;)
+    {
+        j = (j + 1) % TABLE_SIZE;
+        if (table[j].ptr == nullptr)
+            break;
+        size_t k = slotFor(table[j].ptr);
+        bool movable = (i <= j) ? (k <= i || k > j) : (k <= i && k > j);
+        if (movable)
+        {
+            table[i] = table[j];
+            i = j;
+        }
+    }
+    table[i].ptr = nullptr;
+}
+
+static void untrack(void *ptr)
+{
+    if (ptr == nullptr)
+        return;
+    size_t i = slotFor(ptr);
+    for (size_t n = 0; n < TABLE_SIZE && table[i].ptr != nullptr; n++, i = (i + 1) % TABLE_SIZE)
+    {
+        if (table[i].ptr == ptr)
+        {
+            stats.frees++;
+            stats.inUse -= table[i].size;
+            removeSlot(i);
+            return;
+        }
+    }
+}
+
+extern "C" void *malloc(size_t size)
+{
+    void *ptr = __libc_malloc(size);
+    track(ptr, size);
+    return ptr;
+}
+
+extern "C" void *calloc(size_t count, size_t size)
+{
+    void *ptr = __libc_calloc(count, size);
+    track(ptr, count * size);
+    return ptr;
+}
+
+extern "C" void *realloc(void *ptr, size_t size)
+{
+    untrack(ptr);
+    void *newPtr = __libc_realloc(ptr, size);
+    track(newPtr, size);
+    return newPtr;
+}
+
+extern "C" void free(void *ptr)
+{
+    untrack(ptr);
+    __libc_free(ptr);
+}
+
+SimHeapPause::SimHeapPause()
+{
+    pauseDepth++;
+}
+
+SimHeapPause::~SimHeapPause()
+{
+    pauseDepth--;
+}
+
+void Sim::StartHeapTracking()
+{
+    pauseDepth--;
+}
+
+SimHeapStats Sim::HeapStats()
+{
+    return stats;
+}
+
+void Sim::ResetHeapPeak()
+{
+    stats.peakInUse = stats.inUse;
+}
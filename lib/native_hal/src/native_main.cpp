@@ -0,0 +1,163 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <Arduino.h>
+#include <ESP8266WebServer.h>
+#include "sim.h"
+
+// Firmware entry points
+void setup();
+void loop();
+
+// bench/bench.cpp
+int RunBenchmarks(const char *reportPath, const char *baselinePath);
+// bench/series_check.cpp
+int RunSeriesCheck(const char *path);
+
+struct rst_info resetInfo = {REASON_DEFAULT_RST, 0, 0, 0, 0, 0, 0};
+
+// Simulated time between loop() passes
+#define LOOP_PASS_MICROS 1000
+
+// The node most of ours look like
+static void addDefaultDevices()
+{
+    Sim::AttachI2c(0x77, new SimBme680());
+    Sim::AttachI2c(0x40, new SimSi705());
+    Sim::AttachI2c(0x23, new SimBh1750());
+    Sim::AddDs18b20(0xffb897721503, 19.5f);
+    Sim::AddDs18b20(0x3c01b55612aa, 7.25f);
+}
+
+static void setPresent(SimI2cDevice *device, bool present)
+{
+    if (SimI2cRegisters *registers = dynamic_cast<SimI2cRegisters *>(device))
+        registers->SetPresent(present);
+    else if (SimBme680 *bme680 = dynamic_cast<SimBme680 *>(device))
+        bme680->present = present;
+}
+
+static void usage()
+{
+    printf("usage: program [--seconds N] [--quiet]\n"
+           "       program --bench REPORT [--baseline BASELINE]\n"
+           "       program --series-check FILE > EXPECTED\n"
+           "  --seconds N          simulated seconds to run loop() for (default 60)\n"
+           "  --quiet              don't echo Serial output\n"
+           "  --wifi-down A-B      drop WiFi from A to B simulated seconds\n"
+           "  --unplug ADDR:A-B    remove the I2C device at ADDR from A to B simulated seconds\n"
+           "  --status PATH        fetch PATH from the web server at the end of the run\n"
+           "  --events             listen on /events for the run and print what was sent\n"
+           "  --udp FILE           write the UDP payloads sent, each after its length (uint16 LE)\n"
+           "  --bench REPORT       run the benchmarks and write a JSON report\n"
+           "  --baseline BASELINE  fail if the benchmarks regress against an earlier report\n"
+           "  --series-check FILE  write compressed blocks of varied samples to FILE, as --udp\n"
+           "                       does, and print the line protocol they decode to\n");
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned long seconds = 60;
+    unsigned long downFrom = 0;
+    unsigned long downTo = 0;
+    unsigned int unplugAddress = 0;
+    unsigned long unplugFrom = 0;
+    unsigned long unplugTo = 0;
+    const char *status = nullptr;
+    bool listen = false;
+    const char *udp = nullptr;
+    const char *report = nullptr;
+    const char *baseline = nullptr;
+    const char *seriesCheck = nullptr;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc)
+            seconds = strtoul(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--bench") == 0 && i + 1 < argc)
+            report = argv[++i];
+        else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc)
+            baseline = argv[++i];
+        else if (strcmp(argv[i], "--series-check") == 0 && i + 1 < argc)
+            seriesCheck = argv[++i];
+        else if (strcmp(argv[i], "--wifi-down") == 0 && i + 1 < argc &&
+                 sscanf(argv[++i], "%lu-%lu", &downFrom, &downTo) == 2)
+            ;
+        else if (strcmp(argv[i], "--unplug") == 0 && i + 1 < argc &&
+                 sscanf(argv[++i], "%i:%lu-%lu", &unplugAddress, &unplugFrom, &unplugTo) == 3)
+            ;
+        else if (strcmp(argv[i], "--status") == 0 && i + 1 < argc)
+            status = argv[++i];
+        else if (strcmp(argv[i], "--events") == 0)
+            listen = true;
+        else if (strcmp(argv[i], "--udp") == 0 && i + 1 < argc)
+            udp = argv[++i];
+        else if (strcmp(argv[i], "--quiet") == 0)
+            Sim::SetSerialEcho(false);
+        else
+        {
+            usage();
+            return 1;
+        }
+    }
+
+    // Give stdout a static buffer so the firmware isn't charged for it
+    static char stdoutBuffer[BUFSIZ];
+    setvbuf(stdout, stdoutBuffer, _IOFBF, sizeof(stdoutBuffer));
+
+    if (seriesCheck != nullptr)
+        return RunSeriesCheck(seriesCheck);
+
+    addDefaultDevices();
+    Sim::StartHeapTracking();
+    if (report != nullptr)
+        return RunBenchmarks(report, baseline);
+
+    SimI2cDevice *unplugged = Sim::FindI2c(unplugAddress);
+    setup();
+    SimHttpResponse events;
+    if (listen)
+        events = Sim::HttpRequest(HTTP_GET, "/events");
+    uint64_t end = Sim::Micros() + (uint64_t)seconds * 1000000;
+    while (Sim::Micros() < end)
+    {
+        unsigned long s = Sim::Micros() / 1000000;
+        Sim::SetWifiConnected(s < downFrom || s >= downTo);
+        if (unplugged != nullptr)
+            setPresent(unplugged, s < unplugFrom || s >= unplugTo);
+        loop();
+        Sim::AdvanceMicros(LOOP_PASS_MICROS);
+    }
+
+    if (listen)
+        printf("\n%s", events.connection->received.c_str());
+
+    if (status != nullptr)
+    {
+        SimHttpResponse response = Sim::HttpRequest(HTTP_GET, status);
+        printf("\n%i %s\n", response.code, response.contentType.c_str());
+        for (auto &header : response.headers)
+            printf("%s: %s\n", header.first.c_str(), header.second.c_str());
+        if (response.headers.count("Content-Encoding") != 0)
+            printf("(%u bytes %s)\n", (unsigned)response.body.size(), response.headers["Content-Encoding"].c_str());
+        else
+            printf("%s\n", response.body.c_str());
+    }
+
+    size_t udpBytes = 0;
+    FILE *f = udp != nullptr ? fopen(udp, "wb") : nullptr;
+    for (auto &packet : Sim::UdpPackets())
+    {
+        udpBytes += packet.payload.size();
+        if (f == nullptr)
+            continue;
+        uint8_t len[2] = {(uint8_t)packet.payload.size(), (uint8_t)(packet.payload.size() >> 8)};
+        fwrite(len, 1, sizeof(len), f);
+        fwrite(packet.payload.data(), 1, packet.payload.size(), f);
+    }
+    if (f != nullptr)
+        fclose(f);
+
+    printf("\n%lu s simulated, %u UDP packets (%u bytes) sent\n", seconds, (unsigned)Sim::UdpPackets().size(),
+           (unsigned)udpBytes);
+    return 0;
+}
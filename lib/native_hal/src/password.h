@@ -0,0 +1,3 @@
+// Credentials for the simulated access point
+const char *ssid = "sim";
+const char *password = "sim";
@@ -0,0 +1,306 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string.h>
+#include <OneWire.h>
+#include "sim.h"
+
+static uint64_t clockMicros = 0;
+static uint32_t chipId = 0xc25732;
+static uint32_t freeHeap = 40000;
+static uint8_t heapFragmentation = 5;
+static int analogValue = 512;
+static bool serialEcho = true;
+static bool wifiConnected = true;
+static uint32_t wifiConnectMicros = 2500000;
+static time_t epoch = 1760000000;
+static bool timeSyncAvailable = true;
+static std::vector<SimUdpPacket> udpPackets;
+static std::map<uint8_t, SimI2cDevice *> i2cDevices;
+static uint32_t i2cByteMicros = 90;
+static std::vector<SimDs18b20 *> ds18b20s;
+static uint64_t flashBytesWritten = 0;
+
+// *** Clock ***
+
+uint64_t Sim::Micros()
+{
+    return clockMicros;
+}
+
+void Sim::AdvanceMicros(uint64_t us)
+{
+    clockMicros += us;
+}
+
+// *** Board ***
+
+uint32_t Sim::ChipId()
+{
+    return chipId;
+}
+
+void Sim::SetChipId(uint32_t id)
+{
+    chipId = id;
+}
+
+uint32_t Sim::FreeHeap()
+{
+    int64_t inUse = Sim::HeapStats().inUse;
+    return inUse < freeHeap ? freeHeap - inUse : 0;
+}
+
+void Sim::SetFreeHeap(uint32_t bytes)
+{
+    freeHeap = bytes;
+}
+
+uint8_t Sim::HeapFragmentation()
+{
+    return heapFragmentation;
+}
+
+void Sim::SetHeapFragmentation(uint8_t percent)
+{
+    heapFragmentation = percent;
+}
+
+int Sim::AnalogValue()
+{
+    return analogValue;
+}
+
+void Sim::SetAnalogValue(int value)
+{
+    analogValue = value;
+}
+
+bool Sim::SerialEcho()
+{
+    return serialEcho;
+}
+
+void Sim::SetSerialEcho(bool echo)
+{
+    serialEcho = echo;
+}
+
+// There is nothing to restart into, so a restart ends the run
+void Sim::Restart()
+{
+    printf("\n*** RESTART at %llu ms ***\n", (unsigned long long)(clockMicros / 1000));
+    exit(0);
+}
+
+// *** WiFi and time sync ***
+
+bool Sim::WifiConnected()
+{
+    return wifiConnected;
+}
+
+void Sim::SetWifiConnected(bool connected)
+{
+    wifiConnected = connected;
+}
+
+void Sim::SetWifiConnectMicros(uint32_t us)
+{
+    wifiConnectMicros = us;
+}
+
+uint32_t Sim::WifiConnectMicros()
+{
+    return wifiConnectMicros;
+}
+
+time_t Sim::Epoch()
+{
+    return epoch;
+}
+
+void Sim::SetEpoch(time_t value)
+{
+    epoch = value;
+}
+
+bool Sim::TimeSyncAvailable()
+{
+    return timeSyncAvailable;
+}
+
+void Sim::SetTimeSyncAvailable(bool available)
+{
+    timeSyncAvailable = available;
+}
+
+// *** UDP ***
+
+std::vector<SimUdpPacket> &Sim::UdpPackets()
+{
+    return udpPackets;
+}
+
+// *** I2C ***
+
+void Sim::AttachI2c(uint8_t address, SimI2cDevice *device)
+{
+    SimHeapPause pause;
+    i2cDevices[address] = device;
+}
+
+SimI2cDevice *Sim::FindI2c(uint8_t address)
+{
+    auto it = i2cDevices.find(address);
+    return it == i2cDevices.end() ? nullptr : it->second;
+}
+
+uint32_t Sim::I2cByteMicros()
+{
+    return i2cByteMicros;
+}
+
+void Sim::SetI2cByteMicros(uint32_t us)
+{
+    i2cByteMicros = us;
+}
+
+void SimI2cRegisters::SetRegister(uint8_t reg, const std::vector<uint8_t> &bytes, uint32_t readyAfterMicros)
+{
+    SimHeapPause pause;
+    _registers[reg] = {bytes, readyAfterMicros};
+}
+
+bool SimI2cRegisters::Write(const uint8_t *data, size_t len)
+{
+    if (!_present)
+        return false;
+    if (len > 0)
+    {
+        _selected = true;
+        _selectedReg = data[0];
+        _selectedAt = Sim::Micros();
+    }
+    return true;
+}
+
+size_t SimI2cRegisters::Read(uint8_t *data, size_t len)
+{
+    if (!_present || !_selected)
+        return 0;
+    if (_failReads > 0)
+    {
+        _failReads--;
+        return 0;
+    }
+    auto it = _registers.find(_selectedReg);
+    if (it == _registers.end())
+        return 0;
+    if (Sim::Micros() - _selectedAt < it->second.readyAfterMicros)
+        return 0;
+    size_t n = it->second.bytes.size() < len ? it->second.bytes.size() : len;
+    memcpy(data, it->second.bytes.data(), n);
+    return n;
+}
+
+// Chip type and firmware registers, 14-bit conversions take 10.8 ms
+SimSi705::SimSi705(uint8_t chipType, uint8_t firmware)
+{
+    SetRegister(0xFC, {chipType, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF});
+    SetRegister(0x84, {firmware});
+    SetCelsius(21.0f);
+}
+
+void SimSi705::SetCelsius(float celsius)
+{
+    uint16_t raw = (uint16_t)lround((celsius + 46.85) * 65536 / 175.72) & 0xFFFC;
+    SetRegister(0xF3, {(uint8_t)(raw >> 8), (uint8_t)raw}, 10800);
+}
+
+SimBh1750::SimBh1750()
+{
+    SetLux(250.0f);
+}
+
+void SimBh1750::SetLux(float lux)
+{
+    uint16_t raw = (uint16_t)lround(lux / 0.11);
+    SetRegister(0x11, {(uint8_t)(raw >> 8), (uint8_t)raw});
+}
+
+size_t SimBme680::Read(uint8_t *data, size_t len)
+{
+    if (!present)
+        return 0;
+    memset(data, 0, len);
+    return len;
+}
+
+// *** OneWire ***
+
+SimDs18b20::SimDs18b20(uint64_t serial)
+{
+    rom[0] = 0x28;
+    for (int i = 0; i < 6; i++)
+        rom[i + 1] = (uint8_t)(serial >> (i * 8));
+    rom[7] = OneWire::crc8(rom, 7);
+
+    // Power on scratchpad reads 85 C
+    uint8_t defaults[8] = {0x50, 0x05, 0x4B, 0x46, config, 0xFF, 0x0C, 0x10};
+    memcpy(scratchpad, defaults, 8);
+    UpdateCrc();
+}
+
+void SimDs18b20::CompleteConversion()
+{
+    int16_t raw = (int16_t)lround(celsius * 16);
+    uint8_t cfg = config & 0x60;
+    if (cfg == 0x00)
+        raw &= ~7;
+    else if (cfg == 0x20)
+        raw &= ~3;
+    else if (cfg == 0x40)
+        raw &= ~1;
+    scratchpad[0] = (uint8_t)raw;
+    scratchpad[1] = (uint8_t)(raw >> 8);
+    scratchpad[4] = config;
+    UpdateCrc();
+}
+
+// 93.75 ms at 9 bits doubling for each extra bit
+uint32_t SimDs18b20::ConversionMicros() const
+{
+    return 93750 << ((config >> 5) & 3);
+}
+
+void SimDs18b20::UpdateCrc()
+{
+    scratchpad[8] = OneWire::crc8(scratchpad, 8);
+}
+
+SimDs18b20 *Sim::AddDs18b20(uint64_t serial, float celsius)
+{
+    SimHeapPause pause;
+    SimDs18b20 *probe = new SimDs18b20(serial);
+    probe->celsius = celsius;
+    ds18b20s.push_back(probe);
+    return probe;
+}
+
+std::vector<SimDs18b20 *> &Sim::Ds18b20s()
+{
+    return ds18b20s;
+}
+
+// *** Flash ***
+
+uint64_t Sim::FlashBytesWritten()
+{
+    return flashBytesWritten;
+}
+
+void Sim::CountFlashWrite(size_t bytes)
+{
+    flashBytesWritten += bytes;
+}
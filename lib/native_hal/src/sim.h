@@ -0,0 +1,208 @@
+#ifndef SIM_H
+#define SIM_H
+
+// Scripting interface for the simulated hardware behind the host stand-ins
+
+#include <stdint.h>
+#include <stddef.h>
+#include <time.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "IPAddress.h"
+
+// An I2C device on the simulated bus. Write() returns false to NACK,
+// Read() returns the number of bytes supplied (0 NACKs the read)
+class SimI2cDevice
+{
+public:
+    virtual ~SimI2cDevice() {}
+    virtual bool Write(const uint8_t *data, size_t len) { return true; }
+    virtual size_t Read(uint8_t *data, size_t len) { return 0; }
+};
+
+// Device scripted as a set of registers. Writing a command byte selects a
+// register, reads then return its bytes. A register can be given a ready
+// time after selection (a conversion) before which reads are NACKed
+class SimI2cRegisters : public SimI2cDevice
+{
+public:
+    void SetRegister(uint8_t reg, const std::vector<uint8_t> &bytes, uint32_t readyAfterMicros = 0);
+    void SetPresent(bool present) { _present = present; }
+    void FailReads(int count) { _failReads = count; }
+    bool Write(const uint8_t *data, size_t len);
+    size_t Read(uint8_t *data, size_t len);
+
+private:
+    struct Register
+    {
+        std::vector<uint8_t> bytes;
+        uint32_t readyAfterMicros;
+    };
+    std::map<uint8_t, Register> _registers;
+    bool _selected = false;
+    uint8_t _selectedReg = 0;
+    uint64_t _selectedAt = 0;
+    bool _present = true;
+    int _failReads = 0;
+};
+
+// Si7051 temperature sensor
+class SimSi705 : public SimI2cRegisters
+{
+public:
+    SimSi705(uint8_t chipType = 0x33, uint8_t firmware = 0x20);
+    void SetCelsius(float celsius);
+};
+
+// BH1750 light sensor in 0.5 lux continuous mode with MT 254
+class SimBh1750 : public SimI2cRegisters
+{
+public:
+    SimBh1750();
+    void SetLux(float lux);
+};
+
+// BME680 as seen by the BSEC stand-in. Outputs are returned verbatim by
+// Bsec::run() every 3 s. Accuracy climbs by one every accuracyStepMs
+// unless restored from a saved state
+class SimBme680 : public SimI2cDevice
+{
+public:
+    float temperature = 21.5f;
+    float pressure = 101325.0f;
+    float humidity = 45.0f;
+    float iaq = 42.0f;
+    float co2Equivalent = 520.0f;
+    uint32_t accuracyStepMs = 10 * 60 * 1000;
+    uint32_t runMicros = 3000;
+    bool present = true;
+
+    bool Write(const uint8_t *data, size_t len) { return present; }
+    size_t Read(uint8_t *data, size_t len);
+};
+
+// DS18B20 probe on the simulated OneWire bus. The scratchpad holds the
+// 85 C power on value until the first conversion completes
+class SimDs18b20
+{
+public:
+    uint8_t rom[8];
+    float celsius = 20.0f;
+    uint8_t config = 0x7f;
+    uint64_t convertingUntil = 0;
+    uint8_t scratchpad[9];
+    int corruptReads = 0;
+
+    SimDs18b20(uint64_t serial);
+    void CompleteConversion();
+    uint32_t ConversionMicros() const;
+    void UpdateCrc();
+};
+
+struct SimUdpPacket
+{
+    IPAddress ip;
+    uint16_t port;
+    std::string payload;
+    uint64_t micros;
+};
+
+// Heap use by the firmware since start (allocations made by the
+// simulation itself are excluded)
+struct SimHeapStats
+{
+    uint64_t allocations;
+    uint64_t frees;
+    uint64_t bytesAllocated;
+    int64_t inUse;
+    int64_t peakInUse;
+};
+
+// Allocations made while one of these is in scope belong to the
+// simulation and aren't charged to the firmware
+class SimHeapPause
+{
+public:
+    SimHeapPause();
+    ~SimHeapPause();
+};
+
+// The peer side of a WiFiClient. Nothing more is accepted while the
+// window is 0, closing it stalls the firmware's writes
+struct SimTcpConnection
+{
+    bool open = true;
+    size_t window = 2920;
+    std::string received;
+};
+
+struct SimHttpResponse
+{
+    int code = 0;
+    std::string contentType;
+    std::map<std::string, std::string> headers;
+    std::string body;
+    int chunks = 0;
+    // Still open if the handler kept the client, as /events does
+    std::shared_ptr<SimTcpConnection> connection;
+};
+
+namespace Sim
+{
+// Clock
+uint64_t Micros();
+void AdvanceMicros(uint64_t us);
+
+// Heap, free heap is the board's heap less what the firmware has in use
+void StartHeapTracking();
+SimHeapStats HeapStats();
+void ResetHeapPeak();
+
+// Board
+uint32_t ChipId();
+void SetChipId(uint32_t id);
+uint32_t FreeHeap();
+void SetFreeHeap(uint32_t bytes);
+uint8_t HeapFragmentation();
+void SetHeapFragmentation(uint8_t percent);
+int AnalogValue();
+void SetAnalogValue(int value);
+bool SerialEcho();
+void SetSerialEcho(bool echo);
+void Restart();
+
+// WiFi and time sync
+bool WifiConnected();
+void SetWifiConnected(bool connected);
+void SetWifiConnectMicros(uint32_t us);
+uint32_t WifiConnectMicros();
+time_t Epoch();
+void SetEpoch(time_t epoch);
+bool TimeSyncAvailable();
+void SetTimeSyncAvailable(bool available);
+
+// UDP packets sent since start
+std::vector<SimUdpPacket> &UdpPackets();
+
+// I2C bus, every transferred byte costs I2cByteMicros()
+void AttachI2c(uint8_t address, SimI2cDevice *device);
+SimI2cDevice *FindI2c(uint8_t address);
+uint32_t I2cByteMicros();
+void SetI2cByteMicros(uint32_t us);
+
+// OneWire bus
+SimDs18b20 *AddDs18b20(uint64_t serial, float celsius);
+std::vector<SimDs18b20 *> &Ds18b20s();
+
+// Flash file system wear
+uint64_t FlashBytesWritten();
+void CountFlashWrite(size_t bytes);
+
+// Runs a request through the web server's handlers
+SimHttpResponse HttpRequest(int method, const char *uri, const std::map<std::string, std::string> &args = {},
+                            const std::map<std::string, std::string> &headers = {});
+} // namespace Sim
+
+#endif // SIM_H
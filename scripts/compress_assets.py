@@ -0,0 +1,80 @@
+# Gzips the status page shell in web/ into include/static_assets_data.h
+# so it is served from flash as is. Runs before each PlatformIO build
+# and can be run by hand: python3 scripts/compress_assets.py
+#
+# {{name}} in an asset is replaced by the URL of asset name with its
+# hash as a query, so the referenced assets can be cached forever
+import gzip
+import hashlib
+import os
+import re
+
+try:
+    # PlatformIO runs extra scripts without __file__
+    Import("env")
+    ROOT = env.subst("$PROJECT_DIR")
+except NameError:
+    ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+SOURCE = os.path.join(ROOT, "web")
+OUTPUT = os.path.join(ROOT, "include", "static_assets_data.h")
+
+# Referenced assets first, then the pages that reference them
+ASSETS = (
+    ("status.css", "/status.css", "text/css", True),
+    ("status.js", "/status.js", "application/javascript", True),
+    ("status.html", "/", "text/html", False),
+)
+
+
+def symbol(name):
+    parts = re.split(r"[^A-Za-z0-9]", name)
+    return parts[0] + "".join(p.capitalize() for p in parts[1:])
+
+
+def generate():
+    urls = {}
+    lines = [
+        "// Generated by scripts/compress_assets.py from web/, do not edit",
+        "#ifndef STATICASSETSDATA_H",
+        "#define STATICASSETSDATA_H",
+        "",
+        "#include <static_assets.h>",
+        "",
+    ]
+    entries = []
+    for name, uri, content_type, immutable in ASSETS:
+        with open(os.path.join(SOURCE, name), "r") as f:
+            text = f.read()
+        text = re.sub(r"\{\{([^}]+)\}\}", lambda m: urls[m.group(1)], text)
+        data = gzip.compress(text.encode("utf-8"), 9, mtime=0)
+        digest = hashlib.sha1(data).hexdigest()[:16]
+        urls[name] = "%s?v=%s" % (uri, digest[:8])
+
+        var = symbol(name)
+        lines.append("// %s, %d bytes, %d gzipped" % (name, len(text), len(data)))
+        lines.append("static const uint8_t %s[] PROGMEM = {" % var)
+        for i in range(0, len(data), 16):
+            lines.append("    " + ", ".join("0x%02x" % b for b in data[i:i + 16]) + ",")
+        lines.append("};")
+        lines.append("")
+        entries.append('    {"%s", "%s", %s, sizeof(%s), "\\"%s\\"", %s},' %
+                       (uri, content_type, var, var, digest, "true" if immutable else "false"))
+
+    lines.append("static const StaticAsset staticAssets[] = {")
+    lines.extend(entries)
+    lines.append("};")
+    lines.append("")
+    lines.append("#endif // STATICASSETSDATA_H")
+    content = "\n".join(lines) + "\n"
+
+    # Leave the header alone if nothing changed so it doesn't force a rebuild
+    if os.path.exists(OUTPUT):
+        with open(OUTPUT, "r") as f:
+            if f.read() == content:
+                return
+    with open(OUTPUT, "w") as f:
+        f.write(content)
+    print("Generated %s" % os.path.relpath(OUTPUT, ROOT))
+
+
+generate()
@@ -0,0 +1,97 @@
+# PlatformIO post script: prints how much of the ESP8266's 80KB of DRAM
+# the firmware image uses. .data and .rodata are copied to RAM at boot,
+# so strings left out of PROGMEM show up here
+#
+# Sizes are compared with scripts/size_baseline.json when it exists. To
+# keep the current build's sizes as the new baseline:
+#   SIZE_BASELINE_SAVE=1 pio run -e esp12e
+# or for an image built elsewhere, such as an older checkout:
+#   python3 scripts/size_report.py --save path/to/firmware.elf
+
+import json
+import os
+import subprocess
+
+DRAM_BYTES = 80 * 1024
+SECTIONS = (".data", ".rodata", ".bss")
+DEFAULT_SIZETOOL = "xtensa-lx106-elf-size"
+
+
+def git_commit(cwd):
+    try:
+        return subprocess.check_output(["git", "rev-parse", "--short", "HEAD"], universal_newlines=True, cwd=cwd,
+                                       stderr=subprocess.DEVNULL).strip()
+    except (OSError, subprocess.CalledProcessError):
+        return "unknown"
+
+
+def load_baseline(path):
+    try:
+        with open(path) as f:
+            return json.load(f)
+    except (OSError, ValueError):
+        return None
+
+
+def read_sizes(sizetool, elf):
+    out = subprocess.check_output([sizetool, "-A", elf], universal_newlines=True)
+    sizes = dict.fromkeys(SECTIONS + (".irom0.text",), 0)
+    for line in out.splitlines():
+        fields = line.split()
+        if len(fields) >= 2 and fields[0] in sizes:
+            sizes[fields[0]] = int(fields[1])
+    sizes["DRAM"] = sum(sizes[name] for name in SECTIONS)
+    return sizes
+
+
+def row(name, size, baseline, suffix=""):
+    if baseline is None or name not in baseline:
+        print("  %-12s %7d%s" % (name, size, suffix))
+    else:
+        print("  %-12s %7d %+7d%s" % (name, size, size - baseline[name], suffix))
+
+
+def report(sizetool, elf, baseline_path, save, commit):
+    sizes = read_sizes(sizetool, elf)
+    baseline = load_baseline(baseline_path)
+    if baseline is None:
+        print("Section sizes for %s" % elf)
+    else:
+        print("Section sizes for %s, change since %s" % (elf, baseline.get("commit", "the baseline")))
+    for name in SECTIONS:
+        row(name, sizes[name], baseline)
+    used = sizes["DRAM"]
+    row("DRAM", used, baseline, " of %d (%d%%) before heap" % (DRAM_BYTES, used * 100 // DRAM_BYTES))
+    row(".irom0.text", sizes[".irom0.text"], baseline)
+
+    if save:
+        sizes["commit"] = commit
+        with open(baseline_path, "w") as f:
+            json.dump(sizes, f, indent=2, sort_keys=True)
+            f.write("\n")
+        print("Baseline saved to %s" % baseline_path)
+    elif baseline is None:
+        print("No baseline in %s, SIZE_BASELINE_SAVE=1 keeps these" % baseline_path)
+
+
+if __name__ == "__main__":
+    import argparse
+
+    parser = argparse.ArgumentParser(description="Print an ESP8266 image's DRAM use against the baseline")
+    parser.add_argument("elf")
+    parser.add_argument("--sizetool", default=DEFAULT_SIZETOOL)
+    parser.add_argument("--baseline", default=os.path.join(os.path.dirname(os.path.abspath(__file__)), "size_baseline.json"))
+    parser.add_argument("--save", action="store_true", help="keep these sizes as the baseline")
+    parser.add_argument("--commit", help="commit the image was built from, for --save")
+    args = parser.parse_args()
+    report(args.sizetool, args.elf, args.baseline, args.save,
+           args.commit or git_commit(os.path.dirname(os.path.abspath(args.elf))))
+else:
+    Import("env")
+
+    def size_report(source, target, env):
+        project = env.subst("$PROJECT_DIR")
+        report(env.subst("$SIZETOOL"), str(target[0]), os.path.join(project, "scripts", "size_baseline.json"),
+               bool(os.environ.get("SIZE_BASELINE_SAVE")), git_commit(project))
+
+    env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", size_report)
@@ -0,0 +1,214 @@
+#!/usr/bin/env python3
+# Expands compressed telemetry (TELEMETRY_COMPRESSED, see
+# include/series_block.h) back into InfluxDB line protocol. Runs on the
+# influx host, listening where the nodes send and forwarding to influx:
+#
+#   python3 scripts/uplink_decoder.py --listen 0.0.0.0:8090 --influx 127.0.0.1:8089
+#
+# or decodes packets saved by the simulator (program --udp FILE) to stdout:
+#
+#   python3 scripts/uplink_decoder.py --file FILE
+#
+# With --expect it instead compares them with the lines in a file and
+# exits non-zero on a difference, which checks this decoder against the
+# node's encoder (see bench/README):
+#
+#   program --series-check blocks.bin > expected.txt
+#   python3 scripts/uplink_decoder.py --file blocks.bin --expect expected.txt
+import argparse
+import socket
+import struct
+import sys
+import time
+
+MAGIC = b"EG"
+VERSION = 1
+PACKET_HEADER = 8
+EPOCH = 0x01
+
+# Keeps packets clear of fragmentation, as the nodes do
+MAX_FORWARD = 1400
+
+
+class Bits:
+    """Reads a bit stream most significant bit first"""
+
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def read(self, count):
+        value = 0
+        for _ in range(count):
+            byte = self.data[self.pos // 8]
+            value = value << 1 | (byte >> (7 - self.pos % 8)) & 1
+            self.pos += 1
+        return value
+
+    def signed(self, count):
+        value = self.read(count)
+        return value - (1 << count) if value & 1 << (count - 1) else value
+
+
+def text(data, at):
+    length = data[at]
+    return data[at + 1:at + 1 + length].decode(), at + 1 + length
+
+
+def fixed(value, decimals):
+    """Formats like FormatFixed() on the node"""
+    if decimals == 0:
+        return str(value)
+    digits = str(abs(value)).rjust(decimals + 1, "0")
+    sign = "-" if value < 0 else ""
+    return sign + digits[:-decimals] + "." + digits[-decimals:]
+
+
+def read_time(bits, delta):
+    if bits.read(1) == 0:
+        return delta
+    if bits.read(1) == 0:
+        return delta + bits.signed(7)
+    if bits.read(1) == 0:
+        return delta + bits.signed(9)
+    if bits.read(1) == 0:
+        return delta + bits.signed(12)
+    return delta + bits.signed(32)
+
+
+def read_value(bits, field):
+    """field is [value, leading, trailing], updated in place"""
+    if bits.read(1) == 0:
+        return field[0]
+    if bits.read(1) == 1:
+        field[1] = bits.read(5)
+        meaningful = bits.read(5) + 1
+        field[2] = 32 - field[1] - meaningful
+    meaningful = 32 - field[1] - field[2]
+    xored = bits.read(meaningful) << field[2]
+    value = (field[0] & 0xFFFFFFFF) ^ xored
+    field[0] = value - (1 << 32) if value & 0x80000000 else value
+    return field[0]
+
+
+def decode_block(data, offset):
+    """Returns (samples, end) where samples are (ms, id, [(name, decimals, value)])"""
+    (length,) = struct.unpack_from("<H", data, offset)
+    block = data[offset:offset + length]
+    flags = block[2]
+    driver_id, at = text(block, 3)
+    fields = []
+    field_count = block[at]
+    at += 1
+    for _ in range(field_count):
+        name, at = text(block, at)
+        fields.append((name, block[at]))
+        at += 1
+    count, first = struct.unpack_from("<HQ", block, at)
+    bits = Bits(block[at + 10:])
+
+    samples = []
+    state = []
+    when = first
+    delta = 0
+    for n in range(count):
+        if n == 0:
+            values = [bits.signed(32) for _ in fields]
+            state = [[v, 32, 32] for v in values]
+        else:
+            delta = read_time(bits, delta)
+            when += delta
+            values = [read_value(bits, field) for field in state]
+        samples.append((when, flags, driver_id, list(zip(fields, values))))
+    return samples, offset + length
+
+
+def decode_packet(data, received_ms):
+    """Line protocol for a packet, nanosecond timestamps"""
+    if len(data) < PACKET_HEADER or data[:2] != MAGIC or data[2] != VERSION:
+        raise ValueError("not a compressed telemetry packet")
+    (sent,) = struct.unpack_from("<I", data, 4)
+    lines = []
+    offset = PACKET_HEADER
+    while offset + 2 <= len(data):
+        samples, offset = decode_block(data, offset)
+        for when, flags, driver_id, values in samples:
+            # millis() stamps are placed relative to when the packet was sent
+            if not flags & EPOCH:
+                when = received_ms - ((sent - when) & 0xFFFFFFFF)
+            for (name, decimals), value in values:
+                lines.append("%s,id=%s value=%s %d000000" % (name, driver_id, fixed(value, decimals), when))
+    return lines
+
+
+def batches(lines):
+    """Lines grouped into packets of up to MAX_FORWARD bytes"""
+    batch = ""
+    for line in lines:
+        if batch and len(batch) + len(line) + 1 > MAX_FORWARD:
+            yield batch
+            batch = ""
+        batch += line + "\n"
+    if batch:
+        yield batch
+
+
+def expect(lines, path):
+    with open(path) as f:
+        expected = f.read().splitlines()
+    for n, (got, want) in enumerate(zip(lines, expected)):
+        if got != want:
+            print("line %d: decoded %s, expected %s" % (n + 1, got, want), file=sys.stderr)
+            return 1
+    if len(lines) != len(expected):
+        print("decoded %d lines, expected %d" % (len(lines), len(expected)), file=sys.stderr)
+        return 1
+    print("%d lines match" % len(lines))
+    return 0
+
+
+def address(value):
+    host, port = value.rsplit(":", 1)
+    return host, int(port)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Expands compressed telemetry into line protocol")
+    parser.add_argument("--listen", type=address, default=("0.0.0.0", 8090), help="host:port to receive on")
+    parser.add_argument("--influx", type=address, default=("127.0.0.1", 8089), help="influx UDP host:port")
+    parser.add_argument("--file", help="decode packets saved by the simulator instead")
+    parser.add_argument("--expect", help="with --file, compare with the lines in this file")
+    args = parser.parse_args()
+
+    if args.file:
+        with open(args.file, "rb") as f:
+            data = f.read()
+        lines = []
+        offset = 0
+        while offset + 2 <= len(data):
+            (length,) = struct.unpack_from("<H", data, offset)
+            packet = data[offset + 2:offset + 2 + length]
+            offset += 2 + length
+            lines += decode_packet(packet, int(time.time() * 1000))
+        if args.expect:
+            return expect(lines, args.expect)
+        for line in lines:
+            print(line)
+        return 0
+
+    receive = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    receive.bind(args.listen)
+    send = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    while True:
+        packet, sender = receive.recvfrom(2048)
+        try:
+            lines = decode_packet(packet, int(time.time() * 1000))
+        except (ValueError, IndexError, struct.error) as e:
+            print("%s: %s" % (sender[0], e), file=sys.stderr)
+            continue
+        for batch in batches(lines):
+            send.sendto(batch.encode(), args.influx)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,81 @@
+#include <Arduino.h>
+#include <alloc_hook.h>
+
+#if ALLOC_HOOK
+#ifdef ARDUINO_ARCH_ESP8266
+// The linker sends every call to malloc() and friends, including those
+// from String and operator new, here first
+static volatile uint32_t allocs = 0;
+static volatile uint32_t frees = 0;
+
+extern "C"
+{
+    void *__real_malloc(size_t size);
+    void *__real_calloc(size_t count, size_t size);
+    void *__real_realloc(void *ptr, size_t size);
+    void __real_free(void *ptr);
+
+    void *__wrap_malloc(size_t size)
+    {
+        allocs++;
+        return __real_malloc(size);
+    }
+
+    void *__wrap_calloc(size_t count, size_t size)
+    {
+        allocs++;
+        return __real_calloc(count, size);
+    }
+
+    void *__wrap_realloc(void *ptr, size_t size)
+    {
+        allocs++;
+        return __real_realloc(ptr, size);
+    }
+
+    void __wrap_free(void *ptr)
+    {
+        if (ptr != nullptr)
+            frees++;
+        __real_free(ptr);
+    }
+}
+
+AllocCounts GetAllocCounts()
+{
+    return {allocs, frees};
+}
+#else
+#include "sim.h"
+
+AllocCounts GetAllocCounts()
+{
+    SimHeapStats stats = Sim::HeapStats();
+    return {(uint32_t)stats.allocations, (uint32_t)stats.frees};
+}
+#endif
+#endif
+
+// *** PUBLIC ***
+
+void AllocTracker::BeginPass()
+{
+#if ALLOC_HOOK
+    _start = GetAllocCounts();
+#endif
+}
+
+void AllocTracker::EndPass()
+{
+#if ALLOC_HOOK
+    AllocCounts end = GetAllocCounts();
+    uint32_t passAllocs = end.allocs - _start.allocs;
+    _passes++;
+    if (passAllocs == 0 && end.frees == _start.frees)
+        return;
+    _heapPasses++;
+    _lastHeapMillis = millis();
+    if (passAllocs > _maxPassAllocs)
+        _maxPassAllocs = passAllocs;
+#endif
+}
@@ -0,0 +1,17 @@
+#include <Arduino.h>
+#include <arena.h>
+
+// *** PUBLIC ***
+
+void *Arena::Allocate(size_t size, size_t align)
+{
+    uintptr_t start = ((uintptr_t)&_buf[_used] + align - 1) & ~(uintptr_t)(align - 1);
+    size_t offset = start - (uintptr_t)_buf;
+    if (offset + size > _size)
+    {
+        Serial.printf_P(PSTR("Arena full, %u of %u bytes used\n"), (unsigned)_used, (unsigned)_size);
+        return nullptr;
+    }
+    _used = offset + size;
+    return &_buf[offset];
+}
@@ -1,14 +1,27 @@
 #include <Arduino.h>
 #include <bh1750_driver.h>
+#include <arena.h>
+
+// lux,id=BHc25732 value=191.12
+static constexpr char luxName[] PROGMEM = "lux";
+static constexpr char luxLabel[] PROGMEM = "Light Intensity (Lux)";
+static constexpr Measurement schema[] = {
+    {luxName, luxLabel, 2, 0, MEASUREMENT_ANY_MAX, nullptr, 500, 0}};
+static_assert(MaxLineProtocolLength(schema) <= MAX_PACKET_DATA, "BH1750 packet data too long");
+
+// Light can change in a moment, so only a median of 3 for misreads,
+// counted past 500 lux
+static constexpr FilterStage filters[] = {{FILTER_MEDIAN, 3, 50000}};
 
 // *** PUBLIC ***
 
 // Scan for device and create a driver if found
-int Bh1750Driver::CreateDriverInstances(TwoWire *i2c, SensorDriver *firstInstance[], int maxInstances)
+int Bh1750Driver::CreateDriverInstances(I2cBus *bus, SensorDriver *firstInstance[], int maxInstances)
 {
     if (maxInstances < 1)
         return 0;
     int instances = 0;
+    TwoWire *i2c = bus->GetWire();
 
     // Bh1750 can be at 0x23 (or 0x5C)
     // MT <- 254 (2 commands)
@@ -23,10 +36,11 @@ int Bh1750Driver::CreateDriverInstances(TwoWire *i2c, SensorDriver *firstInstanc
     i2c->beginTransmission(0x23);
     i2c->write((int8_t)0x11);
     uint8_t e = i2c->endTransmission();
-    Serial.printf("Bh1750 endTransmission %i\n", e);
-    if (e == 0)
+    Serial.printf_P(PSTR("Bh1750 endTransmission %i\n"), e);
+    void *p = e == 0 ? driverArena.Allocate(sizeof(Bh1750Driver), alignof(Bh1750Driver)) : nullptr;
+    if (p != nullptr)
     {
-        firstInstance[instances++] = new Bh1750Driver(i2c, 0x23);
+        firstInstance[instances++] = new (p) Bh1750Driver(bus, 0x23);
         delay(10);
     }
     return instances;
@@ -34,61 +48,97 @@ int Bh1750Driver::CreateDriverInstances(TwoWire *i2c, SensorDriver *firstInstanc
 
 int Bh1750Driver::GetPacketData(char *ptr)
 {
-    char t[32];
-    dtostrf((double)_lastLux, 1, 2, t);
-    // lux,id=BHc25732 value=191.12
-    return sprintf(ptr, "lux,id=%s value=%s\n", _id, t);
+    return EncodeLineProtocol(ptr, schema, _id, &_lastLux);
 }
 
-void Bh1750Driver::Handle()
+bool Bh1750Driver::IsLastReadingValid()
 {
-    // Take a light reading every 5 seconds
-    if ((unsigned long)(millis() - _lastPollMillis) < 5000)
-        return;
-
-    _lastPollMillis = millis();
+    return IsValid(schema, &_lastLux);
+}
 
-    // Read the lux value
-    if (_i2c->requestFrom(_address, 2) == 2)
-    {
-        int lastLux = (_i2c->read() << 8) | _i2c->read();
-        // Convert to LUX for MT value of 254 & 0.5 lux
-        _lastLux = lastLux * .11f;
-    }
-    else
-        _lastLux = -1;
+uint32_t Bh1750Driver::Handle()
+{
+    // Take a light reading every 5 seconds, less often if failing
+    uint32_t wait = _health.GetWaitMs();
+    if (wait > 0)
+        return wait;
+    unsigned long elapsed = millis() - _lastPollMillis;
+    if (elapsed < SENSOR_POLL_MS)
+        return SENSOR_POLL_MS - elapsed;
 
-    // Debug output
-    Serial.print(_id);
-    Serial.println(" updated");
+    // Read the lux value (continuous mode so no command needed)
+    if (!_bus->Queue(_address, nullptr, 0, 2, 0, OnReading, this))
+        return SENSOR_RETRY_MS;
+    _lastPollMillis = millis();
+    _queuedMicros = micros();
+    return SENSOR_POLL_MS;
 }
 
-void Bh1750Driver::GetValues(void cb(const char *, const char *))
+void Bh1750Driver::GetValues(void cb(const __FlashStringHelper *, const char *))
 {
     char val[64];
     // Call back with name value pairs
-    cb("Device", "BH1750");
-    sprintf(val, " %#x", _address);
-    cb("Address", val);
-    cb("Id", _id);
+    cb(F("Device"), strcpy_P(val, PSTR("BH1750")));
+    sprintf_P(val, PSTR(" %#x"), _address);
+    cb(F("Address"), val);
+    cb(F("Id"), _id);
 
     if (!IsLastReadingValid())
     {
-        cb("ERROR", "Insane LUX");
+        cb(F("ERROR"), strcpy_P(val, PSTR("Insane LUX")));
         return;
     }
 
-    cb("Light Intensity (Lux)", dtostrf((double)_lastLux, 1, 2, val));
+    EncodeValues(cb, schema, &_lastLux);
+}
+
+int Bh1750Driver::GetReadings(const Measurement **schemaOut, const int32_t **values)
+{
+    *schemaOut = schema;
+    *values = &_lastLux;
+    return sizeof(schema) / sizeof(schema[0]);
 }
 
 // *** PRIVATE ***
 
+// Completion of a queued read
+void Bh1750Driver::OnReading(void *context, uint8_t status, const uint8_t *data, uint8_t len)
+{
+    Bh1750Driver *driver = (Bh1750Driver *)context;
+    if (status == I2C_OK)
+    {
+        int32_t lastLux = data[0] << 8 | data[1];
+        // Convert to LUX for MT value of 254 & 0.5 lux (0.11 lux a count),
+        // a rejected glitch keeps the last reading
+        FilterResult result = driver->_filter.Add(lastLux * 11, &driver->_lastLux);
+        if (result == FILTER_OUT_OF_RANGE)
+            driver->_health.Failure();
+        else
+            driver->_health.Success(micros() - driver->_queuedMicros);
+        if (result == FILTER_REJECTED || result == FILTER_PENDING)
+            return;
+        if (result == FILTER_OUT_OF_RANGE)
+            driver->_lastLux = -1;
+    }
+    else
+    {
+        driver->_health.Failure();
+        driver->_lastLux = -1;
+    }
+    driver->_generation++;
+
+    // Debug output
+    Serial.print(driver->_id);
+    Serial.println(F(" updated"));
+}
+
 // Construct a driver for a Bh1750Driver device at address
-Bh1750Driver::Bh1750Driver(TwoWire *i2c, int address)
+Bh1750Driver::Bh1750Driver(I2cBus *bus, int address)
 {
-    _i2c = i2c;
+    _bus = bus;
     _address = address;
+    _filter.Begin(&schema[0], filters, _filterState);
 
     // Unique id is BH - ESP8266 id
-    sprintf(_id, "BH%x", ESP.getChipId());
+    sprintf_P(_id, PSTR("BH%x"), ESP.getChipId());
 }
@@ -1,30 +1,68 @@
 #include <Arduino.h>
-#include <LittleFS.h>
 #include <bme680_driver.h>
+#include <arena.h>
+#include <event_log.h>
 
 const uint8_t bsec_config_iaq[] = {
 #include "config/generic_33v_3s_28d/bsec_iaq.txt"
 };
 
-// Save sensor state every 12 hours
+// Save sensor state to flash every 12 hours, and to RTC memory every
+// minute, either only if it changed
 #define SAVE_PERIOD_MS (12 * 60 * 60 * 1000)
+#define RTC_SAVE_PERIOD_MS (60 * 1000)
+
+static PGM_P DescribeIaq(int32_t iaq);
+static PGM_P DescribeAccuracy(int32_t accuracy);
+
+// BSEC reports floats, they are converted to these decimals once per
+// reading. Pressure is reported in Pa, which is mb to 2 decimals
+// temperature,id=BMc25732 value=30.5072
+// pressure,id=BMc25732 value=1004.13
+// humidity,id=BMc25732 value=48.09
+// iaq,id=BMc25732 value=25 (static air quality)
+// accuracy,id=BMc25732 value=3 (static air quality accuracy)
+// co2,id=BMc25732 value=500.00 (CO2 estimate)
+// Accuracy rarely changes, so its heartbeat is longer
+static constexpr char temperatureName[] PROGMEM = "temperature";
+static constexpr char temperatureLabel[] PROGMEM = "Temprature (C)";
+static constexpr char pressureName[] PROGMEM = "pressure";
+static constexpr char pressureLabel[] PROGMEM = "Pressure (mb)";
+static constexpr char humidityName[] PROGMEM = "humidity";
+static constexpr char humidityLabel[] PROGMEM = "Humidity (%)";
+static constexpr char iaqName[] PROGMEM = "iaq";
+static constexpr char iaqLabel[] PROGMEM = "Air Quality (0-500)";
+static constexpr char accuracyName[] PROGMEM = "accuracy";
+static constexpr char accuracyLabel[] PROGMEM = "Air Quality Accuracy (0-3)";
+static constexpr char co2Name[] PROGMEM = "co2";
+static constexpr char co2Label[] PROGMEM = "CO2 Estimate (ppm)";
+static constexpr Measurement schema[BME680_READINGS] = {
+    {temperatureName, temperatureLabel, 4, MIN_SANE_VALUE * 10000, MAX_SANE_VALUE * 10000, nullptr, 500, 0},
+    {pressureName, pressureLabel, 2, MEASUREMENT_ANY_MIN, MEASUREMENT_ANY_MAX, nullptr, 10, 0},
+    {humidityName, humidityLabel, 2, MEASUREMENT_ANY_MIN, MEASUREMENT_ANY_MAX, nullptr, 50, 0},
+    {iaqName, iaqLabel, 0, MEASUREMENT_ANY_MIN, MEASUREMENT_ANY_MAX, DescribeIaq, 5, 0},
+    {accuracyName, accuracyLabel, 0, MEASUREMENT_ANY_MIN, MEASUREMENT_ANY_MAX, DescribeAccuracy, 0, 15 * 60},
+    {co2Name, co2Label, 2, MEASUREMENT_ANY_MIN, MEASUREMENT_ANY_MAX, nullptr, 1000, 0}};
+static_assert(MaxLineProtocolLength(schema) <= MAX_PACKET_DATA, "BME680 packet data too long");
 
 // *** PUBLIC ***
 
-int Bme680Driver::CreateDriverInstances(TwoWire *i2c, SensorDriver *firstInstance[], int maxInstances, float trim1, float trim2)
+int Bme680Driver::CreateDriverInstances(I2cBus *bus, SensorDriver *firstInstance[], int maxInstances, float trim1, float trim2)
 {
     if (maxInstances < 1)
         return 0;
     int instances = 0;
+    TwoWire *i2c = bus->GetWire();
 
     // Bme680 can be at 0x77 (PRIMARY)
     i2c->beginTransmission(0x77);
     uint8_t e = i2c->endTransmission();
-    Serial.printf("Bme680Driver 0x77 endTransmission %i\n", e);
-    if (e == 0)
+    Serial.printf_P(PSTR("Bme680Driver 0x77 endTransmission %i\n"), e);
+    void *p = e == 0 ? driverArena.Allocate(sizeof(Bme680Driver), alignof(Bme680Driver)) : nullptr;
+    if (p != nullptr)
     {
         // Found primary sensor
-        firstInstance[instances++] = new Bme680Driver(i2c, 0x77, "BME", trim1);
+        firstInstance[instances++] = new (p) Bme680Driver(bus, 0x77, "BME", 0, trim1);
     }
 
     if (maxInstances < (instances + 1))
@@ -33,11 +71,12 @@ int Bme680Driver::CreateDriverInstances(TwoWire *i2c, SensorDriver *firstInstanc
     // ... and / or 0x76 (SECONDARY)
     i2c->beginTransmission(0x76);
     e = i2c->endTransmission();
-    Serial.printf("Bme680Driver 0x76 endTransmission %i\n", e);
-    if (e == 0)
+    Serial.printf_P(PSTR("Bme680Driver 0x76 endTransmission %i\n"), e);
+    p = e == 0 ? driverArena.Allocate(sizeof(Bme680Driver), alignof(Bme680Driver)) : nullptr;
+    if (p != nullptr)
     {
         // Found secondary sensor
-        firstInstance[instances++] = new Bme680Driver(i2c, 0x76, "BMF", trim2);
+        firstInstance[instances++] = new (p) Bme680Driver(bus, 0x76, "BMF", 1, trim2);
     }
 
     return instances;
@@ -45,161 +84,84 @@ int Bme680Driver::CreateDriverInstances(TwoWire *i2c, SensorDriver *firstInstanc
 
 int Bme680Driver::GetPacketData(char *ptr)
 {
-    char t[16];
-    dtostrf((double)_lastTemp, 1, 4, t);
-
-    char pressure[16];
-    dtostrf((double)_lastPressure / 100, 1, 2, pressure);
-
-    char humidity[16];
-    dtostrf((double)_lastHumidity, 1, 2, humidity);
-
-    char iaq[16];
-    dtostrf((double)_lastIaq, 1, 0, iaq);
-
-    char co2[16];
-    dtostrf((double)_lastCo2Equivalent, 1, 2, co2);
-
-    // (temprature) temperature,id=BMc25732 value=30.5072
-    // (pressure) pressure,id=BMc25732 value=1004.13
-    // (humidity) humidity,id=BMc25732 value=48.09
-    // (static air quality) iaq,id=BMc25732 value=25
-    // (static air quality accuracy) accuracy,id=BMc25732 value=25
-    // (CO2 estimate) co2,id=BMc25732 value=500
-    return sprintf(ptr,
-                   "temperature,id=%s value=%s\n"
-                   "pressure,id=%s value=%s\n"
-                   "humidity,id=%s value=%s\n"
-                   "iaq,id=%s value=%s\n"
-                   "accuracy,id=%s value=%i\n"
-                   "co2,id=%s value=%s\n",
-                   _id, t,
-                   _id, pressure,
-                   _id, humidity,
-                   _id, iaq,
-                   _id, _lastIaqAccuracy,
-                   _id, co2);
+    return EncodeLineProtocol(ptr, schema, _id, _lastReadings);
 }
 
-void Bme680Driver::Handle()
+uint32_t Bme680Driver::Handle()
 {
-    if (_iaqSensor.run())
-    {
-        _lastTemp = _iaqSensor.temperature;
-        _lastPressure = _iaqSensor.pressure;
-        _lastHumidity = _iaqSensor.humidity;
-        _lastIaq = _iaqSensor.staticIaq;
-        _lastIaqAccuracy = _iaqSensor.staticIaqAccuracy;
-        _lastCo2Equivalent = _iaqSensor.co2Equivalent;
-
-        // Sanity check
-        _lastReadingValid = _lastTemp >= MIN_SANE_VALUE && _lastTemp <= MAX_SANE_VALUE;
-
-        // Debug output
-        Serial.print(_id);
-        Serial.println(" updated");
-
-        // Save state if accuracy is 3 and haven't saved it for a while
-        if (_lastIaqAccuracy == 3 &&
-            ((_lastSaveMs == 0) || ((unsigned long)(millis() - _lastSaveMs) >= SAVE_PERIOD_MS)))
-        {
-            uint8_t bsecState[BSEC_MAX_STATE_BLOB_SIZE] = {0};
-            _iaqSensor.getState(bsecState);
-            if (!IsBadStatus("getState()"))
-            {
-                File f = LittleFS.open(_id, "w");
-                if (f)
-                {
-                    f.write((char *)&bsecState, BSEC_MAX_STATE_BLOB_SIZE);
-                    f.close();
-                }
-            }
-            // Save again in a while
-            _lastSaveMs = millis();
-        }
-    }
-    else
-    {
-        _lastReadingValid = !IsBadStatus("Handle()");
-    }
+    // BSEC drives the bus itself, so give it an exclusive slot when due
+    if (_runQueued)
+        return SENSOR_RETRY_MS;
+    // A failing sensor is run less often than BSEC asks
+    uint32_t backoff = _health.GetWaitMs();
+    if (_health.IsBackingOff() && backoff > 0)
+        return backoff;
+    int64_t wait = _iaqSensor.nextCall - GetTimeMs();
+    if (wait > 0)
+        return wait;
+    _runQueued = _bus->QueueExclusive(OnRun, this);
+    return SENSOR_RETRY_MS;
 }
 
-void Bme680Driver::GetValues(void cb(const char *, const char *))
+void Bme680Driver::GetValues(void cb(const __FlashStringHelper *, const char *))
 {
     char val[64], tmp[64];
     // Call back with name value pairs
-    cb("Device", "BME680");
-    sprintf(tmp, "%i.%i.%i.%i", _iaqSensor.version.major, _iaqSensor.version.minor, _iaqSensor.version.major_bugfix, _iaqSensor.version.minor_bugfix);
-    cb("BSEC", tmp);
-    sprintf(val, " %#x", _address);
-    cb("Address", val);
-    cb("Id", _id);
-    cb("Subtract Trim (C) ", dtostrf((double)_trim, 1, 2, val));
-    cb("Saved State", LittleFS.exists(_id) ? "YES" : "NO");
+    cb(F("Device"), strcpy_P(val, PSTR("BME680")));
+    sprintf_P(tmp, PSTR("%i.%i.%i.%i"), _iaqSensor.version.major, _iaqSensor.version.minor, _iaqSensor.version.major_bugfix, _iaqSensor.version.minor_bugfix);
+    cb(F("BSEC"), tmp);
+    sprintf_P(val, PSTR(" %#x"), _address);
+    cb(F("Address"), val);
+    cb(F("Id"), _id);
+    FormatFixed(val, ToFixed(_trim, 2), 2);
+    cb(F("Subtract Trim (C) "), val);
+    _state.Describe(val, sizeof(val));
+    cb(F("Saved State"), val);
+    _state.DescribeRestore(val, sizeof(val));
+    cb(F("Restored State"), val);
+    _state.DescribeWrites(val, sizeof(val));
+    cb(F("State Writes"), val);
 
     if (!_lastReadingValid)
     {
         if (_iaqSensor.status != BSEC_OK || _iaqSensor.bme680Status != BME680_OK)
         {
-            sprintf(val, "status:%d - bme680Status:%d", _iaqSensor.status, _iaqSensor.bme680Status);
-            cb("ERROR", val);
+            sprintf_P(val, PSTR("status:%d - bme680Status:%d"), _iaqSensor.status, _iaqSensor.bme680Status);
+            cb(F("ERROR"), val);
         }
         else
-            cb("ERROR", InsaneTemprature);
+            cb(F("ERROR"), strcpy_P(val, InsaneTemprature));
         return;
     }
 
-    cb("Temprature (C)", dtostrf((double)_lastTemp, 1, 4, val));
-    cb("Pressure (mb)", dtostrf((double)_lastPressure / 100, 1, 2, val));
-    cb("Humidity (%)", dtostrf((double)_lastHumidity, 1, 2, val));
-
-    const char *description = "";
-    if (_lastIaq < 51)
-        description = "Excellent";
-    else if (_lastIaq < 101)
-        description = "Good";
-    else if (_lastIaq < 151)
-        description = "Lightly Polluted";
-    else if (_lastIaq < 201)
-        description = "Moderately Polluted";
-    else if (_lastIaq < 251)
-        description = "Heavily Polluted";
-    else if (_lastIaq < 351)
-        description = "Severely Polluted";
-    else
-        description = "Extremely Polluted";
-    sprintf(tmp, "%s (%s)", dtostrf((double)_lastIaq, 1, 0, val), description);
-    cb("Air Quality (0-500)", tmp);
-
-    description = "ERROR";
-    if (_lastIaqAccuracy < 1)
-        description = "Just Started";
-    else if (_lastIaqAccuracy < 2)
-        description = "History Uncertain";
-    else if (_lastIaqAccuracy < 3)
-        description = "Calibrating...";
-    else if (_lastIaqAccuracy < 4)
-        description = "Calibrated";
-    sprintf(tmp, "%s (%s)", itoa(_lastIaqAccuracy, val, 10), description);
-    cb("Air Quality Accuracy (0-3)", tmp);
-
-    cb("CO2 Estimate (ppm)", dtostrf((double)_lastCo2Equivalent, 1, 2, val));
+    EncodeValues(cb, schema, _lastReadings);
 }
 
 void Bme680Driver::Recalibrate()
 {
-    LittleFS.remove(_id);
+    _state.Clear();
+}
+
+int Bme680Driver::GetReadings(const Measurement **schemaOut, const int32_t **values)
+{
+    *schemaOut = schema;
+    *values = _lastReadings;
+    return sizeof(schema) / sizeof(schema[0]);
 }
 
 // *** PRIVATE ***
 
-Bme680Driver::Bme680Driver(TwoWire *i2c, int address, const char *prefix, float trim)
+Bme680Driver::Bme680Driver(I2cBus *bus, int address, const char *prefix, int rtcSlot, float trim)
 {
-    _i2c = i2c;
+    _bus = bus;
+    _i2c = bus->GetWire();
     _address = address;
+    // BSEC does its own filtering, so only range checks
+    for (int i = 0; i < BME680_READINGS; i++)
+        _filters[i].Begin(&schema[i]);
 
     // Unique id is BM - ESP8266 id
-    sprintf(_id, "%s%x", prefix, ESP.getChipId());
+    sprintf_P(_id, PSTR("%s%x"), prefix, ESP.getChipId());
 
     // Configure the sensor with operational data
     _iaqSensor.setConfig(bsec_config_iaq);
@@ -208,7 +170,7 @@ Bme680Driver::Bme680Driver(TwoWire *i2c, int address, const char *prefix, float
     _trim = trim;
     _iaqSensor.setTemperatureOffset(trim);
     _iaqSensor.begin(_address, *_i2c);
-    IsBadStatus("begin()");
+    IsBadStatus(PSTR("begin()"));
     bsec_virtual_sensor_t sensorList[6] = {
         BSEC_OUTPUT_STATIC_IAQ,
         BSEC_OUTPUT_CO2_EQUIVALENT,
@@ -217,29 +179,134 @@ Bme680Driver::Bme680Driver(TwoWire *i2c, int address, const char *prefix, float
         BSEC_OUTPUT_RAW_PRESSURE,
         BSEC_OUTPUT_STABILIZATION_STATUS};
     _iaqSensor.updateSubscription(sensorList, 6, BSEC_SAMPLE_RATE_LP);
-    IsBadStatus("updateSubscription()");
+    IsBadStatus(PSTR("updateSubscription()"));
 
-    // Load last state if available (air quality history)
-    File f = LittleFS.open(_id, "r");
-    if (f)
+    // Restore the newest valid state (air quality history)
+    _state.Begin(_id, rtcSlot);
+    uint8_t bsecState[BSEC_MAX_STATE_BLOB_SIZE];
+    if (_state.Restore(bsecState))
     {
-        uint8_t bsecState[BSEC_MAX_STATE_BLOB_SIZE] = {0};
-        f.readBytes((char *)&bsecState, BSEC_MAX_STATE_BLOB_SIZE);
-        f.close();
-        Serial.println("Setting saved BME680 state");
         _iaqSensor.setState(bsecState);
-        IsBadStatus("setState()");
+        IsBadStatus(PSTR("setState()"));
     }
 }
 
-bool Bme680Driver::IsBadStatus(const char *str)
+// Bus slot granted
+void Bme680Driver::OnRun(void *context, uint8_t status, const uint8_t *data, uint8_t len)
+{
+    Bme680Driver *driver = (Bme680Driver *)context;
+    driver->_runQueued = false;
+    driver->Run();
+}
+
+void Bme680Driver::Run()
+{
+    unsigned long start = micros();
+    if (_iaqSensor.run())
+    {
+        _health.Success(micros() - start);
+        _generation++;
+        int32_t raw[BME680_READINGS];
+        raw[BME680_TEMP] = ToFixed(_iaqSensor.temperature, schema[BME680_TEMP].decimals);
+        raw[BME680_PRESSURE] = ToFixed(_iaqSensor.pressure, 0);
+        raw[BME680_HUMIDITY] = ToFixed(_iaqSensor.humidity, schema[BME680_HUMIDITY].decimals);
+        raw[BME680_IAQ] = ToFixed(_iaqSensor.staticIaq, schema[BME680_IAQ].decimals);
+        raw[BME680_ACCURACY] = _iaqSensor.staticIaqAccuracy;
+        raw[BME680_CO2] = ToFixed(_iaqSensor.co2Equivalent, schema[BME680_CO2].decimals);
+
+        // Sanity check, every reading has to be in range. All are kept or
+        // none, so the readings are always from the same run
+        int32_t filtered[BME680_READINGS];
+        _lastReadingValid = true;
+        for (int i = 0; i < BME680_READINGS; i++)
+            if (_filters[i].Add(raw[i], &filtered[i]) != FILTER_PASSED)
+                _lastReadingValid = false;
+        if (_lastReadingValid)
+            memcpy(_lastReadings, filtered, sizeof(_lastReadings));
+
+        // Debug output
+        Serial.print(_id);
+        Serial.println(F(" updated"));
+
+        // Save state if accuracy is 3 and haven't saved it for a while
+        if (_lastReadings[BME680_ACCURACY] == 3 &&
+            ((_lastRtcSaveMs == 0) || ((unsigned long)(millis() - _lastRtcSaveMs) >= RTC_SAVE_PERIOD_MS)))
+        {
+            bool toFlash = (_lastSaveMs == 0) || ((unsigned long)(millis() - _lastSaveMs) >= SAVE_PERIOD_MS);
+            uint8_t bsecState[BSEC_MAX_STATE_BLOB_SIZE] = {0};
+            _iaqSensor.getState(bsecState);
+            if (!IsBadStatus(PSTR("getState()")))
+                _state.Save(bsecState, toFlash);
+            // Save again in a while
+            _lastRtcSaveMs = millis();
+            if (toFlash)
+                _lastSaveMs = millis();
+        }
+    }
+    // run() also returns false when there was nothing new, which leaves
+    // the last reading as it was
+    else if (IsBadStatus(PSTR("Handle()")))
+    {
+        if (_lastReadingValid)
+            _generation++;
+        _lastReadingValid = false;
+        _health.Failure();
+    }
+}
+
+// Same 64 bit millisecond time base BSEC uses for nextCall
+int64_t Bme680Driver::GetTimeMs()
+{
+    uint32_t timeMs = millis();
+    if (_lastTimeMs > timeMs)
+        _millisOverflowCounter++;
+    _lastTimeMs = timeMs;
+    return timeMs + ((int64_t)_millisOverflowCounter << 32);
+}
+
+// str is in flash
+bool Bme680Driver::IsBadStatus(PGM_P str)
 {
     if (_iaqSensor.status != BSEC_OK || _iaqSensor.bme680Status != BME680_OK)
     {
-        char msg[256];
-        sprintf(msg, "%s status:%d bme680Status:%d wireStatus:%d", str, _iaqSensor.status, _iaqSensor.bme680Status, _i2c->status());
-        Serial.println(msg);
+        Serial.print(FPSTR(str));
+        Serial.printf_P(PSTR(" status:%d bme680Status:%d wireStatus:%d\n"), _iaqSensor.status, _iaqSensor.bme680Status, _i2c->status());
+        // Logged when it starts failing, not on every retry
+        if (!_errorLogged)
+            eventLog.Add(EVENT_SENSOR_ERROR, _address, (int16_t)(_iaqSensor.status << 8 | (uint8_t)_iaqSensor.bme680Status));
+        _errorLogged = true;
         return true;
     }
+    _errorLogged = false;
     return false;
 }
+
+static PGM_P DescribeIaq(int32_t iaq)
+{
+    if (iaq < 51)
+        return PSTR("Excellent");
+    if (iaq < 101)
+        return PSTR("Good");
+    if (iaq < 151)
+        return PSTR("Lightly Polluted");
+    if (iaq < 201)
+        return PSTR("Moderately Polluted");
+    if (iaq < 251)
+        return PSTR("Heavily Polluted");
+    if (iaq < 351)
+        return PSTR("Severely Polluted");
+    return PSTR("Extremely Polluted");
+}
+
+static PGM_P DescribeAccuracy(int32_t accuracy)
+{
+    if (accuracy < 1)
+        return PSTR("Just Started");
+    if (accuracy < 2)
+        return PSTR("History Uncertain");
+    if (accuracy < 3)
+        return PSTR("Calibrating...");
+    if (accuracy < 4)
+        return PSTR("Calibrated");
+    return PSTR("ERROR");
+}
@@ -0,0 +1,259 @@
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <coredecls.h>
+#include <user_interface.h>
+#include <bsec_state.h>
+
+// RTC memory is written in 4 byte blocks
+#define RTC_BLOCKS ((sizeof(BsecStateHeader) + BSEC_MAX_STATE_BLOB_SIZE + 3) / 4)
+static_assert(BSEC_STATE_RTC_FIRST_BLOCK + BSEC_STATE_RTC_SLOTS * RTC_BLOCKS <= 128, "BSEC state doesn't fit RTC memory");
+
+extern struct rst_info resetInfo;
+
+// Sequence numbers wrap
+static bool isNewer(uint32_t a, uint32_t b)
+{
+    return (int32_t)(a - b) > 0;
+}
+
+// *** PUBLIC ***
+
+void BsecState::Begin(const char *name, int rtcSlot)
+{
+    _name = name;
+    _rtcSlot = rtcSlot;
+}
+
+bool BsecState::Restore(uint8_t *blob)
+{
+    unsigned long start = micros();
+    BsecStateHeader header;
+    uint8_t candidate[BSEC_MAX_STATE_BLOB_SIZE];
+    for (int slot = 0; slot < 2; slot++)
+    {
+        if (!ReadFlash(slot, &header, candidate))
+            continue;
+        if (_flashSlot < 0 || isNewer(header.sequence, _flashSequence))
+        {
+            _flashSlot = slot;
+            _flashSequence = header.sequence;
+            _flashBlobCrc = crc32(candidate, BSEC_MAX_STATE_BLOB_SIZE);
+            memcpy(blob, candidate, BSEC_MAX_STATE_BLOB_SIZE);
+            _restoredFrom = BSEC_STATE_FLASH;
+            _restoredSequence = header.sequence;
+        }
+    }
+
+    // RTC memory holds nothing after power on, the CRC catches the rest
+    if (resetInfo.reason != REASON_DEFAULT_RST && ReadRtc(&header, candidate))
+    {
+        _rtcValid = true;
+        _rtcSequence = header.sequence;
+        _rtcBlobCrc = crc32(candidate, BSEC_MAX_STATE_BLOB_SIZE);
+        if (_flashSlot < 0 || isNewer(header.sequence, _flashSequence))
+        {
+            memcpy(blob, candidate, BSEC_MAX_STATE_BLOB_SIZE);
+            _restoredFrom = BSEC_STATE_RTC;
+            _restoredSequence = header.sequence;
+        }
+    }
+    _sequence = _rtcValid && isNewer(_rtcSequence, _flashSequence) ? _rtcSequence : _flashSequence;
+
+    // The unchecked file from before the A/B slots, it goes once a slot
+    // has been written
+    if (_restoredFrom == BSEC_STATE_NONE)
+    {
+        File f = LittleFS.open(_name, "r");
+        if (f && f.size() == BSEC_MAX_STATE_BLOB_SIZE && f.read(blob, BSEC_MAX_STATE_BLOB_SIZE) == BSEC_MAX_STATE_BLOB_SIZE)
+        {
+            _legacy = true;
+            _restoredFrom = BSEC_STATE_LEGACY;
+        }
+        if (f)
+            f.close();
+    }
+
+    _restoreMicros = micros() - start;
+    if (_restoredFrom == BSEC_STATE_NONE)
+        return false;
+    char description[40];
+    DescribeRestore(description, sizeof(description));
+    Serial.printf_P(PSTR("%s state restored from %s\n"), _name, description);
+    return true;
+}
+
+void BsecState::Save(const uint8_t *blob, bool toFlash)
+{
+    uint32_t crc = crc32(blob, BSEC_MAX_STATE_BLOB_SIZE);
+    if (_rtcValid && crc == _rtcBlobCrc)
+        _unchanged++;
+    else
+        WriteRtc(blob, crc);
+
+    if (!toFlash)
+        return;
+    if (_flashSlot >= 0 && crc == _flashBlobCrc)
+        _unchanged++;
+    else
+        WriteFlash(blob, crc);
+}
+
+void BsecState::Clear()
+{
+    char name[24];
+    for (int slot = 0; slot < 2; slot++)
+    {
+        SlotName(slot, name);
+        LittleFS.remove(name);
+    }
+    LittleFS.remove(_name);
+    uint32_t blocks[RTC_BLOCKS] = {0};
+    ESP.rtcUserMemoryWrite(BSEC_STATE_RTC_FIRST_BLOCK + _rtcSlot * RTC_BLOCKS, blocks, sizeof(blocks));
+    _flashSlot = -1;
+    _rtcValid = false;
+    _legacy = false;
+}
+
+int BsecState::Describe(char *buf, int size)
+{
+    int n;
+    if (_flashSlot >= 0 && _rtcValid)
+        n = snprintf_P(buf, size, PSTR("flash %u (slot %i), RTC %u"), _flashSequence, _flashSlot, _rtcSequence);
+    else if (_flashSlot >= 0)
+        n = snprintf_P(buf, size, PSTR("flash %u (slot %i)"), _flashSequence, _flashSlot);
+    else if (_rtcValid)
+        n = snprintf_P(buf, size, PSTR("RTC %u"), _rtcSequence);
+    else
+        n = snprintf_P(buf, size, _legacy ? PSTR("unchecked file") : PSTR("NO"));
+    return min(max(n, 0), size - 1);
+}
+
+int BsecState::DescribeRestore(char *buf, int size)
+{
+    int n;
+    switch (_restoredFrom)
+    {
+    case BSEC_STATE_FLASH:
+        n = snprintf_P(buf, size, PSTR("flash %u in %u us"), _restoredSequence, _restoreMicros);
+        break;
+    case BSEC_STATE_RTC:
+        n = snprintf_P(buf, size, PSTR("RTC %u in %u us"), _restoredSequence, _restoreMicros);
+        break;
+    case BSEC_STATE_LEGACY:
+        n = snprintf_P(buf, size, PSTR("unchecked file in %u us"), _restoreMicros);
+        break;
+    default:
+        n = snprintf_P(buf, size, PSTR("NO"));
+        break;
+    }
+    return min(max(n, 0), size - 1);
+}
+
+int BsecState::DescribeWrites(char *buf, int size)
+{
+    int n = snprintf_P(buf, size, PSTR("flash %u, RTC %u, unchanged %u"), _flashWrites, _rtcWrites, _unchanged);
+    return min(max(n, 0), size - 1);
+}
+
+// *** PRIVATE ***
+
+bool BsecState::ReadFlash(int slot, BsecStateHeader *header, uint8_t *blob)
+{
+    char name[24];
+    SlotName(slot, name);
+    File f = LittleFS.open(name, "r");
+    if (!f)
+        return false;
+    bool read = f.read((uint8_t *)header, sizeof(*header)) == sizeof(*header) &&
+                header->length == BSEC_MAX_STATE_BLOB_SIZE &&
+                f.read(blob, BSEC_MAX_STATE_BLOB_SIZE) == BSEC_MAX_STATE_BLOB_SIZE;
+    f.close();
+    if (read && IsValid(header, blob))
+        return true;
+    Serial.printf_P(PSTR("%s is corrupt\n"), name);
+    return false;
+}
+
+bool BsecState::ReadRtc(BsecStateHeader *header, uint8_t *blob)
+{
+    uint32_t blocks[RTC_BLOCKS];
+    if (!ESP.rtcUserMemoryRead(BSEC_STATE_RTC_FIRST_BLOCK + _rtcSlot * RTC_BLOCKS, blocks, sizeof(blocks)))
+        return false;
+    memcpy(header, blocks, sizeof(*header));
+    if (header->length != BSEC_MAX_STATE_BLOB_SIZE)
+        return false;
+    memcpy(blob, (uint8_t *)blocks + sizeof(*header), BSEC_MAX_STATE_BLOB_SIZE);
+    return IsValid(header, blob);
+}
+
+// Into the slot not holding the newest copy
+void BsecState::WriteFlash(const uint8_t *blob, uint32_t blobCrc)
+{
+    int slot = _flashSlot < 0 ? 0 : 1 - _flashSlot;
+    BsecStateHeader header;
+    Seal(&header, ++_sequence, blob);
+    char name[24];
+    SlotName(slot, name);
+    File f = LittleFS.open(name, "w");
+    if (!f)
+        return;
+    bool written = f.write((const uint8_t *)&header, sizeof(header)) == sizeof(header) &&
+                   f.write(blob, BSEC_MAX_STATE_BLOB_SIZE) == BSEC_MAX_STATE_BLOB_SIZE;
+    f.close();
+    if (!written)
+    {
+        Serial.printf_P(PSTR("%s write failed\n"), name);
+        return;
+    }
+    _flashSlot = slot;
+    _flashSequence = header.sequence;
+    _flashBlobCrc = blobCrc;
+    _flashWrites++;
+    if (_legacy)
+    {
+        LittleFS.remove(_name);
+        _legacy = false;
+    }
+}
+
+void BsecState::WriteRtc(const uint8_t *blob, uint32_t blobCrc)
+{
+    uint32_t blocks[RTC_BLOCKS] = {0};
+    BsecStateHeader header;
+    Seal(&header, ++_sequence, blob);
+    memcpy(blocks, &header, sizeof(header));
+    memcpy((uint8_t *)blocks + sizeof(header), blob, BSEC_MAX_STATE_BLOB_SIZE);
+    if (!ESP.rtcUserMemoryWrite(BSEC_STATE_RTC_FIRST_BLOCK + _rtcSlot * RTC_BLOCKS, blocks, sizeof(blocks)))
+        return;
+    _rtcValid = true;
+    _rtcSequence = header.sequence;
+    _rtcBlobCrc = blobCrc;
+    _rtcWrites++;
+}
+
+void BsecState::SlotName(int slot, char *name)
+{
+    sprintf_P(name, PSTR("%s.%i"), _name, slot);
+}
+
+// The CRC covers the header, with crc 0, and the blob
+void BsecState::Seal(BsecStateHeader *header, uint32_t sequence, const uint8_t *blob)
+{
+    header->magic = BSEC_STATE_MAGIC;
+    header->version = BSEC_STATE_VERSION;
+    header->length = BSEC_MAX_STATE_BLOB_SIZE;
+    header->sequence = sequence;
+    header->crc = 0;
+    header->crc = crc32(blob, BSEC_MAX_STATE_BLOB_SIZE, crc32(header, sizeof(*header)));
+}
+
+bool BsecState::IsValid(BsecStateHeader *header, const uint8_t *blob)
+{
+    if (header->magic != BSEC_STATE_MAGIC || header->version != BSEC_STATE_VERSION)
+        return false;
+    uint32_t crc = header->crc;
+    header->crc = 0;
+    bool valid = crc32(blob, BSEC_MAX_STATE_BLOB_SIZE, crc32(header, sizeof(*header))) == crc;
+    header->crc = crc;
+    return valid;
+}
@@ -0,0 +1,101 @@
+#include <Arduino.h>
+#include <chunk_writer.h>
+
+// *** PUBLIC ***
+
+ChunkWriter::ChunkWriter(ESP8266WebServer *server)
+{
+    _server = server;
+}
+
+// Send the response headers, content follows as chunks
+void ChunkWriter::Begin(int code, const char *contentType)
+{
+    _len = 0;
+    _server->setContentLength(CONTENT_LENGTH_UNKNOWN);
+    _server->send(code, contentType, "");
+}
+
+void ChunkWriter::Write(const char *str)
+{
+    Write(str, strlen(str));
+}
+
+void ChunkWriter::Write(const char *str, size_t len)
+{
+    while (len > 0)
+    {
+        if (_len == CHUNK_SIZE)
+            Flush();
+        size_t n = CHUNK_SIZE - _len;
+        if (n > len)
+            n = len;
+        memcpy(&_buf[_len], str, n);
+        _len += n;
+        str += n;
+        len -= n;
+    }
+}
+
+// Copies a string from flash
+void ChunkWriter::Write_P(PGM_P str)
+{
+    size_t len = strlen_P(str);
+    while (len > 0)
+    {
+        if (_len == CHUNK_SIZE)
+            Flush();
+        size_t n = CHUNK_SIZE - _len;
+        if (n > len)
+            n = len;
+        memcpy_P(&_buf[_len], str, n);
+        _len += n;
+        str += n;
+        len -= n;
+    }
+}
+
+// Formats directly into the chunk buffer, flushing first if the
+// output doesn't fit in what is left. Output longer than a whole
+// chunk is truncated. The format is in flash, arguments in RAM
+void ChunkWriter::Printf_P(PGM_P format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    VPrintf_P(format, args);
+    va_end(args);
+}
+
+void ChunkWriter::VPrintf_P(PGM_P format, va_list args)
+{
+    va_list again;
+    va_copy(again, args);
+    int n = vsnprintf_P(&_buf[_len], CHUNK_SIZE - _len, format, args);
+    if (n >= 0 && (size_t)n >= CHUNK_SIZE - _len)
+    {
+        Flush();
+        n = vsnprintf_P(_buf, CHUNK_SIZE, format, again);
+        if (n >= CHUNK_SIZE)
+            n = CHUNK_SIZE - 1;
+    }
+    va_end(again);
+    if (n > 0)
+        _len += n;
+}
+
+// Send anything left over and terminate the chunked response
+void ChunkWriter::End()
+{
+    Flush();
+    _server->sendContent("");
+}
+
+// *** PRIVATE ***
+
+void ChunkWriter::Flush()
+{
+    if (_len == 0)
+        return;
+    _server->sendContent(_buf, _len);
+    _len = 0;
+}
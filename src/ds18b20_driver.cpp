@@ -1,11 +1,26 @@
 #include <Arduino.h>
 #include <ds18b20_driver.h>
+#include <arena.h>
+
+// temperature,id=ffb897721503 value=30.3750 (1/10000 C is exact for
+// the 1/16 C resolution). A 0.1 C deadband ignores one step of jitter
+static constexpr char temperatureName[] PROGMEM = "temperature";
+static constexpr char temperatureLabel[] PROGMEM = "Temprature (C)";
+static constexpr Measurement schema[] = {
+    {temperatureName, temperatureLabel, 4, MIN_SANE_VALUE * 10000, MAX_SANE_VALUE * 10000, nullptr, 1000, 0}};
+static_assert(MaxLineProtocolLength(schema) <= MAX_PACKET_DATA, "DS18B20 packet data too long");
+
+// Single bad conversions (85 C after a brown out, a bit flip the CRC
+// missed) are replaced by the median of 3, counted past 2 C. Then
+// anything faster than 0.25 C/s is held back unless it lasts 3 readings
+static constexpr FilterStage filters[] = {{FILTER_MEDIAN, 3, 20000}, {FILTER_RATE, 3, 2500}};
 
 // *** PUBLIC ***
 
 // Scan for devices and create a driver for each found device
-int Ds18b20Driver::CreateDriverInstances(OneWire *wire, SensorDriver *firstInstance[], int maxInstances)
+int Ds18b20Driver::CreateDriverInstances(OneWireBus *bus, SensorDriver *firstInstance[], int maxInstances)
 {
+    OneWire *wire = bus->GetWire();
     int instances = 0;
     byte addr[8];
     while ((instances < maxInstances) && wire->search(addr))
@@ -13,47 +28,89 @@ int Ds18b20Driver::CreateDriverInstances(OneWire *wire, SensorDriver *firstInsta
         // Check CRC
         if (OneWire::crc8(addr, 7) != addr[7])
         {
-            Serial.println("CRC invalid");
+            Serial.println(F("CRC invalid"));
             continue;
         }
 
         // Ignore devices that arn't 18B20
         if (addr[0] != 0x28)
         {
-            Serial.println("Ignoring unknown OneWire device");
+            Serial.println(F("Ignoring unknown OneWire device"));
             continue;
         }
 
-        // Create a driver for this device
-        firstInstance[instances++] = new Ds18b20Driver(wire, addr);
+        if (bus->IsFull())
+        {
+            Serial.println(F("Too many OneWire devices"));
+            break;
+        }
+
+        // Create a driver for this device, the bus reads it for us
+        void *p = driverArena.Allocate(sizeof(Ds18b20Driver), alignof(Ds18b20Driver));
+        if (p == nullptr)
+            break;
+        Ds18b20Driver *driver = new (p) Ds18b20Driver(addr);
+        bus->Register(addr, OnScratchpad, driver, driver->GetHealth());
+        firstInstance[instances++] = driver;
     }
     return instances;
 }
 
 int Ds18b20Driver::GetPacketData(char *ptr)
 {
-    char t[16];
-    dtostrf((double)_lastReadingCelsius, 1, 4, t);
-    // temperature,id=ffb897721503 value=30.3750
-    return sprintf(ptr, "temperature,id=%s value=%s\n", _id, t);
+    return EncodeLineProtocol(ptr, schema, _id, &_lastReadingCelsius);
 }
 
-void Ds18b20Driver::Handle()
+// Conversions are broadcast to all the probes by OneWireBus, which also
+// records the reads in _health
+uint32_t Ds18b20Driver::Handle()
 {
-    // Take a temprature reading every 5 seconds
-    if ((unsigned long)(millis() - _lastPollMillis) < 5000)
+    return SENSOR_POLL_MS;
+}
+
+void Ds18b20Driver::GetValues(void cb(const __FlashStringHelper *, const char *))
+{
+    char val[64];
+    // Call back with name value pairs
+    cb(F("Device"), strcpy_P(val, PSTR("DS18B20")));
+    cb(F("Id"), _id);
+
+    if (!_lastReadingValid)
+    {
+        cb(F("ERROR"), strcpy_P(val, InsaneTemprature));
         return;
+    }
+
+    EncodeValues(cb, schema, &_lastReadingCelsius);
+}
+
+int Ds18b20Driver::GetReadings(const Measurement **schemaOut, const int32_t **values)
+{
+    *schemaOut = schema;
+    *values = &_lastReadingCelsius;
+    return sizeof(schema) / sizeof(schema[0]);
+}
 
-    _lastPollMillis = millis();
+// *** PRIVATE ***
 
-    // 1) Read result of conversion
-    _wire->reset();
-    _wire->select(_address);
-    _wire->write(0xBE); // Read Scratchpad
-    byte data[12];
-    for (int i = 0; i < 9; i++)
-    { // we need 9 bytes
-        data[i] = _wire->read();
+// Construct a driver for a 18B20 device at address
+Ds18b20Driver::Ds18b20Driver(byte address[8])
+{
+    memcpy(_address, address, 8);
+    _filter.Begin(&schema[0], filters, _filterState);
+    for (int i = 0; i < 6; i++)
+        sprintf_P(&_id[i * 2], PSTR("%02x"), address[i + 1]);
+}
+
+// Scratchpad read after a broadcast conversion
+void Ds18b20Driver::OnScratchpad(void *context, bool valid, const uint8_t *data)
+{
+    Ds18b20Driver *driver = (Ds18b20Driver *)context;
+    if (!valid)
+    {
+        driver->_generation++;
+        driver->_lastReadingValid = false;
+        return;
     }
 
     // Convert the data to actual temperature
@@ -70,44 +127,14 @@ void Ds18b20Driver::Handle()
     else if (cfg == 0x40)
         raw = raw & ~1; // 11 bit res, 375 ms
     // default is 12 bit resolution, 750 ms conversion time
-    _lastReadingCelsius = (float)raw / 16.0;
-
-    // Sanity check
-    _lastReadingValid = _lastReadingCelsius >= MIN_SANE_VALUE && _lastReadingCelsius <= MAX_SANE_VALUE;
-
-    // 2) Start next conversion
-    _wire->reset();
-    _wire->select(_address);
-    _wire->write(0x44, 0);
-
-    // 3) Debug output
-    Serial.print(_id);
-    Serial.println(" updated");
-}
-
-void Ds18b20Driver::GetValues(void cb(const char *, const char *))
-{
-    char val[64];
-    // Call back with name value pairs
-    cb("Device", "DS18B20");
-    cb("Id", _id);
-
-    if (!_lastReadingValid)
-    {
-        cb("ERROR", InsaneTemprature);
+    // 1/16 C, a rejected glitch keeps the last reading
+    FilterResult result = driver->_filter.Add((int32_t)raw * 625, &driver->_lastReadingCelsius);
+    if (result == FILTER_REJECTED || result == FILTER_PENDING)
         return;
-    }
-
-    cb("Temprature (C)", dtostrf((double)_lastReadingCelsius, 1, 4, val));
-}
+    driver->_generation++;
+    driver->_lastReadingValid = result == FILTER_PASSED;
 
-// *** PRIVATE ***
-
-// Construct a driver for a 18B20 device at address
-Ds18b20Driver::Ds18b20Driver(OneWire *wire, byte address[8])
-{
-    _wire = wire;
-    memcpy(_address, address, 8);
-    for (int i = 0; i < 6; i++)
-        sprintf(&_id[i * 2], "%02x", address[i + 1]);
+    // Debug output
+    Serial.print(driver->_id);
+    Serial.println(F(" updated"));
 }
@@ -0,0 +1,179 @@
+#include <Arduino.h>
+#include <coredecls.h>
+#include <ezTime.h>
+#include <event_log.h>
+
+#define CRC_BYTES offsetof(EventRecord, crc)
+static_assert(sizeof(EventRecord) == 20, "EventRecord has padding");
+
+// Sequences start at 1, the first record of segment n is n * records + 1
+static uint32_t segmentOf(uint32_t sequence)
+{
+    return (sequence - 1) / EVENT_LOG_SEGMENT_RECORDS;
+}
+
+static uint32_t indexOf(uint32_t sequence)
+{
+    return (sequence - 1) % EVENT_LOG_SEGMENT_RECORDS;
+}
+
+static uint32_t firstOf(uint32_t segment)
+{
+    return segment * EVENT_LOG_SEGMENT_RECORDS + 1;
+}
+
+// *** PUBLIC ***
+
+void EventLog::Begin()
+{
+    uint32_t last = 0;
+    size_t lastSize = 0;
+    bool found = false;
+    Dir dir = LittleFS.openDir(EVENT_LOG_DIR);
+    while (dir.next())
+    {
+        uint32_t segment = strtoul(dir.fileName().c_str(), nullptr, 16);
+        if (!found || firstOf(segment) < _first)
+            _first = firstOf(segment);
+        if (!found || segment >= last)
+        {
+            last = segment;
+            lastSize = dir.fileSize();
+        }
+        found = true;
+    }
+
+    // Carry on where the last segment ends, or with a new segment if a
+    // restart cut a record short
+    if (found)
+    {
+        if (lastSize % sizeof(EventRecord) == 0 && lastSize / sizeof(EventRecord) < EVENT_LOG_SEGMENT_RECORDS)
+            _next = firstOf(last) + lastSize / sizeof(EventRecord);
+        else
+            _next = firstOf(last + 1);
+    }
+    _begun = true;
+    Serial.printf_P(PSTR("Event log has events %u to %u\n"), _first, _next - 1);
+}
+
+void EventLog::Add(EventType type, uint8_t arg, int16_t value)
+{
+    if (!_begun)
+        return;
+    EventRecord record;
+    record.sequence = _next;
+    record.time = timeStatus() != timeNotSet ? (uint32_t)now() : 0;
+    record.uptimeMs = millis();
+    record.type = type;
+    record.arg = arg;
+    record.value = value;
+    record.crc = crc32(&record, CRC_BYTES);
+
+    // Drop the oldest segment when starting one that would be too many
+    uint32_t segment = segmentOf(_next);
+    char name[24];
+    if (indexOf(_next) == 0 && segment >= EVENT_LOG_SEGMENTS)
+    {
+        uint32_t oldest = segment - EVENT_LOG_SEGMENTS;
+        for (uint32_t s = segmentOf(_first); s <= oldest; s++)
+        {
+            SegmentName(s, name);
+            LittleFS.remove(name);
+        }
+        _first = max(_first, firstOf(oldest + 1));
+    }
+
+    SegmentName(segment, name);
+    File f = LittleFS.open(name, "a");
+    if (!f)
+        return;
+    f.write((const uint8_t *)&record, sizeof(record));
+    f.close();
+    _next++;
+}
+
+int EventLog::Read(uint32_t before, EventRecord *records, int max)
+{
+    if (before == 0 || before > _next)
+        before = _next;
+    File f;
+    uint32_t segment = UINT32_MAX;
+    int count = 0;
+    for (uint32_t sequence = before; sequence > _first && count < max;)
+    {
+        sequence--;
+        if (ReadRecord(&f, &segment, sequence, &records[count]))
+            count++;
+        // Nothing more in a segment that is missing
+        else if (!f)
+            sequence -= indexOf(sequence);
+    }
+    if (f)
+        f.close();
+    return count;
+}
+
+PGM_P EventLog::GetTypeName(uint8_t type)
+{
+    switch (type)
+    {
+    case EVENT_BOOT:
+        return PSTR("boot");
+    case EVENT_CLOCK_SET:
+        return PSTR("clock_set");
+    case EVENT_TIME_SYNC_FAILED:
+        return PSTR("time_sync_failed");
+    case EVENT_TIME_ZONE_FAILED:
+        return PSTR("time_zone_failed");
+    case EVENT_WIFI_CONNECTED:
+        return PSTR("wifi_connected");
+    case EVENT_WIFI_DISCONNECTED:
+        return PSTR("wifi_disconnected");
+    case EVENT_SENSOR_ERROR:
+        return PSTR("sensor_error");
+    case EVENT_OTA_START:
+        return PSTR("ota_start");
+    case EVENT_OTA_END:
+        return PSTR("ota_end");
+    case EVENT_OTA_ERROR:
+        return PSTR("ota_error");
+    default:
+        return PSTR("unknown");
+    }
+}
+
+// *** PRIVATE ***
+
+// f is kept open on segment between calls
+bool EventLog::ReadRecord(File *f, uint32_t *segment, uint32_t sequence, EventRecord *record)
+{
+    if (segmentOf(sequence) != *segment)
+    {
+        if (*f)
+            f->close();
+        *segment = segmentOf(sequence);
+        char name[24];
+        SegmentName(*segment, name);
+        *f = LittleFS.open(name, "r");
+    }
+    if (!*f)
+        return false;
+
+    // Past the end of a segment cut short by a restart
+    uint32_t offset = indexOf(sequence) * sizeof(EventRecord);
+    if (offset + sizeof(EventRecord) > f->size())
+        return false;
+    f->seek(offset);
+    if (f->read((uint8_t *)record, sizeof(EventRecord)) != sizeof(EventRecord) ||
+        record->sequence != sequence || crc32(record, CRC_BYTES) != record->crc)
+    {
+        _corruptRecords++;
+        return false;
+    }
+    return true;
+}
+
+void EventLog::SegmentName(uint32_t segment, char *name)
+{
+    sprintf_P(name, PSTR(EVENT_LOG_DIR "/%08x"), segment);
+}
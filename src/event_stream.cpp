@@ -0,0 +1,218 @@
+#include <Arduino.h>
+#include <stdarg.h>
+#include "event_stream.h"
+
+static const char header[] PROGMEM =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: text/event-stream\r\n"
+    "Cache-Control: no-store\r\n"
+    "Connection: keep-alive\r\n"
+    "\r\n"
+    "retry: 5000\n\n";
+
+// Sent with the events so kept in RAM
+static const char keepalive[] = ":\n\n";
+
+// Appends to buf at len, returns the new length or size if it didn't fit
+static int append(char *buf, int len, int size, PGM_P format, ...)
+{
+    if (len >= size)
+        return size;
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf_P(&buf[len], size - len, format, args);
+    va_end(args);
+    return n < 0 || len + n >= size ? size : len + n;
+}
+
+// *** PUBLIC ***
+
+EventStream::EventStream(ESP8266WebServer *server)
+{
+    _server = server;
+    for (int i = 0; i < EVENT_STREAM_MAX_DRIVERS; i++)
+    {
+        _generations[i] = 0;
+        _sentValid[i] = false;
+    }
+}
+
+// EventSource gives up for good on an error reply, so when every slot
+// is taken the new client replaces an old one, likely a page that has
+// gone away without its connection closing
+void EventStream::Accept()
+{
+    Client *slot = nullptr;
+    for (Client &c : _clients)
+        if (!c.client.connected())
+        {
+            slot = &c;
+            break;
+        }
+    if (slot == nullptr)
+    {
+        slot = Oldest();
+        slot->client.stop();
+        _evicted++;
+    }
+    slot->client = _server->client();
+    slot->client.setNoDelay(true);
+    slot->client.write_P(header, sizeof(header) - 1);
+    slot->resync = true;
+    slot->stalledSince = 0;
+    slot->acceptedMillis = millis();
+    _lastWriteMillis = millis();
+}
+
+uint32_t EventStream::Handle(SensorDriver *drivers[], int count)
+{
+    Evict();
+    count = min(count, EVENT_STREAM_MAX_DRIVERS);
+    if (GetClientCount() == 0)
+    {
+        // Nothing to send, start from scratch when someone connects
+        for (int i = 0; i < count; i++)
+            _sentValid[i] = false;
+        return EVENT_STREAM_IDLE_MS;
+    }
+
+    // Changed readings to everyone who is up to date
+    for (int i = 0; i < count; i++)
+    {
+        uint32_t generation = drivers[i]->GetGeneration();
+        if (generation == _generations[i])
+            continue;
+        _generations[i] = generation;
+        int len = BuildEvent(drivers[i], i, false);
+        if (len == 0)
+            continue;
+        _events++;
+        for (Client &c : _clients)
+            if (c.client.connected() && !c.resync)
+                Send(&c, _event, len);
+    }
+
+    // Everything to the rest
+    for (Client &c : _clients)
+    {
+        if (!c.client.connected() || !c.resync)
+            continue;
+        c.resync = false;
+        for (int i = 0; i < count; i++)
+        {
+            int len = BuildEvent(drivers[i], i, true);
+            if (len > 0)
+                Send(&c, _event, len);
+        }
+    }
+
+    if ((unsigned long)(millis() - _lastWriteMillis) >= EVENT_STREAM_KEEPALIVE_MS)
+    {
+        for (Client &c : _clients)
+            if (c.client.connected())
+                Send(&c, keepalive, sizeof(keepalive) - 1);
+        _lastWriteMillis = millis();
+    }
+    return EVENT_STREAM_PERIOD_MS;
+}
+
+int EventStream::GetClientCount()
+{
+    int count = 0;
+    for (Client &c : _clients)
+        if (c.client.connected())
+            count++;
+    return count;
+}
+
+// *** PRIVATE ***
+
+// Builds the event for a driver's readings, all of them or just those
+// that changed since the last event. Returns 0 if there is nothing to
+// send, invalid readings are left for the status page to show
+int EventStream::BuildEvent(SensorDriver *driver, int index, bool all)
+{
+    const Measurement *schema;
+    const int32_t *values;
+    int count = min(driver->GetReadings(&schema, &values), EVENT_STREAM_MAX_READINGS);
+    if (!driver->IsLastReadingValid())
+    {
+        _sentValid[index] = false;
+        return 0;
+    }
+
+    int len = append(_event, 0, sizeof(_event), PSTR("data: {\"id\":\"%s\""), driver->GetId());
+    int fields = 0;
+    for (int i = 0; i < count; i++)
+    {
+        bool changed = !_sentValid[index] || values[i] != _sent[index][i];
+        _sent[index][i] = values[i];
+        if (!all && !changed)
+            continue;
+        char label[40], value[MEASUREMENT_MAX_TEXT];
+        strncpy_P(label, schema[i].label, sizeof(label) - 1);
+        label[sizeof(label) - 1] = '\0';
+        FormatValue(value, schema[i], values[i]);
+        len = append(_event, len, sizeof(_event), PSTR(",\"%s\":\"%s\""), label, value);
+        fields++;
+    }
+    _sentValid[index] = true;
+    len = append(_event, len, sizeof(_event), PSTR("}\n\n"));
+    if (fields == 0 || len >= (int)sizeof(_event))
+        return 0;
+    return len;
+}
+
+// Writes are all or nothing, a client without room misses the event
+// and is sent everything once it catches up
+void EventStream::Send(Client *c, const char *event, int len)
+{
+    if (c->client.availableForWrite() < (size_t)len)
+    {
+        c->resync = true;
+        if (c->stalledSince == 0)
+            c->stalledSince = max(millis(), 1UL);
+        return;
+    }
+    c->client.write((const uint8_t *)event, len);
+    c->stalledSince = 0;
+    _lastWriteMillis = millis();
+}
+
+// The client stalled longest, or if none are the one connected longest.
+// Clients send nothing after their request, so that is also the one
+// not heard from for longest
+EventStream::Client *EventStream::Oldest()
+{
+    Client *oldest = &_clients[0];
+    for (Client &c : _clients)
+    {
+        bool stalled = c.stalledSince != 0;
+        bool oldestStalled = oldest->stalledSince != 0;
+        if (stalled != oldestStalled)
+        {
+            if (stalled)
+                oldest = &c;
+            continue;
+        }
+        if (stalled ? (long)(c.stalledSince - oldest->stalledSince) < 0
+                    : (long)(c.acceptedMillis - oldest->acceptedMillis) < 0)
+            oldest = &c;
+    }
+    return oldest;
+}
+
+// Drops clients that have gone or stopped reading
+void EventStream::Evict()
+{
+    for (Client &c : _clients)
+    {
+        if (!c.client.connected())
+            continue;
+        if (c.stalledSince != 0 && (unsigned long)(millis() - c.stalledSince) >= EVENT_STREAM_STALL_MS)
+        {
+            c.client.stop();
+            _evicted++;
+        }
+    }
+}
@@ -0,0 +1,164 @@
+#include <Arduino.h>
+#include <filter.h>
+
+static int32_t distance(int32_t a, int32_t b)
+{
+    int64_t d = (int64_t)a - b;
+    return d < 0 ? (d < -INT32_MAX ? INT32_MAX : -d) : (d > INT32_MAX ? INT32_MAX : d);
+}
+
+// *** PUBLIC ***
+
+FilterResult FilterChain::Add(int32_t raw, int32_t *value)
+{
+    if (!IsMeasurementValid(*_measurement, raw))
+    {
+        _rangeRejects++;
+        return FILTER_OUT_OF_RANGE;
+    }
+
+    int32_t v = raw;
+    for (int i = 0; i < _stageCount; i++)
+    {
+        const FilterStage &stage = _stages[i];
+        int32_t in = v;
+        FilterResult result = FILTER_PASSED;
+        switch (stage.type)
+        {
+        case FILTER_MEDIAN:
+            result = Median(stage, &_state[i], &v);
+            // The median stands in for an outlier, count it
+            if (distance(in, v) > stage.limit)
+                _rejects[i]++;
+            break;
+        case FILTER_RATE:
+            result = Rate(stage, &_state[i], &v);
+            break;
+        case FILTER_EMA:
+            result = Ema(stage, &_state[i], &v);
+            break;
+        case FILTER_DECIMATE:
+            result = Decimate(stage, &_state[i], &v);
+            break;
+        }
+        if (result == FILTER_REJECTED)
+            _rejects[i]++;
+        if (result != FILTER_PASSED)
+            return result;
+    }
+    *value = v;
+    return FILTER_PASSED;
+}
+
+PGM_P FilterChain::GetStageName(int stage)
+{
+    if (stage < 0)
+        return PSTR("range");
+    switch (_stages[stage].type)
+    {
+    case FILTER_MEDIAN:
+        return PSTR("median");
+    case FILTER_RATE:
+        return PSTR("rate");
+    case FILTER_EMA:
+        return PSTR("ema");
+    default:
+        return PSTR("decimate");
+    }
+}
+
+int FilterChain::Describe(char *buf, int size)
+{
+    int len = 0;
+    for (int i = -1; i < _stageCount && len < size; i++)
+    {
+        char name[12];
+        strncpy_P(name, GetStageName(i), sizeof(name) - 1);
+        name[sizeof(name) - 1] = '\0';
+        int n = snprintf_P(&buf[len], size - len, PSTR("%s%s %u"), i < 0 ? "" : ", ", name, GetRejects(i));
+        len = min(len + max(n, 0), size - 1);
+    }
+    return len;
+}
+
+// *** PRIVATE ***
+
+void FilterChain::Begin(const Measurement *m, const FilterStage *stages, int count, FilterState *state)
+{
+    _measurement = m;
+    _stages = stages;
+    _state = state;
+    _stageCount = count;
+    if (state != nullptr)
+        memset(state, 0, count * sizeof(FilterState));
+}
+
+// window is a ring of the last n values, count how many it holds
+FilterResult FilterChain::Median(const FilterStage &stage, FilterState *s, int32_t *value)
+{
+    int n = stage.n < 1 ? 1 : min((int)stage.n, FILTER_MAX_WINDOW);
+    s->window[s->next] = *value;
+    s->next = (s->next + 1) % n;
+    if (s->count < n)
+        s->count++;
+
+    // Insertion sort of at most FILTER_MAX_WINDOW values
+    int32_t sorted[FILTER_MAX_WINDOW];
+    for (int i = 0; i < s->count; i++)
+    {
+        int32_t v = s->window[i];
+        int j = i;
+        for (; j > 0 && sorted[j - 1] > v; j--)
+            sorted[j] = sorted[j - 1];
+        sorted[j] = v;
+    }
+    *value = sorted[(s->count - 1) / 2];
+    return FILTER_PASSED;
+}
+
+// last and lastMillis are the last value passed, count is set once
+// there is one and next counts the rejects in a row
+FilterResult FilterChain::Rate(const FilterStage &stage, FilterState *s, int32_t *value)
+{
+    unsigned long now = millis();
+    if (s->count != 0)
+    {
+        // At least a second's worth, readings can arrive close together
+        unsigned long elapsed = max(now - s->lastMillis, 1000UL);
+        int64_t allowed = (int64_t)stage.limit * elapsed / 1000;
+        if (distance(*value, s->last) > allowed && ++s->next < stage.n)
+            return FILTER_REJECTED;
+    }
+    s->count = 1;
+    s->next = 0;
+    s->last = *value;
+    s->lastMillis = now;
+    return FILTER_PASSED;
+}
+
+// sum is the average scaled by 2^n
+FilterResult FilterChain::Ema(const FilterStage &stage, FilterState *s, int32_t *value)
+{
+    if (s->count == 0)
+    {
+        s->sum = *value * (1 << stage.n);
+        s->count = 1;
+    }
+    else
+        s->sum += *value - (s->sum >> stage.n);
+    *value = stage.n == 0 ? s->sum : (s->sum + (1 << (stage.n - 1))) >> stage.n;
+    return FILTER_PASSED;
+}
+
+// sum and count are the values since the last one passed
+FilterResult FilterChain::Decimate(const FilterStage &stage, FilterState *s, int32_t *value)
+{
+    s->sum += *value;
+    if (++s->count < stage.n)
+        return FILTER_PENDING;
+    int32_t n = s->count;
+    *value = (s->sum + (s->sum >= 0 ? n / 2 : -n / 2)) / n;
+    s->sum = 0;
+    s->count = 0;
+    return FILTER_PASSED;
+}
@@ -0,0 +1,36 @@
+#include <Arduino.h>
+#include <fixed_point.h>
+
+int32_t ToFixed(float value, uint8_t decimals)
+{
+    return lroundf(value * FixedScale(min(decimals, (uint8_t)FIXED_MAX_DECIMALS)));
+}
+
+int FormatFixed(char *buf, int32_t value, uint8_t decimals)
+{
+    decimals = min(decimals, (uint8_t)FIXED_MAX_DECIMALS);
+
+    // Digits least significant first, at least one before the point
+    char digits[10];
+    int count = 0;
+    uint32_t v = value < 0 ? -(uint32_t)value : value;
+    do
+    {
+        digits[count++] = '0' + v % 10;
+        v /= 10;
+    } while (v != 0);
+    while (count <= decimals)
+        digits[count++] = '0';
+
+    char *p = buf;
+    if (value < 0)
+        *p++ = '-';
+    while (count > 0)
+    {
+        if (count == decimals)
+            *p++ = '.';
+        *p++ = digits[--count];
+    }
+    *p = '\0';
+    return p - buf;
+}
@@ -0,0 +1,365 @@
+#include <Arduino.h>
+#include <ezTime.h>
+#include <LittleFS.h>
+#include <history.h>
+
+#define HISTORY_LARGEST INT16_MAX
+// Enough to fit any int32_t reading, more only comes from a bad file
+#define HISTORY_MAX_EXPONENT 5
+
+// Mirror file header, then per series a 16 byte id, the measurement
+// index, the exponent and the points oldest first
+#define MIRROR_MAGIC 0x4845
+#define MIRROR_VERSION 1
+#define MIRROR_ID_SIZE 16
+
+struct MirrorHeader
+{
+    uint16_t magic;
+    uint8_t version;
+    uint8_t seriesCount;
+    uint16_t count;
+    uint16_t reserved;
+    uint32_t endTime;
+};
+
+static_assert(sizeof(HistoryPoint) == 6, "HISTORY_SERIES_BYTES counts 6 bytes a point");
+
+static const uint32_t periods[HISTORY_TIERS] = {HISTORY_RAW_PERIOD_S, HISTORY_MINUTE_PERIOD_S, HISTORY_QUARTER_PERIOD_S};
+
+static int32_t powerOfTen(uint8_t exponent)
+{
+    int32_t p = 1;
+    while (exponent-- > 0)
+        p *= 10;
+    return p;
+}
+
+// Rounds half away from zero
+static int32_t divide(int64_t value, int32_t divisor)
+{
+    return (value >= 0 ? value + divisor / 2 : value - divisor / 2) / divisor;
+}
+
+static void extend(int32_t value, bool first, int32_t *min, int32_t *max)
+{
+    if (first || value < *min)
+        *min = value;
+    if (first || value > *max)
+        *max = value;
+}
+
+// *** PUBLIC ***
+
+void History::Begin(SensorDriver *drivers[], int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        const Measurement *schema;
+        const int32_t *values;
+        int n = drivers[i]->GetReadings(&schema, &values);
+        for (int j = 0; j < n; j++)
+        {
+            if (_seriesCount == HISTORY_MAX_SERIES)
+            {
+                Serial.printf_P(PSTR("No history for %s measurement %i\n"), drivers[i]->GetId(), j);
+                continue;
+            }
+            Series *s = &_series[_seriesCount++];
+            memset(s, 0, sizeof(*s));
+            s->driver = drivers[i];
+            s->measurement = j;
+            s->generation = drivers[i]->GetGeneration();
+        }
+    }
+    Allocate();
+    for (int t = 0; t < HISTORY_TIERS; t++)
+        _endMillis[t] = millis() + periods[t] * 1000;
+    _mirrorMillis = millis();
+}
+
+void History::Sample()
+{
+    // Close the periods that have ended, a long stall leaves at most a
+    // tier's worth of missing points
+    unsigned long now = millis();
+#if HISTORY_MIRROR
+    // The clock can be set well after Begin(), too late once a 15
+    // minute point has closed
+    if (!_mirrorLoaded && timeStatus() != timeNotSet)
+    {
+        _mirrorLoaded = true;
+        if (_count[HISTORY_QUARTER] == 0)
+            Load();
+    }
+#endif
+    for (int t = 0; t < HISTORY_TIERS; t++)
+    {
+        if (_size[t] == 0)
+            continue;
+        for (int n = 0; (long)(now - _endMillis[t]) >= 0; n++)
+        {
+            if (n == _size[t])
+            {
+                _endMillis[t] = now + periods[t] * 1000;
+                break;
+            }
+            Close((HistoryTier)t);
+            _endMillis[t] += periods[t] * 1000;
+        }
+    }
+
+    // New readings only, a driver is sampled more often than it reads
+    for (int i = 0; i < _seriesCount; i++)
+    {
+        Series *s = &_series[i];
+        uint32_t generation = s->driver->GetGeneration();
+        if (generation == s->generation || !s->driver->IsLastReadingValid())
+            continue;
+        s->generation = generation;
+        const Measurement *schema;
+        const int32_t *values;
+        s->driver->GetReadings(&schema, &values);
+        int32_t value = values[s->measurement];
+        s->last = value;
+        s->hasLast = true;
+        extend(value, s->minute.count == 0, &s->minute.min, &s->minute.max);
+        s->minute.sum += value;
+        s->minute.count++;
+        extend(value, s->quarter.count == 0, &s->quarter.min, &s->quarter.max);
+        s->quarter.sum += value;
+        s->quarter.count++;
+    }
+
+#if HISTORY_MIRROR
+    if (_mirrorLoaded && (unsigned long)(now - _mirrorMillis) >= HISTORY_MIRROR_PERIOD_S * 1000UL)
+    {
+        _mirrorMillis = now;
+        Save();
+    }
+#endif
+}
+
+const Measurement &History::GetMeasurement(int series)
+{
+    const Measurement *schema;
+    const int32_t *values;
+    _series[series].driver->GetReadings(&schema, &values);
+    return schema[_series[series].measurement];
+}
+
+uint32_t History::GetPeriodSeconds(HistoryTier tier)
+{
+    return periods[tier];
+}
+
+time_t History::GetEndTime(HistoryTier tier)
+{
+    if (timeStatus() == timeNotSet)
+        return 0;
+    unsigned long end = _endMillis[tier] - periods[tier] * 1000;
+    return now() - (millis() - end) / 1000;
+}
+
+HistoryPoint History::GetPoint(int series, HistoryTier tier, int index)
+{
+    Series *s = &_series[series];
+    int slot = (_head[tier] + index) % _size[tier];
+    if (tier == HISTORY_RAW)
+        return {s->raw[slot], s->raw[slot], s->raw[slot]};
+    return tier == HISTORY_MINUTE ? s->minutePoints[slot] : s->quarterPoints[slot];
+}
+
+// *** PRIVATE ***
+
+// Shares the pool out between the series, the longer tiers first
+void History::Allocate()
+{
+    size_t perSeries = _seriesCount > 0 ? sizeof(_pool) / _seriesCount : 0;
+    // Arena alignment, the int16_t raw points go last
+    perSeries -= perSeries % alignof(HistoryPoint);
+    _size[HISTORY_QUARTER] = min(perSeries / sizeof(HistoryPoint), (size_t)HISTORY_QUARTER_POINTS);
+    perSeries -= _size[HISTORY_QUARTER] * sizeof(HistoryPoint);
+    _size[HISTORY_MINUTE] = min(perSeries / sizeof(HistoryPoint), (size_t)HISTORY_MINUTE_POINTS);
+    perSeries -= _size[HISTORY_MINUTE] * sizeof(HistoryPoint);
+#if HISTORY_RAW_TIER
+    _size[HISTORY_RAW] = min(perSeries / sizeof(int16_t), (size_t)HISTORY_RAW_POINTS);
+#endif
+    for (int i = 0; i < _seriesCount; i++)
+    {
+        Series *s = &_series[i];
+        s->quarterPoints = (HistoryPoint *)_arena.Allocate(_size[HISTORY_QUARTER] * sizeof(HistoryPoint), alignof(HistoryPoint));
+        s->minutePoints = (HistoryPoint *)_arena.Allocate(_size[HISTORY_MINUTE] * sizeof(HistoryPoint), alignof(HistoryPoint));
+        s->raw = (int16_t *)_arena.Allocate(_size[HISTORY_RAW] * sizeof(int16_t), alignof(int16_t));
+    }
+    Serial.printf_P(PSTR("History of %i series keeps %i raw, %i minute and %i 15 minute points\n"), _seriesCount,
+                    _size[HISTORY_RAW], _size[HISTORY_MINUTE], _size[HISTORY_QUARTER]);
+}
+
+// Adds a point for the period just ended to every series
+void History::Close(HistoryTier tier)
+{
+    int slot = Push(tier);
+    for (int i = 0; i < _seriesCount; i++)
+    {
+        Series *s = &_series[i];
+        if (tier == HISTORY_RAW)
+        {
+            s->raw[slot] = s->hasLast ? Scale(s, s->last) : HISTORY_MISSING;
+            s->hasLast = false;
+            continue;
+        }
+
+        Accumulator *a = tier == HISTORY_MINUTE ? &s->minute : &s->quarter;
+        HistoryPoint point = {HISTORY_MISSING, HISTORY_MISSING, HISTORY_MISSING};
+        if (a->count > 0)
+        {
+            // The extremes decide the exponent for all three
+            Fit(s, a->min);
+            Fit(s, a->max);
+            point.min = Scale(s, a->min);
+            point.mean = Scale(s, divide(a->sum, a->count));
+            point.max = Scale(s, a->max);
+        }
+        if (tier == HISTORY_MINUTE)
+            s->minutePoints[slot] = point;
+        else
+            s->quarterPoints[slot] = point;
+        a->sum = 0;
+        a->count = 0;
+    }
+}
+
+// Slot for a new point, dropping the oldest when the tier is full
+int History::Push(HistoryTier tier)
+{
+    int slot = (_head[tier] + _count[tier]) % _size[tier];
+    if (_count[tier] < _size[tier])
+        _count[tier]++;
+    else
+        _head[tier] = (_head[tier] + 1) % _size[tier];
+    return slot;
+}
+
+void History::Fit(Series *s, int32_t value)
+{
+    while (divide(value < 0 ? -(int64_t)value : value, powerOfTen(s->exponent)) > HISTORY_LARGEST)
+        Rescale(s);
+}
+
+int16_t History::Scale(Series *s, int32_t value)
+{
+    Fit(s, value);
+    return divide(value, powerOfTen(s->exponent));
+}
+
+// Drops a digit from every point of a series, only happens when a
+// reading is larger than any before so at most a few times
+void History::Rescale(Series *s)
+{
+    s->exponent++;
+    for (int i = 0; i < _size[HISTORY_RAW]; i++)
+        if (s->raw[i] != HISTORY_MISSING)
+            s->raw[i] = divide(s->raw[i], 10);
+    for (int t = HISTORY_MINUTE; t < HISTORY_TIERS; t++)
+    {
+        HistoryPoint *points = t == HISTORY_MINUTE ? s->minutePoints : s->quarterPoints;
+        for (int i = 0; i < _size[t]; i++)
+        {
+            HistoryPoint &p = points[i];
+            if (p.mean != HISTORY_MISSING)
+                p = {(int16_t)divide(p.min, 10), (int16_t)divide(p.mean, 10), (int16_t)divide(p.max, 10)};
+        }
+    }
+}
+
+// Restores the 15 minute tier saved before a restart, with the time
+// since as missing points. Needs the clock to line the points up
+void History::Load()
+{
+    if (timeStatus() == timeNotSet)
+        return;
+    File f = LittleFS.open(HISTORY_MIRROR_FILE, "r");
+    if (!f)
+        return;
+    MirrorHeader header;
+    if (f.read((uint8_t *)&header, sizeof(header)) != sizeof(header) ||
+        header.magic != MIRROR_MAGIC || header.version != MIRROR_VERSION ||
+        header.count > HISTORY_QUARTER_POINTS || (time_t)header.endTime > now())
+        return;
+    int gap = (now() - header.endTime) / HISTORY_QUARTER_PERIOD_S;
+    if (gap >= _size[HISTORY_QUARTER])
+        return;
+
+    // The newest that fit if the tier is shorter than when saved
+    int keep = min((int)header.count, _size[HISTORY_QUARTER]);
+    int skip = header.count - keep;
+    for (int n = 0; n < keep; n++)
+    {
+        int slot = Push(HISTORY_QUARTER);
+        for (int i = 0; i < _seriesCount; i++)
+            _series[i].quarterPoints[slot] = {HISTORY_MISSING, HISTORY_MISSING, HISTORY_MISSING};
+    }
+    for (int i = 0; i < header.seriesCount; i++)
+    {
+        char id[MIRROR_ID_SIZE];
+        uint8_t measurement, exponent;
+        HistoryPoint points[HISTORY_QUARTER_POINTS];
+        size_t pointsSize = header.count * sizeof(HistoryPoint);
+        if (f.read((uint8_t *)id, sizeof(id)) != sizeof(id) || f.read(&measurement, 1) != 1 ||
+            f.read(&exponent, 1) != 1 || f.read((uint8_t *)points, pointsSize) != pointsSize ||
+            exponent > HISTORY_MAX_EXPONENT)
+            break;
+        id[MIRROR_ID_SIZE - 1] = '\0';
+        for (int j = 0; j < _seriesCount; j++)
+        {
+            Series *s = &_series[j];
+            if (s->measurement != measurement || strcmp(s->driver->GetId(), id) != 0)
+                continue;
+            // Points may have been kept since or saved at a finer scale
+            while (s->exponent < exponent)
+                Rescale(s);
+            int32_t divisor = powerOfTen(s->exponent - exponent);
+            for (int n = 0; n < keep; n++)
+            {
+                HistoryPoint p = points[skip + n];
+                if (p.mean != HISTORY_MISSING)
+                    p = {(int16_t)divide(p.min, divisor), (int16_t)divide(p.mean, divisor), (int16_t)divide(p.max, divisor)};
+                s->quarterPoints[n] = p;
+            }
+        }
+    }
+    for (int n = 0; n < gap; n++)
+        Close(HISTORY_QUARTER);
+    // Keep the periods lined up with the ones saved
+    time_t end = header.endTime + (time_t)(gap + 1) * HISTORY_QUARTER_PERIOD_S;
+    _endMillis[HISTORY_QUARTER] = millis() + (end - now()) * 1000;
+    Serial.printf_P(PSTR("History restored %i points\n"), keep);
+}
+
+void History::Save()
+{
+    if (timeStatus() == timeNotSet)
+        return;
+    File f = LittleFS.open(HISTORY_MIRROR_FILE, "w");
+    if (!f)
+        return;
+    MirrorHeader header = {MIRROR_MAGIC, MIRROR_VERSION, (uint8_t)_seriesCount, (uint16_t)_count[HISTORY_QUARTER], 0,
+                           (uint32_t)GetEndTime(HISTORY_QUARTER)};
+    f.write((const uint8_t *)&header, sizeof(header));
+    for (int i = 0; i < _seriesCount; i++)
+    {
+        Series *s = &_series[i];
+        char id[MIRROR_ID_SIZE] = {0};
+        strncpy(id, s->driver->GetId(), sizeof(id) - 1);
+        f.write((const uint8_t *)id, sizeof(id));
+        f.write(&s->measurement, 1);
+        f.write(&s->exponent, 1);
+        for (int n = 0; n < _count[HISTORY_QUARTER]; n++)
+        {
+            HistoryPoint p = GetPoint(i, HISTORY_QUARTER, n);
+            f.write((const uint8_t *)&p, sizeof(p));
+        }
+    }
+    f.close();
+}
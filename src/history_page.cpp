@@ -0,0 +1,148 @@
+#include <Arduino.h>
+#include "main.h"
+#include "history_page.h"
+#include "chunk_writer.h"
+#include "web_args.h"
+
+#define HISTORY_MAGIC "EH"
+#define HISTORY_VERSION 1
+
+struct Request
+{
+    HistoryTier tier;
+    bool csv;
+    char id[MEASUREMENT_MAX_ID + 1];
+    char name[32];
+};
+
+// Copies an argument to buf, empty if there isn't one
+static void copyArg(ESP8266WebServer *server, PGM_P name, char *buf, size_t size)
+{
+    const char *value = FindArg(server, name);
+    strncpy(buf, value != nullptr ? value : "", size - 1);
+    buf[size - 1] = '\0';
+}
+
+static void readRequest(ESP8266WebServer *server, Request *request)
+{
+    char tier[8], format[8];
+    copyArg(server, PSTR("tier"), tier, sizeof(tier));
+    request->tier = strcmp(tier, "raw") == 0 ? HISTORY_RAW : strcmp(tier, "1m") == 0 ? HISTORY_MINUTE : HISTORY_QUARTER;
+    copyArg(server, PSTR("format"), format, sizeof(format));
+    request->csv = strcmp(format, "csv") == 0;
+    copyArg(server, PSTR("id"), request->id, sizeof(request->id));
+    copyArg(server, PSTR("m"), request->name, sizeof(request->name));
+}
+
+static bool isSelected(const Request *request, int series)
+{
+    if (request->id[0] != '\0' && strcmp(request->id, history.GetDriver(series)->GetId()) != 0)
+        return false;
+    return request->name[0] == '\0' || strcmp_P(request->name, history.GetMeasurement(series).name) == 0;
+}
+
+// Value of a point in a series as text, empty if missing
+static void formatPoint(char *buf, int series, int16_t value)
+{
+    if (value == HISTORY_MISSING)
+    {
+        buf[0] = '\0';
+        return;
+    }
+    int32_t scale = 1;
+    for (int i = 0; i < history.GetExponent(series); i++)
+        scale *= 10;
+    FormatFixed(buf, (int32_t)value * scale, history.GetMeasurement(series).decimals);
+}
+
+static void sendCsv(ChunkWriter *writer, const Request *request)
+{
+    writer->Write_P(PSTR("id,measurement,time,min,mean,max\n"));
+    HistoryTier tier = request->tier;
+    int count = history.GetCount(tier);
+    long period = history.GetPeriodSeconds(tier);
+    long end = history.GetEndTime(tier);
+    for (int i = 0; i < history.GetSeriesCount(); i++)
+    {
+        if (!isSelected(request, i))
+            continue;
+        char name[32];
+        strncpy_P(name, history.GetMeasurement(i).name, sizeof(name) - 1);
+        name[sizeof(name) - 1] = '\0';
+        for (int n = 0; n < count; n++)
+        {
+            HistoryPoint p = history.GetPoint(i, tier, n);
+            char min[16], mean[16], max[16];
+            formatPoint(min, i, p.min);
+            formatPoint(mean, i, p.mean);
+            formatPoint(max, i, p.max);
+            writer->Printf_P(PSTR("%s,%s,%ld,%s,%s,%s\n"), history.GetDriver(i)->GetId(), name,
+                             end - (count - 1 - n) * period, min, mean, max);
+        }
+    }
+}
+
+// A length byte and the characters, text is in flash if flash is set
+static void writeText(ChunkWriter *writer, const char *text, bool flash)
+{
+    char buf[48];
+    if (flash)
+        strncpy_P(buf, text, sizeof(buf) - 1);
+    else
+        strncpy(buf, text, sizeof(buf) - 1);
+    buf[sizeof(buf) - 1] = '\0';
+    uint8_t len = strlen(buf);
+    writer->Write((const char *)&len, 1);
+    writer->Write(buf, len);
+}
+
+static void sendBinary(ChunkWriter *writer, const Request *request)
+{
+    HistoryTier tier = request->tier;
+    uint8_t header[4] = {HISTORY_MAGIC[0], HISTORY_MAGIC[1], HISTORY_VERSION, 0};
+    for (int i = 0; i < history.GetSeriesCount(); i++)
+        if (isSelected(request, i))
+            header[3]++;
+    writer->Write((const char *)header, sizeof(header));
+
+    uint16_t count = history.GetCount(tier);
+    uint8_t fields = tier == HISTORY_RAW ? 1 : 3;
+    uint32_t period = history.GetPeriodSeconds(tier);
+    uint32_t end = history.GetEndTime(tier);
+    for (int i = 0; i < history.GetSeriesCount(); i++)
+    {
+        if (!isSelected(request, i))
+            continue;
+        const Measurement &m = history.GetMeasurement(i);
+        writeText(writer, history.GetDriver(i)->GetId(), false);
+        writeText(writer, m.name, true);
+        writeText(writer, m.label, true);
+        uint8_t format[4] = {m.decimals, history.GetExponent(i), fields, 0};
+        writer->Write((const char *)format, sizeof(format));
+        writer->Write((const char *)&period, sizeof(period));
+        writer->Write((const char *)&end, sizeof(end));
+        writer->Write((const char *)&count, sizeof(count));
+        for (int n = 0; n < count; n++)
+        {
+            HistoryPoint p = history.GetPoint(i, tier, n);
+            if (fields == 1)
+                writer->Write((const char *)&p.mean, sizeof(p.mean));
+            else
+                writer->Write((const char *)&p, sizeof(p));
+        }
+    }
+}
+
+void SendHistory(ESP8266WebServer *server)
+{
+    Request request;
+    readRequest(server, &request);
+    ChunkWriter writer(server);
+    server->sendHeader(F("Cache-Control"), F("no-store"));
+    writer.Begin(200, request.csv ? "text/csv" : "application/octet-stream");
+    if (request.csv)
+        sendCsv(&writer, &request);
+    else
+        sendBinary(&writer, &request);
+    writer.End();
+}
@@ -0,0 +1,157 @@
+#include <Arduino.h>
+#include <i2c_bus.h>
+
+// *** PUBLIC ***
+
+I2cBus::I2cBus(TwoWire *wire)
+{
+    _wire = wire;
+    for (int i = 0; i < I2C_QUEUE_SIZE; i++)
+        _queue[i].state = FREE;
+}
+
+bool I2cBus::Queue(uint8_t address, const uint8_t *writeData, uint8_t writeLen, uint8_t readLen, uint16_t readDelayMs, I2cCallback callback, void *context)
+{
+    if (writeLen > I2C_MAX_WRITE || readLen > I2C_MAX_READ)
+        return false;
+    Transaction *t = Allocate();
+    if (t == nullptr)
+        return false;
+    t->exclusive = false;
+    t->address = address;
+    memcpy(t->writeData, writeData, writeLen);
+    t->writeLen = writeLen;
+    t->readLen = readLen;
+    t->readDelayMs = readDelayMs;
+    t->callback = callback;
+    t->context = context;
+    return true;
+}
+
+bool I2cBus::QueueExclusive(I2cCallback callback, void *context)
+{
+    Transaction *t = Allocate();
+    if (t == nullptr)
+        return false;
+    t->exclusive = true;
+    t->callback = callback;
+    t->context = context;
+    return true;
+}
+
+uint32_t I2cBus::Handle()
+{
+    Transaction *t = Next();
+    if (t != nullptr)
+    {
+        unsigned long start = micros();
+        Step(t);
+        uint32_t elapsed = micros() - start;
+        if (elapsed > _maxStepMicros)
+            _maxStepMicros = elapsed;
+    }
+    return NextDelay();
+}
+
+// *** PRIVATE ***
+
+I2cBus::Transaction *I2cBus::Allocate()
+{
+    for (int i = 0; i < I2C_QUEUE_SIZE; i++)
+    {
+        Transaction *t = &_queue[i];
+        if (t->state == FREE)
+        {
+            t->state = PENDING;
+            t->queuedMicros = micros();
+            t->seq = _nextSeq++;
+            return t;
+        }
+    }
+    return nullptr;
+}
+
+// Finish reads that are due before starting anything new, then take
+// pending transactions in the order they were queued
+I2cBus::Transaction *I2cBus::Next()
+{
+    Transaction *next = nullptr;
+    for (int i = 0; i < I2C_QUEUE_SIZE; i++)
+    {
+        Transaction *t = &_queue[i];
+        if (t->state == WAITING && (long)(millis() - t->readAtMillis) >= 0)
+            return t;
+        if (t->state == PENDING && (next == nullptr || (int32_t)(t->seq - next->seq) < 0))
+            next = t;
+    }
+    return next;
+}
+
+uint32_t I2cBus::NextDelay()
+{
+    uint32_t delay = I2C_IDLE_MS;
+    for (int i = 0; i < I2C_QUEUE_SIZE; i++)
+    {
+        Transaction *t = &_queue[i];
+        if (t->state == PENDING)
+            return 0;
+        if (t->state == WAITING)
+        {
+            long wait = (long)(t->readAtMillis - millis());
+            delay = min(delay, (uint32_t)max(wait, 0L));
+        }
+    }
+    return delay;
+}
+
+void I2cBus::Step(Transaction *t)
+{
+    if (t->exclusive)
+    {
+        Complete(t, I2C_OK, nullptr, 0);
+        return;
+    }
+
+    if (t->state == PENDING && t->writeLen > 0)
+    {
+        _wire->beginTransmission(t->address);
+        _wire->write(t->writeData, t->writeLen);
+        uint8_t e = _wire->endTransmission();
+        if (e != 0 || t->readLen == 0)
+        {
+            Complete(t, e, nullptr, 0);
+            return;
+        }
+        // millis() may be about to tick, so wait one more to be sure of
+        // at least readDelayMs
+        t->readAtMillis = millis() + t->readDelayMs + 1;
+        t->state = WAITING;
+        return;
+    }
+
+    // Read now (nothing to write) or once the wait is over
+    uint8_t data[I2C_MAX_READ];
+    uint8_t len = _wire->requestFrom(t->address, t->readLen);
+    for (int i = 0; i < len; i++)
+        data[i] = _wire->read();
+    Complete(t, len == t->readLen ? I2C_OK : I2C_ERROR_READ, data, len);
+}
+
+// Latency runs from being queued to the end of the callback
+void I2cBus::Complete(Transaction *t, uint8_t status, const uint8_t *data, uint8_t len)
+{
+    // Free the slot first so the callback can queue the next transaction
+    unsigned long queuedMicros = t->queuedMicros;
+    t->state = FREE;
+    t->callback(t->context, status, data, len);
+
+    uint32_t latency = micros() - queuedMicros;
+    if (_transactions == 0 || latency < _minLatencyMicros)
+        _minLatencyMicros = latency;
+    if (latency > _maxLatencyMicros)
+        _maxLatencyMicros = latency;
+    _totalLatencyMicros += latency;
+    _transactions++;
+    if (status != I2C_OK)
+        _errors++;
+}
@@ -0,0 +1,169 @@
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+#include "main.h"
+#include "json_api.h"
+#include "status_page.h"
+#include "chunk_writer.h"
+#include "web_args.h"
+
+// Comma separated field names from the request, empty for all
+static char fields[JSON_API_MAX_FIELDS];
+
+static void readFields(ESP8266WebServer *server)
+{
+    fields[0] = '\0';
+    const char *value = FindArg(server, PSTR("fields"));
+    if (value != nullptr)
+    {
+        strncpy(fields, value, sizeof(fields) - 1);
+        fields[sizeof(fields) - 1] = '\0';
+    }
+}
+
+// True if name (in flash) is in the requested fields
+static bool isSelected(PGM_P name)
+{
+    if (fields[0] == '\0')
+        return true;
+    size_t len = strlen_P(name);
+    for (const char *p = fields; *p != '\0';)
+    {
+        const char *end = strchr(p, ',');
+        size_t n = end ? (size_t)(end - p) : strlen(p);
+        if (n == len && strncmp_P(p, name, n) == 0)
+            return true;
+        if (!end)
+            break;
+        p = end + 1;
+    }
+    return false;
+}
+
+// Writes ,"name":value, or "name":value for the first member of an
+// object. Strings are expected to need no escaping
+static void member(ChunkWriter *writer, bool *first, PGM_P name, const char *value, bool quoted)
+{
+    char n[32];
+    strncpy_P(n, name, sizeof(n) - 1);
+    n[sizeof(n) - 1] = '\0';
+    writer->Printf_P(quoted ? PSTR("%s\"%s\":\"%s\"") : PSTR("%s\"%s\":%s"), *first ? "" : ",", n, value);
+    *first = false;
+}
+
+static void boardMember(ChunkWriter *writer, bool *first, PGM_P name, const char *value, bool quoted)
+{
+    if (isSelected(name))
+        member(writer, first, name, value, quoted);
+}
+
+static void beginResponse(ESP8266WebServer *server, ChunkWriter *writer)
+{
+    server->sendHeader(F("Cache-Control"), F("no-store"));
+    writer->Begin(200, "application/json");
+}
+
+void SendReadingsJson(ESP8266WebServer *server)
+{
+    readFields(server);
+    ChunkWriter writer(server);
+    beginResponse(server, &writer);
+    writer.Write_P(PSTR("{\"readings\":["));
+    bool firstDriver = true;
+    for (int i = 0; i < drivers_count; i++)
+    {
+        const Measurement *schema;
+        const int32_t *values;
+        int count = drivers[i]->GetReadings(&schema, &values);
+        bool any = false;
+        for (int j = 0; j < count && !any; j++)
+            any = isSelected(schema[j].name);
+        if (!any)
+            continue;
+
+        bool valid = drivers[i]->IsLastReadingValid();
+        writer.Printf_P(PSTR("%s{\"id\":\"%s\",\"valid\":%s,\"health\":%i"), firstDriver ? "" : ",",
+                        drivers[i]->GetId(), valid ? "true" : "false", drivers[i]->GetHealth()->GetScore());
+        firstDriver = false;
+        bool first = false;
+        for (int j = 0; j < count && valid; j++)
+        {
+            if (!isSelected(schema[j].name))
+                continue;
+            char value[16];
+            FormatFixed(value, values[j], schema[j].decimals);
+            member(&writer, &first, schema[j].name, value, false);
+        }
+        writer.Write_P(PSTR("}"));
+    }
+    writer.Write_P(PSTR("]}"));
+    writer.End();
+}
+
+void SendBoardJson(ESP8266WebServer *server)
+{
+    readFields(server);
+    ChunkWriter writer(server);
+    beginResponse(server, &writer);
+    char tmp[24];
+    bool first = true;
+    writer.Write_P(PSTR("{"));
+    boardMember(&writer, &first, PSTR("hostname"), hostname, true);
+    boardMember(&writer, &first, PSTR("ip"), FormatLocalIp(tmp), true);
+    boardMember(&writer, &first, PSTR("uptime_s"), ultoa(millis() / 1000, tmp, 10), false);
+    boardMember(&writer, &first, PSTR("cpu_mhz"), itoa(ESP.getCpuFreqMHz(), tmp, 10), false);
+    boardMember(&writer, &first, PSTR("free_heap"), utoa(ESP.getFreeHeap(), tmp, 10), false);
+    boardMember(&writer, &first, PSTR("heap_frag"), itoa(ESP.getHeapFragmentation(), tmp, 10), false);
+    strncpy_P(tmp, GetResetReasonName(getResetReason()), sizeof(tmp) - 1);
+    tmp[sizeof(tmp) - 1] = '\0';
+    boardMember(&writer, &first, PSTR("reset_reason"), tmp, true);
+    boardMember(&writer, &first, PSTR("packets_sent"), utoa(packetsSent, tmp, 10), false);
+    boardMember(&writer, &first, PSTR("packets_replayed"), utoa(packetsReplayed, tmp, 10), false);
+    boardMember(&writer, &first, PSTR("queued_bytes"), utoa(telemetry.GetQueuedBytes(), tmp, 10), false);
+    boardMember(&writer, &first, PSTR("dropped_samples"), utoa(telemetry.GetDroppedSamples(), tmp, 10), false);
+    boardMember(&writer, &first, PSTR("suppressed_values"), utoa(telemetry.GetSuppressedValues(), tmp, 10), false);
+    boardMember(&writer, &first, PSTR("journal_segments"), utoa(journal.GetSegmentCount(), tmp, 10), false);
+    boardMember(&writer, &first, PSTR("idle_percent"), itoa(scheduler.GetIdlePercent(), tmp, 10), false);
+    writer.Write_P(PSTR("}"));
+    writer.End();
+}
+
+void SendEventsJson(ESP8266WebServer *server)
+{
+    const char *before = FindArg(server, PSTR("before"));
+    const char *count = FindArg(server, PSTR("count"));
+    uint32_t next = before != nullptr ? strtoul(before, nullptr, 10) : 0;
+    int wanted = count != nullptr ? atoi(count) : 20;
+    wanted = min(max(wanted, 1), JSON_API_MAX_EVENTS);
+
+    ChunkWriter writer(server);
+    beginResponse(server, &writer);
+    writer.Write_P(PSTR("{\"events\":["));
+    // A few records at a time to keep the stack small
+    EventRecord events[8];
+    int sent = 0;
+    while (sent < wanted)
+    {
+        int n = eventLog.Read(next, events, min(wanted - sent, (int)(sizeof(events) / sizeof(events[0]))));
+        for (int i = 0; i < n; i++)
+        {
+            char type[20], detail[64];
+            strncpy_P(type, EventLog::GetTypeName(events[i].type), sizeof(type) - 1);
+            type[sizeof(type) - 1] = '\0';
+            DescribeEvent(&events[i], detail, sizeof(detail));
+            writer.Printf_P(PSTR("%s{\"seq\":%u,\"time\":%u,\"uptime_ms\":%u,\"type\":\"%s\",\"arg\":%u,\"value\":%d,\"detail\":\"%s\"}"),
+                            sent + i == 0 ? "" : ",", events[i].sequence, events[i].time, events[i].uptimeMs, type,
+                            events[i].arg, events[i].value, detail);
+        }
+        if (n == 0)
+        {
+            next = 0;
+            break;
+        }
+        sent += n;
+        next = events[n - 1].sequence;
+    }
+    if (next <= eventLog.GetFirstSequence())
+        next = 0;
+    writer.Printf_P(PSTR("],\"next\":%u}"), next);
+    writer.End();
+}
@@ -1,33 +1,61 @@
 #include <Arduino.h>
 #include <ldr_driver.h>
+#include <arena.h>
+
+// light,id=LDRc25732 value=101
+static constexpr char lightName[] PROGMEM = "light";
+static constexpr char lightLabel[] PROGMEM = "Light Intensity";
+static constexpr Measurement schema[] = {
+    {lightName, lightLabel, 0, MEASUREMENT_ANY_MIN, MEASUREMENT_ANY_MAX, nullptr, 8, 0}};
+static_assert(MaxLineProtocolLength(schema) <= MAX_PACKET_DATA, "LDR packet data too long");
+
+// The ADC is noisy, each reading is the mean of LDR_OVERSAMPLE
+#define LDR_OVERSAMPLE 4
+static constexpr FilterStage filters[] = {{FILTER_DECIMATE, LDR_OVERSAMPLE, 0}};
 
 // *** PUBLIC ***
 
 // Return a driver for LDR
 int LdrDriver::CreateDriverInstances(SensorDriver *firstInstance[], int maxInstances)
 {
-    if (maxInstances < 1)
+    void *p = maxInstances < 1 ? nullptr : driverArena.Allocate(sizeof(LdrDriver), alignof(LdrDriver));
+    if (p == nullptr)
         return 0;
-    firstInstance[0] = new LdrDriver();
+    firstInstance[0] = new (p) LdrDriver();
     return 1;
 }
 
 int LdrDriver::GetPacketData(char *ptr)
 {
-    _lastReading = analogRead(0);
-    char l[16];
-    itoa(_lastReading, l, 10);
-    // light,id=LDRc25732 value=101
-    return sprintf(ptr, "light,id=%s value=%s\n", _id, l);
+    return EncodeLineProtocol(ptr, schema, _id, &_lastReading);
+}
+
+// Read here rather than when sending so every consumer sees the same value
+uint32_t LdrDriver::Handle()
+{
+    // The ADC can't fail, so every read is a success
+    unsigned long start = micros();
+    for (int i = 0; i < LDR_OVERSAMPLE; i++)
+        if (_filter.Add(analogRead(0), &_lastReading) == FILTER_PASSED)
+            _generation++;
+    _health.Success(micros() - start);
+    return SENSOR_POLL_MS;
 }
 
-void LdrDriver::GetValues(void cb(const char *, const char *))
+void LdrDriver::GetValues(void cb(const __FlashStringHelper *, const char *))
 {
-    char l[16];
+    char val[8];
     // Call back with name value pairs
-    cb("Device", "LDR");
-    cb("Id", _id);
-    cb("Light Intensity", itoa(_lastReading, l, 10));
+    cb(F("Device"), strcpy_P(val, PSTR("LDR")));
+    cb(F("Id"), _id);
+    EncodeValues(cb, schema, &_lastReading);
+}
+
+int LdrDriver::GetReadings(const Measurement **schemaOut, const int32_t **values)
+{
+    *schemaOut = schema;
+    *values = &_lastReading;
+    return sizeof(schema) / sizeof(schema[0]);
 }
 
 // *** PRIVATE ***
@@ -35,6 +63,8 @@ void LdrDriver::GetValues(void cb(const char *, const char *))
 // Construct a driver for a Si7051 device at address
 LdrDriver::LdrDriver()
 {
+    _filter.Begin(&schema[0], filters, _filterState);
+
     // Unique id is LDR - ESP8266 id
-    sprintf(_id, "LDR%x", ESP.getChipId());
+    sprintf_P(_id, PSTR("LDR%x"), ESP.getChipId());
 }
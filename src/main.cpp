@@ -14,7 +14,19 @@
 #include "bh1750_driver.h"
 #include "ds18b20_driver.h"
 #include "ldr_driver.h"
+#include "i2c_bus.h"
+#include "one_wire_bus.h"
+#include "scheduler.h"
 #include "status_page.h"
+#include "metrics_page.h"
+#include "static_assets.h"
+#include "event_stream.h"
+#include "json_api.h"
+#include "history_page.h"
+#include "profile_page.h"
+#include "web_args.h"
+#include "arena.h"
+#include "alloc_hook.h"
 
 // ***** Network credentials *****
 #include "password.h"
@@ -22,9 +34,14 @@
 // const char *ssid = "ssid";
 // const char *password = "password";
 
-// The influx database UDP address and port
+// The influx database UDP address and port, compressed telemetry goes to
+// scripts/uplink_decoder.py on the same host which forwards it to influx
 #define SERVER_IP IPAddress(192, 168, 0, 14)
+#if TELEMETRY_COMPRESSED
+#define SERVER_PORT 8090
+#else
 #define SERVER_PORT 8089
+#endif
 
 // Enable one of these name/trim pairs
 
@@ -65,72 +82,107 @@ const char *hostname = "es-master-bedroom";
 // Flash led for debugging
 #define FLASH_LED 0
 
+// Let the WiFi stack light sleep while the scheduler is idle (saves more
+// power than the default modem sleep at the cost of HTTP response time)
+#define LIGHT_SLEEP 0
+
 // ********************************
 
 // Drivers for active sensors
 int drivers_count = 0;
 SensorDriver *drivers[MAX_SENSOR_DRIVERS];
 
-// HTTP web server for current status
+// Drivers live in a static arena rather than on the heap. The default
+// fits MAX_SENSOR_DRIVERS as two BME680s, a Si705, a BH1750, the LDR
+// and three DS18B20 probes, nodes with more probes need it bigger
+#ifndef DRIVER_ARENA_SIZE
+#define DRIVER_ARENA_SIZE (2 * sizeof(Bme680Driver) + sizeof(Si705Driver) + sizeof(Bh1750Driver) + \
+                           sizeof(LdrDriver) + 3 * sizeof(Ds18b20Driver) + MAX_SENSOR_DRIVERS * 8)
+#endif
+alignas(8) uint8_t driverArenaData[DRIVER_ARENA_SIZE];
+Arena driverArena(driverArenaData, sizeof(driverArenaData));
+
+// HTTP web server for current status, live readings on /events
 ESP8266WebServer server(80);
+EventStream eventStream(&server);
+int eventsTask;
 
-// OneWire
+// OneWire, probes are read through oneWireBus
 OneWire ds;
+OneWireBus oneWireBus(&ds);
 
-// I2C
+// I2C, drivers share the bus through i2cBus
 TwoWire I2C;
+I2cBus i2cBus(&I2C);
 
-// Last startup date time
+// Time zone, looked up once the clock is set
 Timezone myTZ;
-startupEntry startupLog[MAX_STARTUP_LOG_ENTRIES];
-const char *startupLogFileName = "SULog";
+
+// Boots, resets and trouble since long before this one
 extern struct rst_info resetInfo;
+EventLog eventLog;
 
-// Updates the start up log
-void updateStartupLog()
+uint32 getResetReason()
 {
-  // Load startup log
-  File f = LittleFS.open(startupLogFileName, "r");
-  if (f)
-  {
-    f.readBytes((char *)&startupLog, sizeof(startupLog));
-    f.close();
-  }
+  return resetInfo.reason;
+}
 
-  // Add new entry to start of the log
-  for (int i = MAX_STARTUP_LOG_ENTRIES - 1; i > 0; i--)
-    startupLog[i] = startupLog[i - 1];
-  startupLog[0].time = now();
-  startupLog[0].reason = resetInfo.reason;
+bootPhase bootPhases[BOOT_PHASES];
 
-  // Save startup log
-  f = LittleFS.open(startupLogFileName, "w");
-  if (f)
+PGM_P GetBootPhaseName(int phase)
+{
+  switch (phase)
   {
-    f.write((char *)&startupLog, sizeof(startupLog));
-    f.close();
+  case BOOT_SETUP:
+    return PSTR("Setup");
+  case BOOT_FILE_SYSTEM:
+    return PSTR("File System");
+  case BOOT_SENSORS:
+    return PSTR("Sensors");
+  case BOOT_SERVICES:
+    return PSTR("Services");
+  case BOOT_WIFI:
+    return PSTR("WiFi");
+  case BOOT_TIME_SYNC:
+    return PSTR("Time Sync");
+  default:
+    return PSTR("Time Zone");
   }
 }
 
+void beginBootPhase(int phase)
+{
+  bootPhases[phase].startMillis = millis();
+  bootPhases[phase].started = true;
+}
+
+void endBootPhase(int phase)
+{
+  bootPhase *p = &bootPhases[phase];
+  p->endMillis = millis();
+  p->done = true;
+  char name[16];
+  strncpy_P(name, GetBootPhaseName(phase), sizeof(name) - 1);
+  name[sizeof(name) - 1] = '\0';
+  Serial.printf_P(PSTR("Boot %s took %lu ms, %u bytes heap free\n"), name, p->endMillis - p->startMillis,
+                  ESP.getFreeHeap());
+}
+
 // SETUP
 void setup()
 {
+  beginBootPhase(BOOT_SETUP);
+
   // Debugging over serial terminal
   Serial.begin(115200);
-  Serial.println("Booting");
+  Serial.println(F("Booting"));
 
-  // Connect to WiFi
+  // Start connecting to WiFi, the boot task brings up the network
+  // services once it has
+  beginBootPhase(BOOT_WIFI);
   WiFi.mode(WIFI_STA);
   WiFi.hostname(hostname);
   WiFi.begin(ssid, password);
-  while (WiFi.waitForConnectResult() != WL_CONNECTED)
-  {
-    // Try again if connection failed
-    Serial.println("Failed to connect to WiFi");
-    delay(5000);
-    Serial.println("Rebooting...");
-    ESP.restart();
-  }
 
   // Port defaults to 8266
   // ArduinoOTA.setPort(8266);
@@ -147,92 +199,156 @@ void setup()
 
   // OTA start callback
   ArduinoOTA.onStart([]() {
-    String type;
-    if (ArduinoOTA.getCommand() == U_FLASH)
-    {
-      type = "sketch";
-    }
-    else
-    {
-      // U_FS
-      type = "filesystem";
-    }
-
-    // NOTE: if updating FS this would be the place to unmount FS using FS.end()
-    Serial.println("Start updating " + type);
-    LittleFS.end();
+    // U_FS otherwise
+    bool sketch = ArduinoOTA.getCommand() == U_FLASH;
+    Serial.print(F("Start updating "));
+    Serial.println(sketch ? F("sketch") : F("filesystem"));
+    eventLog.Add(EVENT_OTA_START, sketch ? 0 : 1);
+
+    // Unmount the file system only to replace it, a sketch update leaves
+    // it mounted so the end or error can be logged
+    if (!sketch)
+      LittleFS.end();
   });
 
   // OTA end callback
   ArduinoOTA.onEnd([]() {
-    Serial.println("\nEnd");
+    Serial.println(F("\nEnd"));
+    eventLog.Add(EVENT_OTA_END);
   });
 
   // OTA progress callback
   ArduinoOTA.onProgress([](unsigned int progress, unsigned int total) {
-    Serial.printf("Progress: %u%%\r", (progress / (total / 100)));
+    Serial.printf_P(PSTR("Progress: %u%%\r"), (progress / (total / 100)));
   });
 
   // OTA error callback
   ArduinoOTA.onError([](ota_error_t error) {
-    Serial.printf("Error[%u]: ", error);
+    Serial.printf_P(PSTR("Error[%u]: "), error);
+    eventLog.Add(EVENT_OTA_ERROR, error);
     if (error == OTA_AUTH_ERROR)
     {
-      Serial.println("Auth Failed");
+      Serial.println(F("Auth Failed"));
     }
     else if (error == OTA_BEGIN_ERROR)
     {
-      Serial.println("Begin Failed");
+      Serial.println(F("Begin Failed"));
     }
     else if (error == OTA_CONNECT_ERROR)
     {
-      Serial.println("Connect Failed");
+      Serial.println(F("Connect Failed"));
     }
     else if (error == OTA_RECEIVE_ERROR)
     {
-      Serial.println("Receive Failed");
+      Serial.println(F("Receive Failed"));
     }
     else if (error == OTA_END_ERROR)
     {
-      Serial.println("End Failed");
+      Serial.println(F("End Failed"));
     }
   });
 
   // Mount file system
+  beginBootPhase(BOOT_FILE_SYSTEM);
   if (LittleFS.begin())
-    Serial.println("File System Mounted OK");
+    Serial.println(F("File System Mounted OK"));
   else
   {
-    Serial.println("Formatting File System");
+    Serial.println(F("Formatting File System"));
     bool ok = LittleFS.format();
     if (!ok)
-      Serial.println("Failed to format file system");
+      Serial.println(F("Failed to format file system"));
     else if (!LittleFS.begin())
-      Serial.println("File System not available");
+      Serial.println(F("File System not available"));
   }
 
-  // Initialize time library
-  int i = 0;
-  for (; i < 5; i++)
-    if (myTZ.setLocation(F("Europe/London")))
-      break;
-  if (i == 5)
-      Serial.println("Failed to setLocation(...)");
-  if (!waitForSync(15000))
-      Serial.println("Failed to set time");
-
-  // Update the startup log
-  updateStartupLog();
-
-  // Server HTTP request for current status
-  server.on("/", []() {
-    const char *page = BuildStatusPage();
-    server.send(200, "text/html", page);
+  // Log the boot, anything going wrong from here on is logged too. The
+  // whole file startup log this replaced goes
+  eventLog.Begin();
+  eventLog.Add(EVENT_BOOT, resetInfo.reason, resetInfo.exccause);
+  LittleFS.remove("SULog");
+  endBootPhase(BOOT_FILE_SYSTEM);
+
+  // Sensors are detected while WiFi associates
+  beginBootPhase(BOOT_SENSORS);
+
+  // Configure output for blue LED
+  pinMode(LED_BUILTIN, OUTPUT);
+  digitalWrite(LED_BUILTIN, HIGH);
+
+  // DS18B20 sensors on GPIO14 D5
+  ds.begin(14);
+
+  // Configure I2C on (SDA GPIO0 D3) and (SCL GPIO5 D1)
+  I2C.begin(0, 5);
+  I2C.setClock(100000);
+
+  // TODO:  Without this delay detection sometimes fails after power on,
+  // only what's left of it after the steps above is waited
+  if (millis() < SENSOR_POWER_UP_MS)
+    delay(SENSOR_POWER_UP_MS - millis());
+
+  // Create drivers for each of our sensors
+  drivers_count += Bme680Driver::CreateDriverInstances(&i2cBus, &drivers[drivers_count], MAX_SENSOR_DRIVERS - drivers_count, BME680_TEMP_TRIM, BME680_TEMP_TRIM);
+  drivers_count += Si705Driver::CreateDriverInstances(&i2cBus, &drivers[drivers_count], MAX_SENSOR_DRIVERS - drivers_count);
+  drivers_count += Bh1750Driver::CreateDriverInstances(&i2cBus, &drivers[drivers_count], MAX_SENSOR_DRIVERS - drivers_count);
+  drivers_count += Ds18b20Driver::CreateDriverInstances(&oneWireBus, &drivers[drivers_count], MAX_SENSOR_DRIVERS - drivers_count);
+#if LDR_DRIVER
+  drivers_count += LdrDriver::CreateDriverInstances(&drivers[drivers_count], MAX_SENSOR_DRIVERS - drivers_count);
+#endif
+  endBootPhase(BOOT_SENSORS);
+
+  beginBootPhase(BOOT_SERVICES);
+
+  // Pick up packets journaled before the restart
+  journal.Begin();
+
+  // Keep a history of every measurement
+  history.Begin(drivers, drivers_count);
+
+  // Status page shell from flash, it fetches the rows from /status
+  const char *headerKeys[] = {"If-None-Match"};
+  server.collectHeaders(headerKeys, 1);
+  RegisterStaticAssets(&server);
+  server.on("/status", []() {
+    SendStatusPage(&server);
+  });
+
+  // JSON for dashboards and the collector
+  server.on("/api/readings", HTTP_GET, []() {
+    SendReadingsJson(&server);
+  });
+  server.on("/api/board", HTTP_GET, []() {
+    SendBoardJson(&server);
+  });
+  server.on("/api/history", HTTP_GET, []() {
+    SendHistory(&server);
+  });
+  server.on("/api/events", HTTP_GET, []() {
+    SendEventsJson(&server);
+  });
+
+  // Server-Sent Events of changed readings
+  server.on("/events", HTTP_GET, []() {
+    eventStream.Accept();
+    scheduler.Wake(eventsTask);
+  });
+
+#if PROFILER
+  // Task and loop timings, ?reset clears them
+  server.on("/debug/profile", HTTP_GET, []() {
+    SendProfile(&server);
+  });
+#endif
+
+  // Server HTTP request for Prometheus scrapers
+  server.on("/metrics", []() {
+    SendMetricsPage(&server);
   });
 
   // Server HTTP post
   server.on("/commands", HTTP_POST, []() {
-    if (server.hasArg("recalibrate"))
+    if (FindArg(&server, PSTR("recalibrate")) != nullptr)
     {
       server.send(200, "text/html", "Calibration data cleared. Restarting...");
       for (int i = 0; i < drivers_count; i++)
@@ -242,7 +358,7 @@ void setup()
       return;
     }
 
-    if (server.hasArg("restart"))
+    if (FindArg(&server, PSTR("restart")) != nullptr)
     {
       server.send(200, "text/html", "Restarting...");
       delay(3000);
@@ -253,77 +369,260 @@ void setup()
     server.send(400, "text/html", "Unknown Request");
   });
 
-  // Allow OTA updates and server HTTP requests
-  ArduinoOTA.begin();
-  server.begin();
+  endBootPhase(BOOT_SERVICES);
 
-  // Report our IP
-  Serial.print("IP address: ");
-  Serial.println(WiFi.localIP());
-
-  // Configure output for blue LED
-  pinMode(LED_BUILTIN, OUTPUT);
-  digitalWrite(LED_BUILTIN, HIGH);
+#if LIGHT_SLEEP
+  WiFi.setSleepMode(WIFI_LIGHT_SLEEP);
+#endif
 
-  // DS18B20 sensors on GPIO14 D5
-  ds.begin(14);
+  // Everything loop() does runs as a scheduled task
+  startTasks();
+  endBootPhase(BOOT_SETUP);
+}
 
-  // Configure I2C on (SDA GPIO0 D3) and (SCL GPIO5 D1)
-  I2C.begin(0, 5);
-  I2C.setClock(100000);
+Telemetry telemetry;
+TelemetryJournal journal;
+History history;
+uint32_t packetsSent = 0;
+uint32_t packetsReplayed = 0;
+char packet[MAX_PACKET_SIZE + 1];
+WiFiUDP udp;
 
-  // TODO:  Without this delay detection sometimes fails after power on
-  delay(1000);
+// Returns false if the packet couldn't be sent. UDP has no delivery
+// acknowledgement, so only a missing link is detected
+bool sendPacket(const char *packet, int packetLen)
+{
+  if (!WiFi.isConnected())
+    return false;
+  udp.beginPacket(SERVER_IP, SERVER_PORT);
+  udp.write(packet, packetLen);
+  if (!udp.endPacket())
+    return false;
+  packetsSent++;
+  return true;
+}
 
-  // Create drivers for each of our sensors
-  drivers_count += Bme680Driver::CreateDriverInstances(&I2C, &drivers[drivers_count], MAX_SENSOR_DRIVERS - drivers_count, BME680_TEMP_TRIM, BME680_TEMP_TRIM);
-  drivers_count += Si705Driver::CreateDriverInstances(&I2C, &drivers[drivers_count], MAX_SENSOR_DRIVERS - drivers_count);
-  drivers_count += Bh1750Driver::CreateDriverInstances(&I2C, &drivers[drivers_count], MAX_SENSOR_DRIVERS - drivers_count);
-  drivers_count += Ds18b20Driver::CreateDriverInstances(&ds, &drivers[drivers_count], MAX_SENSOR_DRIVERS - drivers_count);
-#if LDR_DRIVER
-  drivers_count += LdrDriver::CreateDriverInstances(&drivers[drivers_count], MAX_SENSOR_DRIVERS - drivers_count);
+// Send everything queued as a batch of packets, journal what can't be sent
+void flushTelemetry()
+{
+  while (!telemetry.IsEmpty())
+  {
+    int packetLen = telemetry.BuildPacket(packet, sizeof(packet));
+    // Samples waiting for the clock to be set
+    if (packetLen == 0)
+      break;
+    Serial.print(F("*** PACKET ("));
+    Serial.print(packetLen);
+    Serial.println(F(") ***"));
+#if !TELEMETRY_COMPRESSED
+    Serial.print(packet);
 #endif
+    Serial.println(F("*** PACKET END ***"));
+
+    // Untimestamped samples would be stamped on replay, so aren't kept
+    if (!sendPacket(packet, packetLen) && timeStatus() != timeNotSet)
+      journal.Append(packet, packetLen);
+  }
 }
 
-long lastPollMillis = 0;
-char lastPacket[512];
-WiFiUDP udp;
+// Send the oldest journaled packet
+void replayJournal()
+{
+  int packetLen = journal.Peek(packet, sizeof(packet));
+  if (packetLen > 0 && sendPacket(packet, packetLen))
+  {
+    journal.Pop();
+    packetsReplayed++;
+  }
+}
 
 // LOOP
-void loop()
+// Tasks run by the scheduler return the ms until they next want to run
+Scheduler scheduler;
+int i2cTask;
+int flushTask;
+
+uint32_t handleOta(void *context)
 {
-  // Give various services a chance to do their stuff
   ArduinoOTA.handle();
+  return SERVICE_PERIOD_MS;
+}
+
+uint32_t handleServer(void *context)
+{
   server.handleClient();
+  return SERVICE_PERIOD_MS;
+}
 
-  // Call handle() on all the sensors
-  for (int i = 0; i < drivers_count; i++)
-    drivers[i]->Handle();
+uint32_t handleDriver(void *context)
+{
+  uint32_t next = ((SensorDriver *)context)->Handle();
+  // The driver may have queued a bus transaction
+  scheduler.Wake(i2cTask);
+  return next;
+}
+
+uint32_t handleI2c(void *context)
+{
+  return i2cBus.Handle();
+}
+
+uint32_t handleOneWire(void *context)
+{
+  return oneWireBus.Handle();
+}
+
+// Push new readings to the status page
+uint32_t handleEvents(void *context)
+{
+  return eventStream.Handle(drivers, drivers_count);
+}
+
+// Sample last sensor outputs
+uint32_t sampleTelemetry(void *context)
+{
+  telemetry.Sample(drivers, drivers_count);
+  history.Sample();
+  // Send sooner if samples would be dropped
+  if (telemetry.IsNearlyFull())
+    scheduler.Wake(flushTask);
+  return SAMPLE_PERIOD_MS;
+}
+
+// Send the samples in batches
+uint32_t handleFlush(void *context)
+{
+  flushTelemetry();
+  return FLUSH_PERIOD_MS;
+}
 
-  // Report last sensor outputs
-  if ((unsigned long)(millis() - lastPollMillis) >= POLL_PERIOD_MS)
+// Back fill from the journal, rate limited, once the link is back
+uint32_t handleJournal(void *context)
+{
+  journal.Handle();
+  if (!WiFi.isConnected() || journal.IsEmpty())
+    return JOURNAL_HANDLE_PERIOD_MS;
+  replayJournal();
+  return JOURNAL_REPLAY_PERIOD_MS;
+}
+
+// Logs the link going and coming back, and NTP resyncs going stale
+bool linkUp = false;
+bool clockStale = false;
+
+void checkLink()
+{
+  if (WiFi.isConnected() != linkUp)
   {
-    // Construct UDP packet (skip failed sensors)
-    int packetLen = 0;
-    for (int i = 0; i < drivers_count; i++)
-      if (drivers[i]->IsLastReadingValid())
-        packetLen += drivers[i]->GetPacketData(&lastPacket[packetLen]);
-    packetLen++;
-    Serial.print("*** PACKET (");
-    Serial.print(packetLen);
-    Serial.println(") ***");
-    Serial.print(lastPacket);
-    Serial.println("*** PACKET END ***");
+    linkUp = !linkUp;
+    if (linkUp)
+      eventLog.Add(EVENT_WIFI_CONNECTED, 0, WiFi.RSSI());
+    else
+      eventLog.Add(EVENT_WIFI_DISCONNECTED, WiFi.status());
+  }
+  if ((timeStatus() == timeNeedsSync) != clockStale)
+  {
+    clockStale = !clockStale;
+    if (clockStale)
+      eventLog.Add(EVENT_TIME_SYNC_FAILED, 1);
+  }
+}
+
+// Brings up the network services once WiFi has associated, then sets
+// the clock and time zone. The sensors are already running meanwhile
+int timeZoneTries = 0;
+bool timeSyncLate = false;
 
-    // Send packet
-    udp.beginPacket(SERVER_IP, SERVER_PORT);
-    udp.write(lastPacket);
-    udp.endPacket();
+uint32_t handleBoot(void *context)
+{
+  if (!bootPhases[BOOT_WIFI].done)
+  {
+    if (!WiFi.isConnected())
+      return BOOT_POLL_MS;
+    endBootPhase(BOOT_WIFI);
+
+    // Report our IP
+    Serial.print(F("IP address: "));
+    Serial.println(WiFi.localIP());
+
+    // Allow OTA updates and server HTTP requests
+    ArduinoOTA.begin();
+    server.begin();
+    scheduler.Add("OTA", handleOta, nullptr);
+    scheduler.Add("HTTP", handleServer, nullptr);
+    beginBootPhase(BOOT_TIME_SYNC);
+    // Each network step in a pass of its own
+    return 0;
+  }
+  checkLink();
+
+  if (!bootPhases[BOOT_TIME_SYNC].done)
+  {
+    // Samples queued until the clock is set are stamped as they're sent
+    events();
+    if (timeStatus() == timeNotSet)
+    {
+      if (!timeSyncLate && millis() - bootPhases[BOOT_TIME_SYNC].startMillis >= TIME_SYNC_LATE_MS)
+      {
+        timeSyncLate = true;
+        eventLog.Add(EVENT_TIME_SYNC_FAILED, 0, TIME_SYNC_LATE_MS / 1000);
+      }
+      return TIME_EVENTS_PERIOD_MS;
+    }
+    endBootPhase(BOOT_TIME_SYNC);
+    eventLog.Add(EVENT_CLOCK_SET);
+    beginBootPhase(BOOT_TIME_ZONE);
+    return 0;
+  }
 
-    // Schedule next poll
-    lastPollMillis = millis();
+  if (!bootPhases[BOOT_TIME_ZONE].done)
+  {
+    if (!myTZ.setLocation(F("Europe/London")))
+    {
+      if (++timeZoneTries < BOOT_TIME_ZONE_TRIES)
+        return BOOT_POLL_MS;
+      Serial.println(F("Failed to setLocation(...)"));
+      eventLog.Add(EVENT_TIME_ZONE_FAILED, 0, timeZoneTries);
+    }
+    endBootPhase(BOOT_TIME_ZONE);
   }
 
+  // Keeps ezTime's NTP resyncs going
+  events();
+  return TIME_EVENTS_PERIOD_MS;
+}
+
+void startTasks()
+{
+  // OTA and HTTP are added by the boot task once WiFi is up
+  scheduler.Add("Boot", handleBoot, nullptr);
+  for (int i = 0; i < drivers_count; i++)
+    scheduler.Add(drivers[i]->GetId(), handleDriver, drivers[i]);
+  i2cTask = scheduler.Add("I2C", handleI2c, nullptr);
+  scheduler.Add("OneWire", handleOneWire, nullptr);
+  eventsTask = scheduler.Add("Events", handleEvents, nullptr);
+  scheduler.Add("Sample", sampleTelemetry, nullptr);
+  flushTask = scheduler.Add("Flush", handleFlush, nullptr);
+  scheduler.Add("Journal", handleJournal, nullptr);
+}
+
+#if ALLOC_HOOK
+AllocTracker allocTracker;
+#endif
+
+void loop()
+{
+  // Run whatever is due then sleep until the next deadline. Only the
+  // tasks are tracked, the WiFi stack allocates while idle
+#if ALLOC_HOOK
+  allocTracker.BeginPass();
+#endif
+  scheduler.Run();
+#if ALLOC_HOOK
+  allocTracker.EndPass();
+#endif
+  scheduler.Idle();
+
 #if FLASH_LED
   // Flash led for debug
   digitalWrite(LED_BUILTIN, HIGH);
@@ -0,0 +1,47 @@
+#include <Arduino.h>
+#include <measurement.h>
+
+bool IsMeasurementValid(const Measurement &m, int32_t value)
+{
+    return value >= m.min && value <= m.max;
+}
+
+int EncodeLine(char *ptr, const Measurement &m, const char *id, int32_t value)
+{
+    char *p = ptr;
+    strcpy_P(p, m.name);
+    p += strlen(p);
+    strcpy_P(p, PSTR(",id="));
+    p += strlen(p);
+    p = stpcpy(p, id);
+    strcpy_P(p, PSTR(" value="));
+    p += strlen(p);
+    p += FormatFixed(p, value, m.decimals);
+    *p++ = '\n';
+    *p = '\0';
+    return p - ptr;
+}
+
+int FormatValue(char *buf, const Measurement &m, int32_t value)
+{
+    int len = FormatFixed(buf, value, m.decimals);
+    if (m.describe != nullptr)
+    {
+        // value (description)
+        buf[len++] = ' ';
+        buf[len++] = '(';
+        strncpy_P(&buf[len], m.describe(value), MEASUREMENT_MAX_TEXT - len - 2);
+        buf[MEASUREMENT_MAX_TEXT - 2] = '\0';
+        len += strlen(&buf[len]);
+        buf[len++] = ')';
+        buf[len] = '\0';
+    }
+    return len;
+}
+
+void EncodeValue(void cb(const __FlashStringHelper *, const char *), const Measurement &m, int32_t value)
+{
+    char val[MEASUREMENT_MAX_TEXT];
+    FormatValue(val, m, value);
+    cb(FPSTR(m.label), val);
+}
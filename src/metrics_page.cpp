@@ -0,0 +1,227 @@
+#include <Arduino.h>
+#include <stdarg.h>
+#include "main.h"
+#include "metrics_page.h"
+#include "status_page.h"
+#include "chunk_writer.h"
+
+// The driver families, then room for the board counters
+static char body[METRICS_BODY_SIZE + METRICS_BOARD_SIZE];
+static int bodyLen = 0;
+static bool bodyBuilt = false;
+// Set when the driver families didn't fit, they are then streamed
+// straight to the client on each request
+static bool bodyOverflowed = false;
+static uint32_t driverStates[MAX_SENSOR_DRIVERS];
+// Appends go to the client rather than the body while set
+static ChunkWriter *direct = nullptr;
+
+// Appends whole lines to the body, a line that doesn't fit is left out
+// and marks the body as overflowed. format is in flash
+static void append(PGM_P format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    if (direct != nullptr)
+        direct->VPrintf_P(format, args);
+    else if (!bodyOverflowed)
+    {
+        int len = vsnprintf_P(&body[bodyLen], METRICS_BODY_SIZE - bodyLen, format, args);
+        if (len < 0 || len >= METRICS_BODY_SIZE - bodyLen)
+        {
+            body[bodyLen] = '\0';
+            bodyOverflowed = true;
+        }
+        else
+            bodyLen += len;
+    }
+    va_end(args);
+}
+
+// Changes whenever a driver takes a reading or records a failed read.
+// Each part only goes up, so the sum moves when any of them does
+static uint32_t driverState(SensorDriver *driver)
+{
+    SensorHealth *health = driver->GetHealth();
+    return driver->GetGeneration() + health->GetSuccesses() + health->GetFailures();
+}
+
+// True if any driver has read its sensor since the body was built
+static bool isStale()
+{
+    bool stale = !bodyBuilt;
+    for (int i = 0; i < drivers_count; i++)
+    {
+        uint32_t state = driverState(drivers[i]);
+        if (state != driverStates[i])
+            stale = true;
+        driverStates[i] = state;
+    }
+    return stale;
+}
+
+// True if an earlier driver or measurement already emitted this family,
+// name is in RAM and the schema names in flash
+static bool isEmitted(int driver, int measurement, const char *name)
+{
+    for (int i = 0; i <= driver; i++)
+    {
+        const Measurement *schema;
+        const int32_t *values;
+        int count = drivers[i]->GetReadings(&schema, &values);
+        if (i == driver)
+            count = measurement;
+        for (int j = 0; j < count; j++)
+            if (strcmp_P(name, schema[j].name) == 0)
+                return true;
+    }
+    return false;
+}
+
+// One family per measurement name with a sample for each valid driver
+static void appendReadings()
+{
+    for (int i = 0; i < drivers_count; i++)
+    {
+        const Measurement *schema;
+        const int32_t *values;
+        int count = drivers[i]->GetReadings(&schema, &values);
+        for (int j = 0; j < count; j++)
+        {
+            char name[32];
+            strncpy_P(name, schema[j].name, sizeof(name) - 1);
+            name[sizeof(name) - 1] = '\0';
+            if (isEmitted(i, j, name))
+                continue;
+            append(PSTR("# TYPE elms_%s gauge\n"), name);
+            for (int k = i; k < drivers_count; k++)
+            {
+                if (!drivers[k]->IsLastReadingValid())
+                    continue;
+                const Measurement *s;
+                const int32_t *v;
+                int n = drivers[k]->GetReadings(&s, &v);
+                for (int m = 0; m < n; m++)
+                {
+                    if (strcmp_P(name, s[m].name) != 0)
+                        continue;
+                    char value[16];
+                    FormatFixed(value, v[m], s[m].decimals);
+                    append(PSTR("elms_%s{id=\"%s\"} %s\n"), name, drivers[k]->GetId(), value);
+                }
+            }
+        }
+    }
+}
+
+// Non-zero filter reject counters, labelled with the stage
+static void appendRejects()
+{
+    bool typed = false;
+    for (int i = 0; i < drivers_count; i++)
+    {
+        const Measurement *schema;
+        const int32_t *values;
+        int count = drivers[i]->GetReadings(&schema, &values);
+        for (int j = 0; j < count; j++)
+        {
+            FilterChain *filter = drivers[i]->GetFilter(j);
+            for (int k = -1; k < filter->GetStageCount(); k++)
+            {
+                if (filter->GetRejects(k) == 0)
+                    continue;
+                if (!typed)
+                    append(PSTR("# TYPE elms_filter_rejects_total counter\n"));
+                typed = true;
+                char name[24];
+                strncpy_P(name, schema[j].name, sizeof(name) - 1);
+                name[sizeof(name) - 1] = '\0';
+                char stage[12];
+                strncpy_P(stage, filter->GetStageName(k), sizeof(stage) - 1);
+                stage[sizeof(stage) - 1] = '\0';
+                append(PSTR("elms_filter_rejects_total{id=\"%s\",measurement=\"%s\",filter=\"%s\"} %u\n"),
+                       drivers[i]->GetId(), name, stage, filter->GetRejects(k));
+            }
+        }
+    }
+}
+
+// Health score and read counters of every driver
+static void appendHealth()
+{
+    append(PSTR("# TYPE elms_sensor_health gauge\n"));
+    for (int i = 0; i < drivers_count; i++)
+        append(PSTR("elms_sensor_health{id=\"%s\"} %i\n"), drivers[i]->GetId(), drivers[i]->GetHealth()->GetScore());
+    append(PSTR("# TYPE elms_sensor_reads_total counter\n"));
+    for (int i = 0; i < drivers_count; i++)
+    {
+        SensorHealth *health = drivers[i]->GetHealth();
+        append(PSTR("elms_sensor_reads_total{id=\"%s\",result=\"ok\"} %u\n"), drivers[i]->GetId(), health->GetSuccesses());
+        append(PSTR("elms_sensor_reads_total{id=\"%s\",result=\"failed\"} %u\n"), drivers[i]->GetId(), health->GetFailures());
+    }
+}
+
+// The driver families, which only change when a sensor is read
+static void appendDrivers()
+{
+    appendReadings();
+    appendRejects();
+    appendHealth();
+}
+
+static void build()
+{
+    bodyLen = 0;
+    bodyOverflowed = false;
+    appendDrivers();
+    // Said once, the node doesn't gain drivers while it runs
+    if (bodyOverflowed && !bodyBuilt)
+        Serial.printf_P(PSTR("Metrics over %i bytes, sent uncached\n"), METRICS_BODY_SIZE);
+    bodyBuilt = true;
+}
+
+// Board counters change all the time so are never cached, returns the
+// length
+static int describeBoard(char *buf, int size)
+{
+    char reason[24];
+    strncpy_P(reason, GetResetReasonName(getResetReason()), sizeof(reason) - 1);
+    reason[sizeof(reason) - 1] = '\0';
+    int n = snprintf_P(buf, size,
+                       PSTR("# TYPE elms_free_heap_bytes gauge\nelms_free_heap_bytes %u\n"
+                            "# TYPE elms_heap_fragmentation_percent gauge\nelms_heap_fragmentation_percent %u\n"
+                            "# TYPE elms_uptime_seconds counter\nelms_uptime_seconds %lu\n"
+                            "# TYPE elms_reset_reason gauge\nelms_reset_reason{reason=\"%s\"} %u\n"
+                            "# TYPE elms_packets_sent_total counter\nelms_packets_sent_total %u\n"
+                            "# TYPE elms_dropped_samples_total counter\nelms_dropped_samples_total %u\n"
+                            "# TYPE elms_suppressed_values_total counter\nelms_suppressed_values_total %u\n"),
+                       ESP.getFreeHeap(), ESP.getHeapFragmentation(), millis() / 1000, reason, getResetReason(),
+                       packetsSent, telemetry.GetDroppedSamples(), telemetry.GetSuppressedValues());
+    return min(max(n, 0), size - 1);
+}
+
+// The families are rendered again for each request while they don't
+// fit the body
+static void sendUncached(ESP8266WebServer *server)
+{
+    ChunkWriter writer(server);
+    writer.Begin(200, "text/plain; version=0.0.4");
+    direct = &writer;
+    appendDrivers();
+    direct = nullptr;
+    writer.Write(body, describeBoard(body, METRICS_BOARD_SIZE));
+    writer.End();
+}
+
+void SendMetricsPage(ESP8266WebServer *server)
+{
+    if (isStale())
+        build();
+    if (bodyOverflowed)
+    {
+        sendUncached(server);
+        return;
+    }
+    int boardLen = describeBoard(&body[bodyLen], METRICS_BOARD_SIZE);
+    server->send(200, "text/plain; version=0.0.4", body, bodyLen + boardLen);
+}
@@ -0,0 +1,107 @@
+#include <Arduino.h>
+#include <one_wire_bus.h>
+
+// *** PUBLIC ***
+
+OneWireBus::OneWireBus(OneWire *wire)
+{
+    _wire = wire;
+}
+
+bool OneWireBus::Register(const uint8_t rom[8], OneWireCallback callback, void *context, SensorHealth *health)
+{
+    if (_probeCount >= ONE_WIRE_MAX_PROBES)
+        return false;
+    Probe *probe = &_probes[_probeCount++];
+    memcpy(probe->rom, rom, 8);
+    probe->callback = callback;
+    probe->context = context;
+    probe->health = health;
+    return true;
+}
+
+uint32_t OneWireBus::Handle()
+{
+    if (_probeCount == 0)
+        return ONE_WIRE_PERIOD_MS;
+
+    switch (_state)
+    {
+    case IDLE:
+        if (_started && millis() - _cycleStartMillis < ONE_WIRE_PERIOD_MS)
+            return ONE_WIRE_PERIOD_MS - (millis() - _cycleStartMillis);
+        StartConversion();
+        return ConversionMillis();
+
+    case CONVERTING:
+        if ((long)(millis() - _readAtMillis) < 0)
+            return _readAtMillis - millis();
+        _nextProbe = 0;
+        _state = READING;
+        return 0;
+
+    case READING:
+        ReadProbe(&_probes[_nextProbe++]);
+        if (_nextProbe < _probeCount)
+            return 0;
+        _state = IDLE;
+        return 0;
+    }
+    return 0;
+}
+
+// *** PRIVATE ***
+
+// One Convert T for every probe on the bus
+void OneWireBus::StartConversion()
+{
+    _started = true;
+    _cycleStartMillis = millis();
+    _wire->reset();
+    _wire->skip();
+    _wire->write(0x44, 0);
+    _readAtMillis = millis() + ConversionMillis();
+    _conversions++;
+    _state = CONVERTING;
+}
+
+void OneWireBus::ReadProbe(Probe *probe)
+{
+    // The conversion went to every probe anyway, only the read is saved
+    if (probe->health != nullptr && probe->health->IsBackingOff() && probe->health->GetWaitMs() > 0)
+        return;
+
+    uint8_t data[9];
+    unsigned long start = micros();
+    _wire->reset();
+    _wire->select(probe->rom);
+    _wire->write(0xBE); // Read Scratchpad
+    _wire->read_bytes(data, 9);
+
+    // The config register always has its low 5 bits set, which also
+    // rejects an all zero read (valid CRC) from a missing probe
+    bool valid = OneWire::crc8(data, 8) == data[8] && (data[4] & 0x9F) == 0x1F;
+    if (probe->health != nullptr)
+    {
+        if (valid)
+            probe->health->Success(micros() - start);
+        else
+            probe->health->Failure();
+    }
+    if (!valid)
+        _crcErrors++;
+    else
+    {
+        // Wait long enough for the highest resolution on the bus
+        uint8_t bits = 9 + ((data[4] >> 5) & 0x03);
+        if (probe == &_probes[0] || bits > _resolutionBits)
+            _resolutionBits = bits;
+    }
+    probe->callback(probe->context, valid, data);
+}
+
+// 93.75 ms at 9 bits, doubling for each extra bit
+uint16_t OneWireBus::ConversionMillis()
+{
+    return (750 >> (12 - _resolutionBits)) + 1;
+}
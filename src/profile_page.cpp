@@ -0,0 +1,32 @@
+#include <Arduino.h>
+#include "main.h"
+#include "profile_page.h"
+#include "chunk_writer.h"
+#include "web_args.h"
+
+#if PROFILER
+static void writeProfile(ChunkWriter *writer, const char *name, Profile *profile)
+{
+    writer->Printf_P(PSTR("%-16s %10u %10u %10u %10u %10u\n"), name, profile->GetCount(), profile->GetMinMicros(),
+                     profile->GetAvgMicros(), profile->GetPercentileMicros(99), profile->GetMaxMicros());
+}
+
+void SendProfile(ESP8266WebServer *server)
+{
+    ChunkWriter writer(server);
+    server->sendHeader(F("Cache-Control"), F("no-store"));
+    writer.Begin(200, "text/plain");
+    writer.Printf_P(PSTR("%-16s %10s %10s %10s %10s %10s\n"), "task", "runs", "min_us", "avg_us", "p99_us", "max_us");
+    for (int i = 0; i < scheduler.GetTaskCount(); i++)
+        writeProfile(&writer, scheduler.GetTaskName(i), scheduler.GetProfile(i));
+    writeProfile(&writer, "loop", scheduler.GetLoopProfile());
+    if (scheduler.GetWorstLoopTask() >= 0)
+        writer.Printf_P(PSTR("\nworst loop %u us at %lu ms, longest task %s %u us\n"), scheduler.GetWorstLoopMicros(),
+                        scheduler.GetWorstLoopMillis(), scheduler.GetTaskName(scheduler.GetWorstLoopTask()),
+                        scheduler.GetWorstLoopTaskMicros());
+    writer.End();
+
+    if (FindArg(server, PSTR("reset")) != nullptr)
+        scheduler.ClearProfiles();
+}
+#endif
@@ -0,0 +1,79 @@
+#include <Arduino.h>
+#include <profiler.h>
+
+// Bucket 2k covers [2^k, 1.5 * 2^k) units of 2^PROFILE_BUCKET_SHIFT
+// cycles and bucket 2k + 1 [1.5 * 2^k, 2^(k + 1)), units below 1 count
+// in bucket 0
+static int bucketOf(uint32_t cycles)
+{
+    uint32_t units = cycles >> PROFILE_BUCKET_SHIFT;
+    if (units < 2)
+        return 0;
+    int octave = 31 - __builtin_clz(units);
+    int bucket = octave * 2 + (units >> (octave - 1) & 1);
+    return min(bucket, PROFILE_BUCKETS - 1);
+}
+
+// Cycles at the top of a bucket
+static uint64_t bucketEnd(int bucket)
+{
+    int octave = bucket / 2;
+    uint64_t start = (uint64_t)1 << octave;
+    uint64_t end = bucket & 1 ? start * 2 : start + start / 2;
+    if (bucket == 0)
+        end = 2;
+    return (end << PROFILE_BUCKET_SHIFT) - 1;
+}
+
+// *** PUBLIC ***
+
+void Profile::Add(uint32_t cycles)
+{
+    if (_count == 0 || cycles < _minCycles)
+        _minCycles = cycles;
+    if (cycles > _maxCycles)
+        _maxCycles = cycles;
+    _count++;
+    _totalCycles += cycles;
+
+    int bucket = bucketOf(cycles);
+    if (_buckets[bucket] == UINT16_MAX)
+    {
+        _bucketTotal = 0;
+        for (int i = 0; i < PROFILE_BUCKETS; i++)
+        {
+            _buckets[i] /= 2;
+            _bucketTotal += _buckets[i];
+        }
+    }
+    _buckets[bucket]++;
+    _bucketTotal++;
+}
+
+void Profile::Clear()
+{
+    *this = Profile();
+}
+
+uint32_t Profile::GetPercentileMicros(int percent)
+{
+    if (_bucketTotal == 0)
+        return 0;
+    // The nth smallest duration, rounded up
+    uint32_t rank = ((uint64_t)_bucketTotal * percent + 99) / 100;
+    uint32_t seen = 0;
+    int bucket = 0;
+    for (; bucket < PROFILE_BUCKETS - 1; bucket++)
+    {
+        seen += _buckets[bucket];
+        if (seen >= rank)
+            break;
+    }
+    return ToMicros(min(bucketEnd(bucket), (uint64_t)_maxCycles));
+}
+
+int Profile::Describe(char *buf, int size)
+{
+    int n = snprintf_P(buf, size, PSTR("%u/%u/%u/%u"), GetMinMicros(), GetAvgMicros(), GetPercentileMicros(99), GetMaxMicros());
+    return min(max(n, 0), size - 1);
+}
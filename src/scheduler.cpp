@@ -0,0 +1,187 @@
+#include <scheduler.h>
+
+// *** PUBLIC ***
+
+int Scheduler::Add(const char *name, TaskCallback callback, void *context)
+{
+    if (_taskCount >= SCHEDULER_MAX_TASKS)
+        return -1;
+    if (_taskCount == 0)
+        _windowStartMicros = micros();
+
+    int id = _taskCount++;
+    Task *t = &_tasks[id];
+    t->name = name;
+    t->callback = callback;
+    t->context = context;
+    t->deadlineMicros = micros();
+    t->runs = 0;
+    t->totalLatenessMicros = 0;
+    t->maxLatenessMicros = 0;
+#if PROFILER
+    t->profile.Clear();
+#endif
+#if ALLOC_HOOK
+    t->allocs = 0;
+#endif
+    t->heapIndex = id;
+    _heap[id] = id;
+    SiftUp(id);
+    return id;
+}
+
+void Scheduler::Wake(int id, uint32_t delayMs)
+{
+    if (id < 0 || id >= _taskCount)
+        return;
+    Task *t = &_tasks[id];
+    unsigned long deadline = micros() + delayMs * 1000UL;
+    if ((long)(deadline - t->deadlineMicros) >= 0)
+        return;
+    t->deadlineMicros = deadline;
+    SiftUp(t->heapIndex);
+}
+
+void Scheduler::Run()
+{
+#if PROFILER
+    uint32_t passStart = PROFILE_CYCLES();
+    int longestTask = -1;
+    uint32_t longestCycles = 0;
+#endif
+    // Bounded so a task that keeps asking for 0 ms can't starve loop()
+    for (int n = 0; n < _taskCount; n++)
+    {
+        int id = _heap[0];
+        Task *t = &_tasks[id];
+        unsigned long now = micros();
+        if ((long)(now - t->deadlineMicros) < 0)
+            break;
+
+        uint32_t lateness = now - t->deadlineMicros;
+        t->totalLatenessMicros += lateness;
+        if (lateness > t->maxLatenessMicros)
+            t->maxLatenessMicros = lateness;
+        t->runs++;
+
+#if PROFILER
+        uint32_t start = PROFILE_CYCLES();
+#endif
+#if ALLOC_HOOK
+        uint32_t allocs = GetAllocCounts().allocs;
+#endif
+        uint32_t delayMs = t->callback(t->context);
+#if ALLOC_HOOK
+        t->allocs += GetAllocCounts().allocs - allocs;
+#endif
+#if PROFILER
+        uint32_t cycles = PROFILE_CYCLES() - start;
+        t->profile.Add(cycles);
+        if (longestTask < 0 || cycles > longestCycles)
+        {
+            longestTask = id;
+            longestCycles = cycles;
+        }
+#endif
+        t->deadlineMicros = micros() + delayMs * 1000UL;
+        SiftDown(t->heapIndex);
+    }
+
+#if PROFILER
+    // Passes where nothing was due aren't counted
+    if (longestTask < 0)
+        return;
+    uint32_t passCycles = PROFILE_CYCLES() - passStart;
+    _loopProfile.Add(passCycles);
+    if (passCycles > _worstLoopCycles)
+    {
+        _worstLoopCycles = passCycles;
+        _worstLoopMillis = millis();
+        _worstLoopTask = longestTask;
+        _worstLoopTaskCycles = longestCycles;
+    }
+#endif
+}
+
+// delay() yields to the WiFi stack, which lets the SDK drop into modem
+// (or light, if enabled) sleep between beacons
+void Scheduler::Idle()
+{
+    if (_taskCount == 0)
+        return;
+
+    unsigned long elapsed = micros() - _windowStartMicros;
+    if (elapsed >= SCHEDULER_IDLE_WINDOW_MS * 1000UL)
+    {
+        _idlePercent = (uint64_t)_windowSleptMicros * 100 / elapsed;
+        _windowStartMicros = micros();
+        _windowSleptMicros = 0;
+    }
+
+    long wait = (long)(_tasks[_heap[0]].deadlineMicros - micros());
+    if (wait < 1000)
+    {
+        yield();
+        return;
+    }
+    unsigned long ms = min((unsigned long)wait / 1000, (unsigned long)SCHEDULER_MAX_SLEEP_MS);
+    unsigned long start = micros();
+    delay(ms);
+    _windowSleptMicros += micros() - start;
+}
+
+#if PROFILER
+void Scheduler::ClearProfiles()
+{
+    for (int i = 0; i < _taskCount; i++)
+        _tasks[i].profile.Clear();
+    _loopProfile.Clear();
+    _worstLoopCycles = 0;
+    _worstLoopMillis = 0;
+    _worstLoopTask = -1;
+    _worstLoopTaskCycles = 0;
+}
+#endif
+
+// *** PRIVATE ***
+
+bool Scheduler::IsBefore(int a, int b)
+{
+    return (long)(_tasks[_heap[a]].deadlineMicros - _tasks[_heap[b]].deadlineMicros) < 0;
+}
+
+void Scheduler::Swap(int a, int b)
+{
+    uint8_t t = _heap[a];
+    _heap[a] = _heap[b];
+    _heap[b] = t;
+    _tasks[_heap[a]].heapIndex = a;
+    _tasks[_heap[b]].heapIndex = b;
+}
+
+void Scheduler::SiftUp(int i)
+{
+    while (i > 0 && IsBefore(i, (i - 1) / 2))
+    {
+        Swap(i, (i - 1) / 2);
+        i = (i - 1) / 2;
+    }
+}
+
+void Scheduler::SiftDown(int i)
+{
+    while (true)
+    {
+        int smallest = i;
+        int left = 2 * i + 1;
+        int right = left + 1;
+        if (left < _taskCount && IsBefore(left, smallest))
+            smallest = left;
+        if (right < _taskCount && IsBefore(right, smallest))
+            smallest = right;
+        if (smallest == i)
+            return;
+        Swap(i, smallest);
+        i = smallest;
+    }
+}
@@ -0,0 +1,58 @@
+#include <Arduino.h>
+#include <sensor_driver.h>
+
+static constexpr char healthName[] PROGMEM = "health";
+static constexpr char healthLabel[] PROGMEM = "Health (%)";
+// Sent on a 5 point change or every 15 minutes
+const Measurement healthMeasurement = {healthName, healthLabel, 0, 0, 100, nullptr, 5, 15 * 60};
+
+// *** PUBLIC ***
+
+void SensorHealth::Success(uint32_t latencyMicros)
+{
+    _score += ((100 << 8) - _score) / SENSOR_HEALTH_WEIGHT;
+    if (_successes == 0 || latencyMicros < _minLatency)
+        _minLatency = latencyMicros;
+    if (latencyMicros > _maxLatency)
+        _maxLatency = latencyMicros;
+    _totalLatency += latencyMicros;
+    _successes++;
+    _failuresInRow = 0;
+}
+
+void SensorHealth::Failure()
+{
+    _score -= _score / SENSOR_HEALTH_WEIGHT;
+    _failures++;
+    _failuresInRow++;
+    _lastFailureMillis = millis();
+}
+
+uint32_t SensorHealth::GetWaitMs()
+{
+    if (_failuresInRow == 0)
+        return 0;
+    // The normal poll period after one failure, doubling with each more
+    uint32_t backoff = SENSOR_MAX_BACKOFF_MS;
+    if (_failuresInRow < 16)
+        backoff = min((uint32_t)SENSOR_POLL_MS << (_failuresInRow - 1), (uint32_t)SENSOR_MAX_BACKOFF_MS);
+    unsigned long elapsed = millis() - _lastFailureMillis;
+    return elapsed >= backoff ? 0 : backoff - elapsed;
+}
+
+int SensorHealth::Describe(char *buf, int size)
+{
+    int n;
+    if (IsBackingOff())
+        n = snprintf_P(buf, size, PSTR("%i%% (%u ok, %u failed), retry in %u s after %u failures"), GetScore(),
+                       _successes, _failures, (GetWaitMs() + 999) / 1000, _failuresInRow);
+    else
+        n = snprintf_P(buf, size, PSTR("%i%% (%u ok, %u failed)"), GetScore(), _successes, _failures);
+    return min(max(n, 0), size - 1);
+}
+
+int SensorHealth::DescribeLatency(char *buf, int size)
+{
+    int n = snprintf_P(buf, size, PSTR("%u/%u/%u"), _minLatency, GetAvgLatencyMicros(), _maxLatency);
+    return min(max(n, 0), size - 1);
+}
@@ -0,0 +1,202 @@
+#include <Arduino.h>
+#include <series_block.h>
+
+// Width of a value, and the field sizes of a new window of meaningful bits
+#define VALUE_BITS 32
+#define LEADING_BITS 5
+#define LENGTH_BITS 5
+
+// Writes a string from flash or RAM as a length byte and the characters
+static int writeText(uint8_t *buf, int size, const char *text, bool flash)
+{
+    int len = flash ? strlen_P(text) : strlen(text);
+    if (len > UINT8_MAX || 1 + len > size)
+        return -1;
+    buf[0] = len;
+    if (flash)
+        memcpy_P(&buf[1], text, len);
+    else
+        memcpy(&buf[1], text, len);
+    return 1 + len;
+}
+
+// *** PUBLIC ***
+
+bool SeriesBlock::Begin(uint8_t *buf, int size, SensorDriver *driver, uint8_t flags)
+{
+    const Measurement *schema;
+    const int32_t *values;
+    int fieldCount = driver->GetReadings(&schema, &values);
+    _count = 0;
+    if (fieldCount > SERIES_BLOCK_MAX_FIELDS || size < 4)
+        return false;
+
+    // Length, flags, id and the schema
+    memset(buf, 0, size);
+    int at = 2;
+    buf[at++] = flags;
+    int len = writeText(&buf[at], size - at, driver->GetId(), false);
+    if (len < 0 || at + len >= size)
+        return false;
+    at += len;
+    buf[at++] = fieldCount;
+    for (int i = 0; i < fieldCount; i++)
+    {
+        len = writeText(&buf[at], size - at, schema[i].name, true);
+        if (len < 0 || at + len >= size)
+            return false;
+        at += len;
+        buf[at++] = schema[i].decimals;
+    }
+
+    // Then the sample count and first timestamp, filled in later
+    if (at + 2 + 8 > size)
+        return false;
+    _buf = buf;
+    _size = size;
+    _countOffset = at;
+    _bitsOffset = at + 2 + 8;
+    _bits = 0;
+    _overflow = false;
+    _flags = flags;
+    _fieldCount = fieldCount;
+    return true;
+}
+
+bool SeriesBlock::Append(uint64_t time, const int32_t *values)
+{
+    if (_buf == nullptr)
+        return false;
+
+    // Kept to undo a sample that doesn't fit
+    uint32_t bits = _bits;
+    uint64_t lastTime = _time;
+    int64_t delta = _delta;
+    Field fields[SERIES_BLOCK_MAX_FIELDS];
+    memcpy(fields, _fields, sizeof(fields));
+
+    if (_count == 0)
+    {
+        memcpy(&_buf[_countOffset + 2], &time, sizeof(time));
+        _time = time;
+        _delta = 0;
+        for (int i = 0; i < _fieldCount; i++)
+        {
+            WriteBits(values[i], VALUE_BITS);
+            _fields[i] = {values[i], VALUE_BITS, VALUE_BITS};
+        }
+    }
+    else
+    {
+        WriteTime(time);
+        for (int i = 0; i < _fieldCount; i++)
+            WriteValue(&_fields[i], values[i]);
+    }
+
+    if (_overflow || _count == UINT16_MAX)
+    {
+        // Clear what was written past the last sample
+        uint32_t end = _bits;
+        if (end > (uint32_t)(_size - _bitsOffset) * 8)
+            end = (_size - _bitsOffset) * 8;
+        for (uint32_t pos = bits; pos < end; pos++)
+            _buf[_bitsOffset + pos / 8] &= ~(0x80 >> (pos % 8));
+        _bits = bits;
+        _time = lastTime;
+        _delta = delta;
+        memcpy(_fields, fields, sizeof(fields));
+        _overflow = false;
+        return false;
+    }
+    _count++;
+    return true;
+}
+
+int SeriesBlock::Finish()
+{
+    uint16_t len = _bitsOffset + (_bits + 7) / 8;
+    memcpy(_buf, &len, sizeof(len));
+    memcpy(&_buf[_countOffset], &_count, sizeof(_count));
+    return len;
+}
+
+// *** PRIVATE ***
+
+// Appends the low count bits of value, most significant first
+void SeriesBlock::WriteBits(uint32_t value, int count)
+{
+    uint32_t limit = (_size - _bitsOffset) * 8;
+    for (int i = count - 1; i >= 0; i--, _bits++)
+    {
+        if (_bits >= limit)
+        {
+            _overflow = true;
+            return;
+        }
+        if (value >> i & 1)
+            _buf[_bitsOffset + _bits / 8] |= 0x80 >> (_bits % 8);
+    }
+}
+
+void SeriesBlock::WriteTime(uint64_t time)
+{
+    int64_t delta = (int64_t)(time - _time);
+    int64_t dod = delta - _delta;
+    _time = time;
+    _delta = delta;
+    if (dod == 0)
+        WriteBits(0, 1);
+    else if (dod >= -64 && dod <= 63)
+    {
+        WriteBits(0x2, 2);
+        WriteBits(dod, 7);
+    }
+    else if (dod >= -256 && dod <= 255)
+    {
+        WriteBits(0x6, 3);
+        WriteBits(dod, 9);
+    }
+    else if (dod >= -2048 && dod <= 2047)
+    {
+        WriteBits(0xe, 4);
+        WriteBits(dod, 12);
+    }
+    else if (dod >= INT32_MIN && dod <= INT32_MAX)
+    {
+        WriteBits(0xf, 4);
+        WriteBits(dod, 32);
+    }
+    else
+        // A clock jump, start a new block
+        _overflow = true;
+}
+
+void SeriesBlock::WriteValue(Field *field, int32_t value)
+{
+    uint32_t xored = (uint32_t)value ^ (uint32_t)field->value;
+    field->value = value;
+    if (xored == 0)
+    {
+        WriteBits(0, 1);
+        return;
+    }
+
+    uint8_t leading = __builtin_clz(xored);
+    uint8_t trailing = __builtin_ctz(xored);
+    if (leading >= field->leading && trailing >= field->trailing)
+    {
+        // Fits the previous window
+        WriteBits(0x2, 2);
+        WriteBits(xored >> field->trailing, VALUE_BITS - field->leading - field->trailing);
+        return;
+    }
+
+    // A new window, xored isn't 0 so leading fits in 5 bits
+    uint8_t meaningful = VALUE_BITS - leading - trailing;
+    WriteBits(0x3, 2);
+    WriteBits(leading, LEADING_BITS);
+    WriteBits(meaningful - 1, LENGTH_BITS);
+    WriteBits(xored >> trailing, meaningful);
+    field->leading = leading;
+    field->trailing = trailing;
+}
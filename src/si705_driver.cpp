@@ -1,80 +1,88 @@
 #include <Arduino.h>
 #include <si705_driver.h>
+#include <arena.h>
+
+// 14-bit conversion takes up to 10.8ms
+#define SI705_CONVERSION_MS 11
+
+// temperature,id=SLc25732 value=29.5556
+static constexpr char temperatureName[] PROGMEM = "temperature";
+static constexpr char temperatureLabel[] PROGMEM = "Temprature (C)";
+static constexpr Measurement schema[] = {
+    {temperatureName, temperatureLabel, 4, MIN_SANE_VALUE * 10000, MAX_SANE_VALUE * 10000, nullptr, 500, 0}};
+static_assert(MaxLineProtocolLength(schema) <= MAX_PACKET_DATA, "Si705 packet data too long");
+
+// A misread is replaced by the median of 3, counted past 0.5 C
+static constexpr FilterStage filters[] = {{FILTER_MEDIAN, 3, 5000}};
 
 // *** PUBLIC ***
 
 // Scan for device and create a driver if found
-int Si705Driver::CreateDriverInstances(TwoWire *i2c, SensorDriver *firstInstance[], int maxInstances)
+int Si705Driver::CreateDriverInstances(I2cBus *bus, SensorDriver *firstInstance[], int maxInstances)
 {
     if (maxInstances < 1)
         return 0;
     int instances = 0;
+    TwoWire *i2c = bus->GetWire();
 
     // Si705 can be at 0x40
     i2c->beginTransmission(0x40);
     uint8_t e = i2c->endTransmission();
-    Serial.printf("Si705Driver endTransmission %i\n", e);
-    if (e == 0)
-        firstInstance[instances++] = new Si705Driver(i2c, 0x40);
+    Serial.printf_P(PSTR("Si705Driver endTransmission %i\n"), e);
+    void *p = e == 0 ? driverArena.Allocate(sizeof(Si705Driver), alignof(Si705Driver)) : nullptr;
+    if (p != nullptr)
+        firstInstance[instances++] = new (p) Si705Driver(bus, 0x40);
     return instances;
 }
 
 int Si705Driver::GetPacketData(char *ptr)
 {
-    char t[16];
-    dtostrf((double)_lastReadingCelsius, 1, 4, t);
-    // temperature,id=SLc25732 value=29.5556
-    return sprintf(ptr, "temperature,id=%s value=%s\n", _id, t);
+    return EncodeLineProtocol(ptr, schema, _id, &_lastReadingCelsius);
 }
 
-void Si705Driver::Handle()
+uint32_t Si705Driver::Handle()
 {
-    // Take a temprature reading every 5 seconds
-    if ((unsigned long)(millis() - _lastPollMillis) < 5000)
-        return;
-
+    // Take a temprature reading every 5 seconds, less often if failing
+    uint32_t wait = _health.GetWaitMs();
+    if (wait > 0)
+        return wait;
+    unsigned long elapsed = millis() - _lastPollMillis;
+    if (elapsed < SENSOR_POLL_MS)
+        return SENSOR_POLL_MS - elapsed;
+
+    // Measure (no hold master mode) and read the result once the
+    // conversion is done, the bus is free in between
+    const uint8_t measure = 0xF3;
+    if (!_bus->Queue(_address, &measure, 1, 2, SI705_CONVERSION_MS, OnReading, this))
+        return SENSOR_RETRY_MS;
     _lastPollMillis = millis();
-
-    // Read last temprature (avoid reading garbage on first call)
-    if (_conversionStarted)
-    {
-        _i2c->requestFrom(_address, 2);
-        byte msb = _i2c->read();
-        byte lsb = _i2c->read();
-        uint16_t val = msb << 8 | lsb;
-        _lastReadingCelsius = (175.72 * val) / 65536 - 46.85;
-
-        // Sanity check
-        _lastReadingValid = _lastReadingCelsius >= MIN_SANE_VALUE && _lastReadingCelsius <= MAX_SANE_VALUE;
-    }
-
-    // Start next conversion
-    _i2c->beginTransmission(_address);
-    _i2c->write(0xF3);
-    _i2c->endTransmission();
-    _conversionStarted = true;
-
-    // Debug output
-    Serial.print(_id);
-    Serial.println(" updated");
+    _queuedMicros = micros();
+    return SENSOR_POLL_MS;
 }
 
-void Si705Driver::GetValues(void cb(const char *, const char *))
+void Si705Driver::GetValues(void cb(const __FlashStringHelper *, const char *))
 {
     char val[64];
     // Call back with name value pairs
-    cb("Device", _chipType);
-    sprintf(val, " %#x", _address);
-    cb("Address", val);
-    cb("Id", _id);
+    cb(F("Device"), _chipType);
+    sprintf_P(val, PSTR(" %#x"), _address);
+    cb(F("Address"), val);
+    cb(F("Id"), _id);
 
     if (!_lastReadingValid)
     {
-        cb("ERROR", InsaneTemprature);
+        cb(F("ERROR"), strcpy_P(val, InsaneTemprature));
         return;
     }
 
-    cb("Temprature (C)", dtostrf((double)_lastReadingCelsius, 1, 4, val));
+    EncodeValues(cb, schema, &_lastReadingCelsius);
+}
+
+int Si705Driver::GetReadings(const Measurement **schemaOut, const int32_t **values)
+{
+    *schemaOut = schema;
+    *values = &_lastReadingCelsius;
+    return sizeof(schema) / sizeof(schema[0]);
 }
 
 // *** PRIVATE ***
@@ -99,7 +107,11 @@ uint8_t Si705Driver::readChipType()
     _i2c->write(0xfc);
     _i2c->write(0xc9);
     _i2c->endTransmission();
-    _i2c->requestFrom(_address, 6);
+    if (_i2c->requestFrom(_address, 6) != 6)
+    {
+        _health.Failure();
+        return 0;
+    }
     int chipType = _i2c->read();
     for (int i = 0; i < 5; i++)
         _i2c->read();
@@ -114,21 +126,64 @@ uint8_t Si705Driver::readFirmwareVersion()
     _i2c->write(0x84);
     _i2c->write(0xB8);
     _i2c->endTransmission();
-    _i2c->requestFrom(_address, 1);
+    if (_i2c->requestFrom(_address, 1) != 1)
+    {
+        _health.Failure();
+        return 0;
+    }
     return _i2c->read();
 }
 
+// Completion of a queued measurement
+void Si705Driver::OnReading(void *context, uint8_t status, const uint8_t *data, uint8_t len)
+{
+    Si705Driver *driver = (Si705Driver *)context;
+    if (status != I2C_OK)
+    {
+        driver->_health.Failure();
+        driver->_generation++;
+        driver->_lastReadingValid = false;
+        return;
+    }
+
+    // 175.72 * val / 65536 - 46.85 in 1/10000 C, rounded
+    uint16_t val = data[0] << 8 | data[1];
+    int32_t raw = (int32_t)(((uint64_t)1757200 * val + 32768) >> 16) - 468500;
+
+    // A rejected glitch keeps the last reading, one out of range is a
+    // failed read
+    FilterResult result = driver->_filter.Add(raw, &driver->_lastReadingCelsius);
+    if (result == FILTER_OUT_OF_RANGE)
+        driver->_health.Failure();
+    else
+        driver->_health.Success(micros() - driver->_queuedMicros);
+    if (result == FILTER_REJECTED || result == FILTER_PENDING)
+        return;
+    driver->_generation++;
+    driver->_lastReadingValid = result == FILTER_PASSED;
+
+    // Debug output
+    Serial.print(driver->_id);
+    Serial.println(F(" updated"));
+}
+
 // Construct a driver for a Si7051 device at address
-Si705Driver::Si705Driver(TwoWire *i2c, int address)
+Si705Driver::Si705Driver(I2cBus *bus, int address)
 {
-    _i2c = i2c;
+    _bus = bus;
+    _i2c = bus->GetWire();
     _address = address;
+    _filter.Begin(&schema[0], filters, _filterState);
 
     // Get chip type
-    sprintf(_chipType, "Si705%c", (readChipType() - 0x32) + '0');
+    uint8_t chipType = readChipType();
+    if (chipType >= 0x32 && chipType <= 0x37)
+        sprintf_P(_chipType, PSTR("Si705%c"), (chipType - 0x32) + '0');
+    else
+        strcpy_P(_chipType, PSTR("Si705?"));
 
     // Unique id is SL - ESP8266 id
-    sprintf(_id, "SL%x", ESP.getChipId());
+    sprintf_P(_id, PSTR("SL%x"), ESP.getChipId());
 
     // 14-bit measurement resolution
     set14BitResolution();
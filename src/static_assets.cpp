@@ -0,0 +1,31 @@
+#include <Arduino.h>
+#include "static_assets.h"
+#include "static_assets_data.h"
+
+static void sendAsset(ESP8266WebServer *server, const StaticAsset *asset)
+{
+    server->sendHeader(F("ETag"), asset->etag);
+    if (asset->immutable)
+        server->sendHeader(F("Cache-Control"), F(STATIC_ASSET_IMMUTABLE_CACHE));
+    else
+        server->sendHeader(F("Cache-Control"), F(STATIC_ASSET_PAGE_CACHE));
+
+    // Repeat view, nothing to send
+    if (server->header(F("If-None-Match")) == asset->etag)
+    {
+        server->send(304);
+        return;
+    }
+
+    server->sendHeader(F("Content-Encoding"), F("gzip"));
+    server->send_P(200, asset->contentType, (PGM_P)asset->gzip, asset->length);
+}
+
+void RegisterStaticAssets(ESP8266WebServer *server)
+{
+    for (const StaticAsset &asset : staticAssets)
+    {
+        const StaticAsset *a = &asset;
+        server->on(a->uri, HTTP_GET, [server, a]() { sendAsset(server, a); });
+    }
+}
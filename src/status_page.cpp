@@ -2,176 +2,287 @@
 #include <ESP8266WiFi.h>
 #include "main.h"
 #include "status_page.h"
+#include "chunk_writer.h"
+#include "arena.h"
 
-const char *head = R"(
-<head>
-<meta charset="utf-8">
-<meta name="viewport" content="width=device-width,initial-scale=1,shrink-to-fit=no,viewport-fit=cover">
-</head>)";
-
-const char *style = R"(
-<style>
-body {
-background-color: #202020;
-font-family: "San Francisco", "Segoe UI", sans-serif;
-}
-.board {
-border-radius: 4px;
-display: table;
-padding: 8px;
-background-color: rgb(64, 51, 153);
-color: rgb(223, 223, 223);
-margin-bottom: 4px;
-}
-.sensor {
-border-radius: 4px;
-display: table;
-padding: 8px;
-background-color: rgb(163, 93, 36);
-color: rgb(223, 223, 223);
-margin-bottom: 4px;
-}
-.row {
-display: table-row;
-}
-.anno {
-display: table-cell;
-color: #a8a8a8;
-font-weight: 500;
-padding: 2px
-}
-.data {
-display: table-cell;
-padding: 2px
-}
-input {
-border-style: solid;
-border-color: brown;
-background-color: black;
-color: rgb(223, 223, 223);;
-margin-top: 10px;
-height: 30px;
-width: 130px;
-display: block;
-}
-input:active {
-background-color: #404040;
-}
-input:focus {
-outline-color: darkred;
-}
-</style>)";
-
-const char *boardBegin = R"(
+// Board and sensor rows, the page around them is web/status.html
+static const char boardBegin[] PROGMEM = R"(
 <div class="board">)";
 
-const char *boardRow = R"(
+static const char boardRow[] PROGMEM = R"(
 <div class="row">
 <div class="anno">%s</div>
 <div class="data">%s</div>
 </div>)";
 
-const char *boardEnd = R"(
+static const char boardEnd[] PROGMEM = R"(
 </div>)";
 
-const char *sensorBegin = R"(
-<div class="sensor">)";
+static const char sensorBegin[] PROGMEM = R"(
+<div class="sensor" id="s-%s">)";
 
-const char *sensorRow = R"(
+static const char sensorRow[] PROGMEM = R"(
 <div class="row">
 <div class="anno">%s</div>
 <div class="data">%s</div>
 </div>)";
 
-const char *sensorEnd = R"(
+static const char sensorEnd[] PROGMEM = R"(
 </div>)";
 
-const char *buttons = R"(
-<div>
-<form method="post" action="/commands">
-<input type="submit" value="RESTART" name="restart">
-<input type="submit" value="RECALIBRATE" name="recalibrate">
-</form>
-</div>)";
+// Page content is streamed to the client as it is generated
+ChunkWriter *page;
 
-// Web page
-char webPage[8192];
-int webPageLen = 0;
+// Prints a row template with a name from flash and a value from RAM
+static void printRow(PGM_P row, PGM_P name, const char *value)
+{
+    char n[40];
+    strncpy_P(n, name, sizeof(n) - 1);
+    n[sizeof(n) - 1] = '\0';
+    page->Printf_P(row, n, value);
+}
 
-const char *BuildStatusPage()
+// Reject counters of the measurements that filter more than the range
+// or have had out of range values
+static void printFilterRows(SensorDriver *driver)
 {
-    // Html head
-    strcpy(webPage, "<html lang=\"en\">");
-    strcat(webPage, head);
+    const Measurement *schema;
+    const int32_t *values;
+    int count = driver->GetReadings(&schema, &values);
+    for (int i = 0; i < count; i++)
+    {
+        FilterChain *filter = driver->GetFilter(i);
+        if (filter->GetStageCount() == 0 && filter->GetRejects(-1) == 0)
+            continue;
+        char measurement[24];
+        strncpy_P(measurement, schema[i].name, sizeof(measurement) - 1);
+        measurement[sizeof(measurement) - 1] = '\0';
+        char name[40];
+        snprintf_P(name, sizeof(name), PSTR("Rejects (%s)"), measurement);
+        char value[64];
+        filter->Describe(value, sizeof(value));
+        page->Printf_P(sensorRow, name, value);
+    }
+}
 
-    // body
-    strcat(webPage, "<body>");
+// Read counters, backoff and latency
+static void printHealthRows(SensorDriver *driver)
+{
+    SensorHealth *health = driver->GetHealth();
+    char value[80];
+    health->Describe(value, sizeof(value));
+    printRow(sensorRow, PSTR("Health"), value);
+    if (health->GetSuccesses() == 0)
+        return;
+    health->DescribeLatency(value, sizeof(value));
+    printRow(sensorRow, PSTR("Read Latency (us min/avg/max)"), value);
+}
 
-    // Html page header
-    strcat(webPage, style);
-    webPageLen = strlen(webPage);
-    char tmp[24];
+PGM_P GetResetReasonName(uint32 reason)
+{
+    switch (reason)
+    {
+    case REASON_DEFAULT_RST:
+        return PSTR("Power On");
+    case REASON_WDT_RST:
+        return PSTR("Hardware Watchdog");
+    case REASON_EXCEPTION_RST:
+        return PSTR("Exception");
+    case REASON_SOFT_WDT_RST:
+        return PSTR("Software Watchdog");
+    case REASON_SOFT_RESTART:
+        return PSTR("Software Restart");
+    case REASON_DEEP_SLEEP_AWAKE:
+        return PSTR("Deep-Sleep Wake");
+    case REASON_EXT_SYS_RST:
+        return PSTR("Power On or Reset Button");
+    default:
+        return PSTR("Unknown");
+    }
+}
+
+char *FormatLocalIp(char *buf)
+{
+    IPAddress ip = WiFi.localIP();
+    sprintf_P(buf, PSTR("%u.%u.%u.%u"), ip[0], ip[1], ip[2], ip[3]);
+    return buf;
+}
+
+int DescribeEvent(const EventRecord *e, char *buf, int size)
+{
+    char reason[32];
+    int n;
+    switch (e->type)
+    {
+    case EVENT_BOOT:
+        strncpy_P(reason, GetResetReasonName(e->arg), sizeof(reason) - 1);
+        reason[sizeof(reason) - 1] = '\0';
+        if (e->arg == REASON_EXCEPTION_RST)
+            n = snprintf_P(buf, size, PSTR("Boot, %s (cause %d)"), reason, e->value);
+        else
+            n = snprintf_P(buf, size, PSTR("Boot, %s"), reason);
+        break;
+    case EVENT_CLOCK_SET:
+        n = snprintf_P(buf, size, PSTR("Clock set"));
+        break;
+    case EVENT_TIME_SYNC_FAILED:
+        if (e->arg == 0)
+            n = snprintf_P(buf, size, PSTR("Clock not set after %d s"), e->value);
+        else
+            n = snprintf_P(buf, size, PSTR("NTP resync stale"));
+        break;
+    case EVENT_TIME_ZONE_FAILED:
+        n = snprintf_P(buf, size, PSTR("Time zone lookup failed %d times"), e->value);
+        break;
+    case EVENT_WIFI_CONNECTED:
+        n = snprintf_P(buf, size, PSTR("WiFi connected, RSSI %d dBm"), e->value);
+        break;
+    case EVENT_WIFI_DISCONNECTED:
+        n = snprintf_P(buf, size, PSTR("WiFi lost, status %u"), e->arg);
+        break;
+    case EVENT_SENSOR_ERROR:
+        n = snprintf_P(buf, size, PSTR("Sensor %#x status:%d bme680Status:%d"), e->arg, e->value >> 8, (int8_t)e->value);
+        break;
+    case EVENT_OTA_START:
+        n = snprintf_P(buf, size, e->arg == 0 ? PSTR("OTA update of sketch") : PSTR("OTA update of file system"));
+        break;
+    case EVENT_OTA_END:
+        n = snprintf_P(buf, size, PSTR("OTA update done"));
+        break;
+    case EVENT_OTA_ERROR:
+        n = snprintf_P(buf, size, PSTR("OTA update failed, error %u"), e->arg);
+        break;
+    default:
+        n = snprintf_P(buf, size, PSTR("Unknown event %u"), e->type);
+        break;
+    }
+    return min(max(n, 0), size - 1);
+}
+
+// Event times as ezTime's default format, "Thursday,
+// 09-Oct-2025 08:53:22 UTC", without its String
+static char *formatTime(char *buf, size_t size, time_t t)
+{
+    struct tm tm;
+    gmtime_r(&t, &tm);
+    strftime(buf, size, "%A, %d-%b-%Y %H:%M:%S UTC", &tm);
+    return buf;
+}
+
+void SendStatusPage(ESP8266WebServer *server)
+{
+    ChunkWriter writer(server);
+    page = &writer;
+    server->sendHeader(F("Cache-Control"), F("no-store"));
+    page->Begin(200, "text/html");
+    char tmp[48];
 
     // Board info
-    webPageLen += sprintf(&webPage[webPageLen], boardBegin);
-    webPageLen += sprintf(&webPage[webPageLen], boardRow, "Host Name", hostname);
-    webPageLen += sprintf(&webPage[webPageLen], boardRow, "IP", WiFi.localIP().toString().c_str());
-    webPageLen += sprintf(&webPage[webPageLen], boardRow, "CPU Speed (MHz)", itoa(ESP.getCpuFreqMHz(), tmp, 10));
-    webPageLen += sprintf(&webPage[webPageLen], boardRow, "Free Heap (bytes)", itoa(ESP.getFreeHeap(), tmp, 10));
-    webPageLen += sprintf(&webPage[webPageLen], boardRow, "Heap Frag (%)", itoa(ESP.getHeapFragmentation(), tmp, 10));
-    webPageLen += sprintf(&webPage[webPageLen], boardRow, "Poll Period (ms)", itoa(POLL_PERIOD_MS, tmp, 10));
-    // Startup log
-    for (int i = 0; i < MAX_STARTUP_LOG_ENTRIES && startupLog[i].time != 0; i++)
+    page->Write_P(boardBegin);
+    printRow(boardRow, PSTR("Host Name"), hostname);
+    printRow(boardRow, PSTR("IP"), FormatLocalIp(tmp));
+    printRow(boardRow, PSTR("CPU Speed (MHz)"), itoa(ESP.getCpuFreqMHz(), tmp, 10));
+    printRow(boardRow, PSTR("Free Heap (bytes)"), itoa(ESP.getFreeHeap(), tmp, 10));
+    printRow(boardRow, PSTR("Heap Frag (%)"), itoa(ESP.getHeapFragmentation(), tmp, 10));
+    snprintf_P(tmp, sizeof(tmp), PSTR("%u/%u"), (unsigned)driverArena.GetUsed(), (unsigned)driverArena.GetSize());
+    printRow(boardRow, PSTR("Driver Arena (bytes)"), tmp);
+#if ALLOC_HOOK
+    char heapPasses[64];
+    snprintf_P(heapPasses, sizeof(heapPasses), PSTR("%u of %u, max %u allocs, last at %lu s"), allocTracker.GetHeapPasses(),
+               allocTracker.GetPasses(), allocTracker.GetMaxPassAllocs(), allocTracker.GetLastHeapMillis() / 1000);
+    printRow(boardRow, PSTR("Loops Using Heap"), heapPasses);
+#endif
+    printRow(boardRow, PSTR("Sample Period (ms)"), itoa(SAMPLE_PERIOD_MS, tmp, 10));
+    printRow(boardRow, PSTR("Flush Period (ms)"), itoa(FLUSH_PERIOD_MS, tmp, 10));
+    printRow(boardRow, PSTR("Queued Samples (bytes)"), itoa(telemetry.GetQueuedBytes(), tmp, 10));
+    printRow(boardRow, PSTR("Dropped Samples"), itoa(telemetry.GetDroppedSamples(), tmp, 10));
+    printRow(boardRow, PSTR("Suppressed Values"), utoa(telemetry.GetSuppressedValues(), tmp, 10));
+    printRow(boardRow, PSTR("Packets Sent"), itoa(packetsSent, tmp, 10));
+    printRow(boardRow, PSTR("Journal Segments"), itoa(journal.GetSegmentCount(), tmp, 10));
+    printRow(boardRow, PSTR("Packets Replayed"), itoa(packetsReplayed, tmp, 10));
+    printRow(boardRow, PSTR("Journal Segments Dropped"), itoa(journal.GetDroppedSegments(), tmp, 10));
+    printRow(boardRow, PSTR("Journal Corrupt Records"), itoa(journal.GetCorruptRecords(), tmp, 10));
+    printRow(boardRow, PSTR("I2C Transactions"), itoa(i2cBus.GetTransactions(), tmp, 10));
+    printRow(boardRow, PSTR("I2C Errors"), itoa(i2cBus.GetErrors(), tmp, 10));
+    snprintf_P(tmp, sizeof(tmp), PSTR("%u/%u/%u"), i2cBus.GetMinLatencyMicros(), i2cBus.GetAvgLatencyMicros(), i2cBus.GetMaxLatencyMicros());
+    printRow(boardRow, PSTR("I2C Latency (us min/avg/max)"), tmp);
+    printRow(boardRow, PSTR("I2C Longest Step (us)"), itoa(i2cBus.GetMaxStepMicros(), tmp, 10));
+    printRow(boardRow, PSTR("OneWire Conversions"), itoa(oneWireBus.GetConversions(), tmp, 10));
+    printRow(boardRow, PSTR("OneWire CRC Errors"), itoa(oneWireBus.GetCrcErrors(), tmp, 10));
+    printRow(boardRow, PSTR("Event Clients"), itoa(eventStream.GetClientCount(), tmp, 10));
+    printRow(boardRow, PSTR("Event Clients Evicted"), itoa(eventStream.GetEvicted(), tmp, 10));
+    printRow(boardRow, PSTR("Idle (%)"), itoa(scheduler.GetIdlePercent(), tmp, 10));
+    for (int i = 0; i < scheduler.GetTaskCount(); i++)
+    {
+        char name[24];
+        snprintf_P(name, sizeof(name), PSTR("Task %s"), scheduler.GetTaskName(i));
+        char value[64];
+        snprintf_P(value, sizeof(value), PSTR("%u runs, late %u/%u us"), scheduler.GetRuns(i), scheduler.GetAvgLatenessMicros(i), scheduler.GetMaxLatenessMicros(i));
+#if ALLOC_HOOK
+        int len = strlen(value);
+        snprintf_P(&value[len], sizeof(value) - len, PSTR(", %u allocs"), scheduler.GetAllocs(i));
+#endif
+        page->Printf_P(boardRow, name, value);
+    }
+#if PROFILER
+    scheduler.GetLoopProfile()->Describe(tmp, sizeof(tmp));
+    printRow(boardRow, PSTR("Loop (us min/avg/p99/max)"), tmp);
+    if (scheduler.GetWorstLoopTask() >= 0)
     {
-        const char *reason = "";
-        switch (startupLog[i].reason)
-        {
-        case REASON_DEFAULT_RST:
-            reason = "Power On";
-            break;
-        case REASON_WDT_RST:
-            reason = "Hardware Watchdog";
-            break;
-        case REASON_EXCEPTION_RST:
-            reason = "Exception";
-            break;
-        case REASON_SOFT_WDT_RST:
-            reason = "Software Watchdog";
-            break;
-        case REASON_SOFT_RESTART:
-            reason = "Software Restart";
-            break;
-        case REASON_DEEP_SLEEP_AWAKE:
-            reason = "Deep-Sleep Wake";
-            break;
-        case REASON_EXT_SYS_RST:
-            reason = "Power On or Reset Button";
-            break;
-        default:
-            reason = "Unknown";
-            break;
-        }
-        webPageLen += sprintf(&webPage[webPageLen], boardRow, myTZ.dateTime(startupLog[i].time, UTC_TIME).c_str(), reason);
+        char worst[64];
+        snprintf_P(worst, sizeof(worst), PSTR("%u us at %lu s, %s %u us"), scheduler.GetWorstLoopMicros(), scheduler.GetWorstLoopMillis() / 1000,
+                   scheduler.GetTaskName(scheduler.GetWorstLoopTask()), scheduler.GetWorstLoopTaskMicros());
+        printRow(boardRow, PSTR("Worst Loop"), worst);
     }
-    webPageLen += sprintf(&webPage[webPageLen], boardEnd);
+    for (int i = 0; i < scheduler.GetTaskCount(); i++)
+    {
+        char name[48];
+        snprintf_P(name, sizeof(name), PSTR("Time %s (us min/avg/p99/max)"), scheduler.GetTaskName(i));
+        scheduler.GetProfile(i)->Describe(tmp, sizeof(tmp));
+        page->Printf_P(boardRow, name, tmp);
+    }
+#endif
+    // Latest events, by uptime until the clock was set
+    EventRecord events[STATUS_EVENTS];
+    int eventCount = eventLog.Read(0, events, STATUS_EVENTS);
+    for (int i = 0; i < eventCount; i++)
+    {
+        char time[40], event[64];
+        if (events[i].time != 0)
+            formatTime(time, sizeof(time), events[i].time);
+        else
+            snprintf_P(time, sizeof(time), PSTR("Uptime %lu.%03lu s"), (unsigned long)events[i].uptimeMs / 1000, (unsigned long)events[i].uptimeMs % 1000);
+        DescribeEvent(&events[i], event, sizeof(event));
+        page->Printf_P(boardRow, time, event);
+    }
+    // Boot phases since power on, the later ones overlap
+    for (int i = 0; i < BOOT_PHASES; i++)
+    {
+        bootPhase *p = &bootPhases[i];
+        char phase[16], name[24];
+        strncpy_P(phase, GetBootPhaseName(i), sizeof(phase) - 1);
+        phase[sizeof(phase) - 1] = '\0';
+        snprintf_P(name, sizeof(name), PSTR("Boot %s"), phase);
+        if (p->done)
+            snprintf_P(tmp, sizeof(tmp), PSTR("%lu ms from %lu ms"), p->endMillis - p->startMillis, p->startMillis);
+        else
+            strcpy_P(tmp, p->started ? PSTR("running") : PSTR("waiting"));
+        page->Printf_P(boardRow, name, tmp);
+    }
+    page->Write_P(boardEnd);
 
     // Sensor info
     for (int i = 0; i < drivers_count; i++)
     {
-        webPageLen += sprintf(&webPage[webPageLen], sensorBegin);
-        drivers[i]->GetValues([](const char *n, const char *v) {
-            webPageLen += sprintf(&webPage[webPageLen], sensorRow, n, v);
+        page->Printf_P(sensorBegin, drivers[i]->GetId());
+        drivers[i]->GetValues([](const __FlashStringHelper *n, const char *v) {
+            printRow(sensorRow, (PGM_P)n, v);
         });
-        webPageLen += sprintf(&webPage[webPageLen], sensorEnd);
+        printFilterRows(drivers[i]);
+        printHealthRows(drivers[i]);
+        page->Write_P(sensorEnd);
     }
 
-    // Buttons
-    webPageLen += sprintf(&webPage[webPageLen], buttons);
-
-    // Closing tags
-    webPageLen += sprintf(&webPage[webPageLen], "</body></html>");
-
-    // Report length
-    Serial.printf("Web Page Length %i bytes\n", webPageLen);
-    return webPage;
+    page->End();
+    page = nullptr;
 }
@@ -0,0 +1,324 @@
+#include <Arduino.h>
+#include <ezTime.h>
+#include <telemetry.h>
+
+// Each sample is stored as a 2 byte length followed by its lines, or
+// with TELEMETRY_COMPRESSED each sealed block the same way
+#define RECORD_HEADER 2
+
+// Lines sampled before the clock is set start with UNTIMED_MARKER and
+// millis() (uint32), and are stamped when they are sent
+#define UNTIMED_MARKER 0x01
+#define UNTIMED_HEADER 5
+
+// " <ns since the epoch>" and the null
+#define TIMESTAMP_SIZE 32
+
+static void formatTimestamp(char *buf, time_t seconds, uint16_t milliseconds)
+{
+    snprintf_P(buf, TIMESTAMP_SIZE, PSTR(" %lu%03u000000"), (unsigned long)seconds, milliseconds);
+}
+
+// *** PUBLIC ***
+
+void Telemetry::Sample(SensorDriver *drivers[], int count)
+{
+#if TELEMETRY_COMPRESSED
+    SampleBlocks(drivers, count);
+#else
+    SampleLines(drivers, count);
+#endif
+}
+
+int Telemetry::BuildPacket(char *packet, int size)
+{
+    int packetLen = 0;
+#if TELEMETRY_COMPRESSED
+    // Everything sampled goes out with this flush
+    for (int i = 0; i < TELEMETRY_MAX_DRIVERS; i++)
+        Seal(i);
+    uint32_t sent = millis();
+    packet[packetLen++] = TELEMETRY_PACKET_MAGIC[0];
+    packet[packetLen++] = TELEMETRY_PACKET_MAGIC[1];
+    packet[packetLen++] = TELEMETRY_PACKET_VERSION;
+    packet[packetLen++] = 0;
+    memcpy(&packet[packetLen], &sent, sizeof(sent));
+    packetLen += sizeof(sent);
+#endif
+    int headerLen = packetLen;
+    while (_used > 0)
+    {
+        int recordLen = PeekLength();
+        int len = recordLen;
+        if (IsUntimed())
+        {
+            // Held until they can be stamped, unless samples would be dropped
+            if (timeStatus() == timeNotSet && !IsNearlyFull())
+                break;
+            len = ReadStamped(&packet[packetLen], size - packetLen);
+        }
+        else if (packetLen + len < size)
+            Read(RECORD_HEADER, &packet[packetLen], len);
+        else
+            len = -1;
+        if (len < 0)
+        {
+            // A sample that can never fit is discarded
+            if (packetLen == headerLen)
+            {
+                Drop(RECORD_HEADER + recordLen);
+                _droppedSamples++;
+                continue;
+            }
+            break;
+        }
+        Drop(RECORD_HEADER + recordLen);
+        packetLen += len;
+    }
+    packet[packetLen] = 0;
+    return packetLen;
+}
+
+// *** PRIVATE ***
+
+void Telemetry::SampleLines(SensorDriver *drivers[], int count)
+{
+    // Nanosecond timestamp, InfluxDB's default precision. Without a
+    // synced clock the lines are stamped once it is
+    char timestamp[TIMESTAMP_SIZE] = "";
+    bool untimed = timeStatus() == timeNotSet;
+    if (!untimed)
+        formatTimestamp(timestamp, now(), ms(LAST_READ));
+    int timestampLen = strlen(timestamp);
+    uint32_t sampled = millis();
+
+    char record[640];
+    for (int i = 0; i < count; i++)
+    {
+        const Measurement *schema;
+        const int32_t *values;
+        int n = drivers[i]->IsLastReadingValid() ? drivers[i]->GetReadings(&schema, &values) : 0;
+
+        // A line per value worth sending, with the timestamp before the newline
+        int recordLen = 0;
+        if (untimed)
+        {
+            record[recordLen++] = UNTIMED_MARKER;
+            memcpy(&record[recordLen], &sampled, sizeof(sampled));
+            recordLen += sizeof(sampled);
+        }
+        for (int j = 0; j < n; j++)
+        {
+            if (!IsDue(i, j, schema[j], values[j]))
+            {
+                _suppressedValues++;
+                continue;
+            }
+            recordLen += EncodeLine(&record[recordLen], schema[j], drivers[i]->GetId(), values[j]) - 1;
+            memcpy(&record[recordLen], timestamp, timestampLen);
+            recordLen += timestampLen;
+            record[recordLen++] = '\n';
+            Sent(i, j, values[j]);
+        }
+
+        // Sent for failing drivers too, that's when it matters
+        LastSent *last = i < TELEMETRY_MAX_DRIVERS ? &_lastHealth[i] : nullptr;
+        int32_t score = drivers[i]->GetHealth()->GetScore();
+        if (IsDue(last, healthMeasurement, score))
+        {
+            recordLen += EncodeLine(&record[recordLen], healthMeasurement, drivers[i]->GetId(), score) - 1;
+            memcpy(&record[recordLen], timestamp, timestampLen);
+            recordLen += timestampLen;
+            record[recordLen++] = '\n';
+            Sent(last, score);
+        }
+        if (recordLen > (untimed ? UNTIMED_HEADER : 0))
+            Push(record, recordLen);
+    }
+}
+
+// Adds each driver's sample to its open block, times are epoch ms once
+// the clock is set and millis() until then
+void Telemetry::SampleBlocks(SensorDriver *drivers[], int count)
+{
+#if TELEMETRY_COMPRESSED
+    bool epoch = timeStatus() != timeNotSet;
+    uint64_t time = epoch ? (uint64_t)now() * 1000 + ms(LAST_READ) : millis();
+    uint8_t flags = epoch ? SERIES_BLOCK_EPOCH : 0;
+    for (int i = 0; i < count && i < TELEMETRY_MAX_DRIVERS; i++)
+    {
+        if (!drivers[i]->IsLastReadingValid())
+            continue;
+        const Measurement *schema;
+        const int32_t *values;
+        int n = drivers[i]->GetReadings(&schema, &values);
+        bool due = false;
+        for (int j = 0; j < n; j++)
+            due |= IsDue(i, j, schema[j], values[j]);
+        if (!due)
+        {
+            _suppressedValues += n;
+            continue;
+        }
+
+        // Queue the block when full or its kind of timestamp changes
+        SeriesBlock *block = &_blocks[i];
+        if (block->GetCount() > 0 && (block->GetFlags() != flags || !block->Append(time, values)))
+            Seal(i);
+        if (block->GetCount() == 0 &&
+            (!block->Begin(_blockData[i], TELEMETRY_BLOCK_SIZE, drivers[i], flags) || !block->Append(time, values)))
+        {
+            _droppedSamples++;
+            continue;
+        }
+        _openSamples++;
+        for (int j = 0; j < n; j++)
+            Sent(i, j, values[j]);
+    }
+#endif
+}
+
+// True if a value has moved past its deadband since the last one sent,
+// or the measurement's heartbeat is due
+bool Telemetry::IsDue(int driver, int field, const Measurement &m, int32_t value)
+{
+    if (driver >= TELEMETRY_MAX_DRIVERS || field >= TELEMETRY_MAX_FIELDS)
+        return true;
+    return IsDue(&_lastSent[driver][field], m, value);
+}
+
+void Telemetry::Sent(int driver, int field, int32_t value)
+{
+    if (driver >= TELEMETRY_MAX_DRIVERS || field >= TELEMETRY_MAX_FIELDS)
+        return;
+    Sent(&_lastSent[driver][field], value);
+}
+
+// The same for any tracked value, last is null for one that is not
+bool Telemetry::IsDue(LastSent *last, const Measurement &m, int32_t value)
+{
+    if (last == nullptr || !last->sent)
+        return true;
+    unsigned long heartbeat = (m.heartbeat != 0 ? m.heartbeat : MEASUREMENT_HEARTBEAT_S) * 1000UL;
+    if (millis() - last->millis >= heartbeat)
+        return true;
+    int64_t change = (int64_t)value - last->value;
+    if (change < 0)
+        change = -change;
+    return m.deadband == 0 ? change != 0 : change >= m.deadband;
+}
+
+void Telemetry::Sent(LastSent *last, int32_t value)
+{
+    if (last != nullptr)
+        *last = {value, millis(), true};
+}
+
+// Queues an open block as a record
+void Telemetry::Seal(int block)
+{
+#if TELEMETRY_COMPRESSED
+    SeriesBlock *b = &_blocks[block];
+    if (b->GetCount() == 0)
+        return;
+    _openSamples -= b->GetCount();
+    Push((const char *)_blockData[block], b->Finish());
+    b->Clear();
+#endif
+}
+
+// Append a record, dropping the oldest to make room
+void Telemetry::Push(const char *data, int len)
+{
+    if (len == 0 || RECORD_HEADER + len > SAMPLE_RING_SIZE)
+        return;
+    while (SAMPLE_RING_SIZE - _used < RECORD_HEADER + len)
+    {
+        Drop(RECORD_HEADER + PeekLength());
+        _droppedSamples++;
+    }
+
+    uint8_t header[RECORD_HEADER] = {(uint8_t)(len >> 8), (uint8_t)len};
+    int tail = (_head + _used) % SAMPLE_RING_SIZE;
+    for (int i = 0; i < RECORD_HEADER; i++)
+        _ring[(tail + i) % SAMPLE_RING_SIZE] = header[i];
+    tail = (tail + RECORD_HEADER) % SAMPLE_RING_SIZE;
+    int first = min(len, SAMPLE_RING_SIZE - tail);
+    memcpy(&_ring[tail], data, first);
+    memcpy(_ring, &data[first], len - first);
+    _used += RECORD_HEADER + len;
+}
+
+// True if the oldest record is lines waiting for a timestamp
+bool Telemetry::IsUntimed()
+{
+#if TELEMETRY_COMPRESSED
+    return false;
+#else
+    return _ring[(_head + RECORD_HEADER) % SAMPLE_RING_SIZE] == UNTIMED_MARKER;
+#endif
+}
+
+// Copies the oldest, untimed record to dest with each line stamped with
+// when it was sampled (or left unstamped if the clock still isn't set).
+// Returns the length, or -1 if it doesn't fit
+int Telemetry::ReadStamped(char *dest, int size)
+{
+    int len = PeekLength() - UNTIMED_HEADER;
+    if (len >= size)
+        return -1;
+    uint8_t header[UNTIMED_HEADER];
+    Read(RECORD_HEADER, (char *)header, UNTIMED_HEADER);
+    Read(RECORD_HEADER + UNTIMED_HEADER, dest, len);
+
+    char timestamp[TIMESTAMP_SIZE] = "";
+    if (timeStatus() != timeNotSet)
+    {
+        uint32_t sampled;
+        memcpy(&sampled, &header[1], sizeof(sampled));
+        uint64_t at = (uint64_t)now() * 1000 + ms(LAST_READ) - (uint32_t)(millis() - sampled);
+        formatTimestamp(timestamp, at / 1000, at % 1000);
+    }
+    int timestampLen = strlen(timestamp);
+    int lines = 0;
+    for (int i = 0; i < len; i++)
+        lines += dest[i] == '\n';
+    int stampedLen = len + lines * timestampLen;
+    if (stampedLen >= size)
+        return -1;
+
+    // Working back from the end, each newline gets the timestamp before it
+    for (int from = len - 1, to = stampedLen - 1; from >= 0; from--)
+    {
+        dest[to--] = dest[from];
+        if (dest[from] == '\n')
+        {
+            to -= timestampLen;
+            memcpy(&dest[to + 1], timestamp, timestampLen);
+        }
+    }
+    return stampedLen;
+}
+
+// Length of the oldest record
+int Telemetry::PeekLength()
+{
+    uint8_t hi = _ring[_head];
+    uint8_t lo = _ring[(_head + 1) % SAMPLE_RING_SIZE];
+    return hi << 8 | lo;
+}
+
+// Copy from the oldest record starting offset bytes in
+void Telemetry::Read(int offset, char *dest, int len)
+{
+    int start = (_head + offset) % SAMPLE_RING_SIZE;
+    int first = min(len, SAMPLE_RING_SIZE - start);
+    memcpy(dest, &_ring[start], first);
+    memcpy(&dest[first], _ring, len - first);
+}
+
+void Telemetry::Drop(int len)
+{
+    _head = (_head + len) % SAMPLE_RING_SIZE;
+    _used -= len;
+}
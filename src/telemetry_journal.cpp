@@ -0,0 +1,170 @@
+#include <Arduino.h>
+#include <coredecls.h>
+#include <telemetry_journal.h>
+
+// Each record is a header (magic, length and CRC-32 of the packet)
+// followed by the packet
+#define RECORD_MAGIC 0x4A54
+#define RECORD_HEADER 8
+
+// *** PUBLIC ***
+
+void TelemetryJournal::Begin()
+{
+    // New appends always start a new segment, one cut short by a
+    // restart is left as it is
+    bool found = false;
+    Dir dir = LittleFS.openDir(JOURNAL_DIR);
+    while (dir.next())
+    {
+        uint32_t seq = strtoul(dir.fileName().c_str(), nullptr, 16);
+        if (!found || seq < _firstSeq)
+            _firstSeq = seq;
+        if (!found || seq >= _lastSeq)
+            _lastSeq = seq + 1;
+        found = true;
+    }
+    Serial.printf_P(PSTR("Telemetry journal has %i segments\n"), GetSegmentCount());
+}
+
+void TelemetryJournal::Append(const char *packet, int len)
+{
+    if (len <= 0 || RECORD_HEADER + len > JOURNAL_WRITE_BUFFER)
+        return;
+    if (_bufferLen + RECORD_HEADER + len > JOURNAL_WRITE_BUFFER)
+        Commit();
+    if (_bufferLen == 0)
+        _bufferSinceMillis = millis();
+
+    uint32_t crc = crc32(packet, len);
+    uint8_t *header = (uint8_t *)&_buffer[_bufferLen];
+    header[0] = (uint8_t)RECORD_MAGIC;
+    header[1] = (uint8_t)(RECORD_MAGIC >> 8);
+    header[2] = (uint8_t)len;
+    header[3] = (uint8_t)(len >> 8);
+    for (int i = 0; i < 4; i++)
+        header[4 + i] = (uint8_t)(crc >> (i * 8));
+    memcpy(&_buffer[_bufferLen + RECORD_HEADER], packet, len);
+    _bufferLen += RECORD_HEADER + len;
+}
+
+void TelemetryJournal::Handle()
+{
+    if (_bufferLen > 0 && (unsigned long)(millis() - _bufferSinceMillis) >= JOURNAL_COMMIT_MS)
+        Commit();
+}
+
+int TelemetryJournal::Peek(char *packet, int size)
+{
+    while (!IsEmpty())
+    {
+        if (!_readFile)
+        {
+            // Never read the segment still being appended to
+            if (_firstSeq == _lastSeq)
+                Seal();
+            char name[24];
+            SegmentName(_firstSeq, name);
+            _readFile = LittleFS.open(name, "r");
+            if (!_readFile)
+            {
+                RemoveOldest();
+                continue;
+            }
+        }
+
+        // End of segment, on to the next
+        _readFile.seek(_readOffset);
+        uint8_t header[RECORD_HEADER];
+        if (_readFile.read(header, RECORD_HEADER) != RECORD_HEADER)
+        {
+            RemoveOldest();
+            continue;
+        }
+
+        // A bad record means the rest of the segment can't be trusted
+        int len = header[2] | header[3] << 8;
+        uint32_t crc = header[4] | header[5] << 8 | header[6] << 16 | (uint32_t)header[7] << 24;
+        if ((header[0] | header[1] << 8) != RECORD_MAGIC || len >= size ||
+            _readFile.read((uint8_t *)packet, len) != (size_t)len || crc32(packet, len) != crc)
+        {
+            _corruptRecords++;
+            RemoveOldest();
+            continue;
+        }
+
+        packet[len] = 0;
+        _pendingLen = RECORD_HEADER + len;
+        return len;
+    }
+    return 0;
+}
+
+void TelemetryJournal::Pop()
+{
+    _readOffset += _pendingLen;
+    _pendingLen = 0;
+}
+
+// *** PRIVATE ***
+
+// Write buffered records to the newest segment
+void TelemetryJournal::Commit()
+{
+    if (_bufferLen == 0)
+        return;
+    if (_lastSize > 0 && _lastSize + _bufferLen > JOURNAL_SEGMENT_SIZE)
+    {
+        _lastSeq++;
+        _lastSize = 0;
+    }
+
+    char name[24];
+    SegmentName(_lastSeq, name);
+    File f = LittleFS.open(name, "a");
+    if (f)
+    {
+        f.write(_buffer, _bufferLen);
+        f.close();
+        _lastSize += _bufferLen;
+    }
+    _bufferLen = 0;
+
+    // Keep within budget by losing the oldest data
+    while (GetSegmentCount() > JOURNAL_MAX_SEGMENTS)
+    {
+        _droppedSegments++;
+        RemoveOldest();
+    }
+}
+
+// Commit and start a new segment for later appends
+void TelemetryJournal::Seal()
+{
+    Commit();
+    if (_lastSize > 0)
+    {
+        _lastSeq++;
+        _lastSize = 0;
+    }
+}
+
+void TelemetryJournal::RemoveOldest()
+{
+    if (_readFile)
+        _readFile.close();
+    char name[24];
+    SegmentName(_firstSeq, name);
+    LittleFS.remove(name);
+    if (_firstSeq != _lastSeq)
+        _firstSeq++;
+    else
+        _lastSize = 0;
+    _readOffset = 0;
+    _pendingLen = 0;
+}
+
+void TelemetryJournal::SegmentName(uint32_t seq, char *name)
+{
+    sprintf_P(name, PSTR(JOURNAL_DIR "/%08x"), seq);
+}
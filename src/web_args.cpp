@@ -0,0 +1,10 @@
+#include <Arduino.h>
+#include "web_args.h"
+
+const char *FindArg(ESP8266WebServer *server, PGM_P name)
+{
+    for (int i = 0; i < server->args(); i++)
+        if (strcmp_P(server->argName(i).c_str(), name) == 0)
+            return server->arg(i).c_str();
+    return nullptr;
+}
@@ -0,0 +1,123 @@
+// Fills in the board and sensor rows, the rest of the page is cached.
+// Readings are then patched in from /events as they change, without
+// EventSource, or once the server closes it for good, the rows are
+// fetched again every STATUS_REFRESH_MS.
+// Each reading gets a sparkline of the last day from /api/history
+var STATUS_REFRESH_MS = 10000;
+var SPARK_WIDTH = 96;
+var SPARK_HEIGHT = 20;
+
+function refresh() {
+    fetch('/status')
+        .then(function (r) { return r.text(); })
+        .then(function (t) {
+            document.getElementById('status').innerHTML = t;
+            sparklines();
+        });
+}
+
+function row(id, label) {
+    var sensor = document.getElementById('s-' + id);
+    var rows = sensor ? sensor.querySelectorAll('.row') : [];
+    for (var i = 0; i < rows.length; i++)
+        if (rows[i].children[0].textContent === label)
+            return rows[i];
+    return null;
+}
+
+// An SVG polyline of the means, gaps where a period had no reading
+function spark(values) {
+    var lo = Infinity, hi = -Infinity;
+    values.forEach(function (v) {
+        if (v === null)
+            return;
+        lo = Math.min(lo, v);
+        hi = Math.max(hi, v);
+    });
+    var lines = [], points = [];
+    values.forEach(function (v, i) {
+        if (v === null) {
+            if (points.length)
+                lines.push(points);
+            points = [];
+            return;
+        }
+        var x = values.length > 1 ? i * SPARK_WIDTH / (values.length - 1) : 0;
+        var y = hi > lo ? (hi - v) * SPARK_HEIGHT / (hi - lo) : SPARK_HEIGHT / 2;
+        points.push(x.toFixed(1) + ',' + y.toFixed(1));
+    });
+    if (points.length)
+        lines.push(points);
+    var svg = '<svg width="' + SPARK_WIDTH + '" height="' + SPARK_HEIGHT + '">';
+    lines.forEach(function (p) { svg += '<polyline points="' + p.join(' ') + '"/>'; });
+    return svg + '</svg>';
+}
+
+// Binary 15 minute tier, see history_page.h for the layout
+function sparklines() {
+    fetch('/api/history')
+        .then(function (r) { return r.arrayBuffer(); })
+        .then(function (b) {
+            var d = new DataView(b), at = 4;
+            function text() {
+                var len = d.getUint8(at), s = '';
+                for (var i = 0; i < len; i++)
+                    s += String.fromCharCode(d.getUint8(at + 1 + i));
+                at += 1 + len;
+                return s;
+            }
+            for (var n = d.getUint8(3); n > 0; n--) {
+                var id = text(), name = text(), label = text();
+                var fields = d.getUint8(at + 2), count = d.getUint16(at + 12, true);
+                at += 14;
+                var values = [];
+                for (var i = 0; i < count; i++, at += 2 * fields) {
+                    var v = d.getInt16(at + (fields === 3 ? 2 : 0), true);
+                    values.push(v === -32768 ? null : v);
+                }
+                var r = row(id, label);
+                if (r && count > 1) {
+                    var cell = r.querySelector('.spark') || r.appendChild(document.createElement('div'));
+                    cell.className = 'spark';
+                    cell.innerHTML = spark(values);
+                }
+            }
+        });
+}
+
+// {"id":"<driver id>","<label>":"<value>",...}, fetches the rows again
+// if the page doesn't have one of them yet
+function patch(e) {
+    var readings = JSON.parse(e.data);
+    if (!document.getElementById('s-' + readings.id)) {
+        refresh();
+        return;
+    }
+    Object.keys(readings).forEach(function (label) {
+        if (label === 'id')
+            return;
+        var r = row(readings.id, label);
+        if (r)
+            r.children[1].textContent = readings[label];
+        else
+            refresh();
+    });
+}
+
+// EventSource reconnects by itself after a network error, but not
+// after an error reply
+function poll() {
+    setInterval(refresh, STATUS_REFRESH_MS);
+}
+
+refresh();
+if (window.EventSource) {
+    var events = new EventSource('/events');
+    events.onmessage = patch;
+    events.onerror = function () {
+        if (events.readyState === EventSource.CLOSED)
+            poll();
+    };
+} else
+    poll();
+setInterval(sparklines, 15 * 60 * 1000);